@@ -0,0 +1,76 @@
+// Filename:	arena.h
+// Description:	A bump allocator over a single block. Used for the netlist,
+//				whose arrays are all sized up front and all released together.
+
+#ifndef ARENA
+#define ARENA
+
+//STL includes
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+//user defined includes
+#include "memory_accounting.h"
+
+#define ARENA_ALIGN 16
+
+class Arena
+{
+public:
+	//allocates the whole block at once, capacity is in bytes
+	Arena(size_t capacity)
+	{
+		size = capacity;
+		used = 0;
+		block = (char *) malloc(size > 0 ? size : 1);
+		if (block == NULL)
+		{
+			std::cerr << "ERROR: Could not allocate " << size << " bytes for the netlist\n";
+			exit(-1);
+		}
+		memoryAllocated(MemTopology, size);
+	}
+	//everything handed out by the arena is released here
+	~Arena()
+	{
+		memoryReleased(MemTopology, size);
+		free(block);
+	}
+
+	//returns uninitialized space for count objects of type T
+	template <typename T>
+	T *alloc(size_t count)
+	{
+		size_t bytes = arenaBytes<T>(count);
+		if (used + bytes > size)
+		{
+			std::cerr << "ERROR: Netlist arena exhausted (" << size << " bytes)\n";
+			exit(-1);
+		}
+		T *result = (T *) (block + used);
+		used += bytes;
+		return result;
+	}
+
+	//bytes alloc<T>(count) will take, for sizing the arena before use
+	template <typename T>
+	static size_t arenaBytes(size_t count)
+	{
+		return (count * sizeof(T) + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+	}
+
+	size_t capacity() const { return size; }
+	size_t bytesUsed() const { return used; }
+
+private:
+	//arenas own their block, copying one would free it twice
+	Arena(const Arena &);
+	Arena & operator=(const Arena &);
+
+	char *block;
+	size_t size;
+	size_t used;
+};
+
+#endif
@@ -5,24 +5,53 @@
 //				implication simulator via a command line.
 
 #include "circuit_repl.h"
+#include "implication_export.h"
+#include "perf_counters.h"
+#include "sequential_sim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
 
 //Default constructor
-CircuitREPL::CircuitREPL()
+CircuitREPL::CircuitREPL() : CircuitREPL("badPath")
 {
-	CircuitREPL("badPath");
 }
 
 //Overloadeded constructor
-CircuitREPL::CircuitREPL(std::string circuitPath)
+CircuitREPL::CircuitREPL(std::string circuitPath) : CircuitREPL(circuitPath, NULL)
+{
+}
+
+CircuitREPL::CircuitREPL(std::string circuitPath, LogicSim *learned)
 {
 	//print welcome message
 	printWelcome();
-	//create the circuit from the file
-	sim = new LogicSim(circuitPath);
+	//create the circuit from the file, the first circuit is learned up front
+	LoadedCircuit *circuit = new LoadedCircuit;
+	circuit->path = circuitPath;
+	circuit->sim = learned != NULL ? learned : new LogicSim(circuitPath);
+	circuit->ready = true;
+	circuit->cancelled = false;
+	current = circuitPath.substr(circuitPath.find_last_of('/') + 1);
+	circuits[current] = circuit;
+	sim = circuit->sim;
 	cktPath = circuitPath;
 	std::cout << "Enter a command, or help to begin" << std::endl;
 }
 
+//Destructor
+CircuitREPL::~CircuitREPL()
+{
+	for (auto it = circuits.begin(); it != circuits.end(); ++it)
+	{
+		releaseCircuit(it->second);
+	}
+}
+
 //start the REPL on the standard input
 void CircuitREPL::startREPL()
 {
@@ -31,7 +60,11 @@ void CircuitREPL::startREPL()
 	while (running)
 	{
 		std::cout << ">";
-		std::getline(std::cin, currentCommand);
+		//end of input quits, as if quit was entered
+		if (!std::getline(std::cin, currentCommand))
+		{
+			break;
+		}
 		running = parseLine(currentCommand);
 	}
 }
@@ -45,7 +78,34 @@ bool CircuitREPL::parseLine(std::string line)
 		commandIndex = line.length();
 	}
 	std::string command = line.substr(0, commandIndex);
+	std::string args;
+	if (commandIndex < (int) line.length())
+	{
+		args = line.substr(commandIndex + 1, line.length());
+	}
 	currentCommand = parseCommand(command);
+	//commands which need the current circuit wait for it to finish learning
+	switch (currentCommand)
+	{
+	case GetImplication:
+	case GetGateInfo:
+	case GetCktInfo:
+	case SimVector:
+	case SimSequences:
+	case SimStream:
+	case Benchmark:
+	case Stats:
+	case Export:
+	case CompareOrders:
+	case CompareModes:
+		if (!currentReady())
+		{
+			return true;
+		}
+		break;
+	default:
+		break;
+	}
 	switch (currentCommand)
 	{
 	case Quit:
@@ -59,19 +119,55 @@ bool CircuitREPL::parseLine(std::string line)
 		printHelp();
 		break;
 	case GetImplication:
-		printImplication(line.substr(commandIndex + 1, line.length()));
+		printImplication(args);
 		break;
 	case GetCktInfo:
 		printCktInfo();
 		break;
 	case GetGateInfo:
-		printGate(line.substr(commandIndex + 1, line.length()));
+		printGate(args);
 		break;
 	case SimVector:
-		simVector(line.substr(commandIndex + 1, line.length()));
+		simVector(args);
+		break;
+	case SimSequences:
+		simSequences(args);
+		break;
+	case SimStream:
+		simStream(args);
+		break;
+	case Benchmark:
+		benchEvaluators(args);
 		break;
 	case Stats:
-		printStats();
+		printStats(args);
+		break;
+	case Export:
+		exportImplications(args);
+		break;
+	case Load:
+		loadCircuit(args);
+		break;
+	case Switch:
+		switchCircuit(args);
+		break;
+	case Unload:
+		unloadCircuit(args);
+		break;
+	case ListCircuits:
+		listCircuits();
+		break;
+	case Wait:
+		waitCircuit(args);
+		break;
+	case CompareOrders:
+		compareOrders(args);
+		break;
+	case CompareModes:
+		compareModes(args);
+		break;
+	case Memory:
+		printMemory();
 		break;
 	default:
 		std::cout << "Error: Unknown Error" << std::endl;
@@ -96,6 +192,30 @@ Command CircuitREPL::parseCommand(std::string command)
 		return SimVector;
 	if (command == "stats")
 		return Stats;
+	if (command == "export")
+		return Export;
+	if (command == "load")
+		return Load;
+	if (command == "switch")
+		return Switch;
+	if (command == "unload")
+		return Unload;
+	if (command == "circuits")
+		return ListCircuits;
+	if (command == "wait")
+		return Wait;
+	if (command == "orders")
+		return CompareOrders;
+	if (command == "modes")
+		return CompareModes;
+	if (command == "mem")
+		return Memory;
+	if (command == "seqsim")
+		return SimSequences;
+	if (command == "simseq")
+		return SimStream;
+	if (command == "bench")
+		return Benchmark;
 	//else return unknown
 	return Unknown;
 }
@@ -106,13 +226,96 @@ void CircuitREPL::printWelcome()
 	std::cout << "Designed for ECE 4520 by Alex Nolan" << std::endl << std::endl;
 }
 
-void CircuitREPL::printStats()
+void CircuitREPL::printStats(std::string command)
 {
+	if (command == "json")
+	{
+		std::cout << "{\"circuit\": \"" << cktPath << "\", \"implications\": " << sim->numIndirectImplications
+			<< ", \"fixedGates\": " << sim->fixedNodeCounter << ", \"simulations\": " << sim->numSimulations
+			<< ", \"learningPasses\": " << sim->numLearningPasses << ", \"directMs\": " << sim->elapsedMsDirect
+			<< ", \"indirectMs\": " << sim->elapsedMsIndirect << ", \"coverage\": {\"literals\": " << sim->coverage.literals
+			<< ", \"covered\": " << sim->coverage.covered << ", \"capped\": " << sim->coverage.capped << ", \"stopReason\": \""
+			<< sim->coverage.stopReason << "\"}, \"memory\": {";
+		for (int i = 0; i < MemSubsystems; i++)
+		{
+			MemorySubsystem subsystem = (MemorySubsystem) i;
+			std::cout << "\"" << memorySubsystemName(subsystem) << "\": {\"current\": " << memoryCurrent(subsystem)
+				<< ", \"peak\": " << memoryPeak(subsystem) << "}, ";
+		}
+		std::cout << "\"peakTotal\": " << memoryPeakTotal() << ", \"peakResident\": " << processPeakResident() << "}, \"perf\": {"
+			<< "\"available\": " << (perfCountersAvailable() ? "true" : "false") << ", \"reason\": \"" << perfUnavailableReason() << "\"";
+		for (int i = 0; i < PerfPhases; i++)
+		{
+			PerfTotals totals = perfTotals((PerfPhase) i);
+			std::cout << ", \"" << perfPhaseName((PerfPhase) i) << "\": {\"scopes\": " << totals.scopes << ", \"ms\": " << totals.ms;
+			for (int e = 0; e < PerfEvents; e++)
+			{
+				std::cout << ", \"" << perfEventName((PerfEvent) e) << "\": ";
+				if (perfEventSupported((PerfEvent) e))
+					std::cout << totals.counts[e];
+				else
+					std::cout << "null";
+			}
+			std::cout << "}";
+		}
+		std::cout << "}}" << std::endl;
+		return;
+	}
 	std::cout << "Found a total of " << sim->numIndirectImplications << " implications via logic simulation\n";
 	std::cout << "Found a total of " << sim->fixedNodeCounter << " fixed gates which can only take a single value\n";
 	std::cout << "Circuit was logic simulated " << sim->numSimulations << " times\n";
 	std::cout << "Calculated all direct implications in " << sim->elapsedMsDirect << " milliseconds\n";
 	std::cout << "Calculated all indirect implications in " << sim->elapsedMsIndirect << " milliseconds\n";
+	std::cout << "Learning covered " << sim->coverage.covered << " of " << sim->coverage.literals << " literals ("
+		<< sim->coverage.stopReason << "), " << sim->coverage.capped << " stopped at the iteration cap\n";
+	printPerfCounters();
+}
+
+//counts are per 1000 instructions, "-" where the counter could not be opened
+void CircuitREPL::printPerfCounters()
+{
+	if (!perfCountersAvailable())
+	{
+		std::cout << "Hardware counters unavailable: " << perfUnavailableReason() << "\n";
+	}
+	std::cout << "phase\tscopes\tms\tcpu ms\tcycles\tinstructions\tIPC\tcache misses/k\tbranch misses/k\n";
+	for (int i = 0; i < PerfPhases; i++)
+	{
+		PerfTotals totals = perfTotals((PerfPhase) i);
+		uint64_t instructions = totals.counts[PerfInstructions];
+		auto column = [&](PerfEvent event, double value) {
+			std::cout << "\t";
+			if (perfEventSupported(event))
+				std::cout << value;
+			else
+				std::cout << "-";
+		};
+		std::cout << perfPhaseName((PerfPhase) i) << "\t" << totals.scopes << "\t" << totals.ms;
+		column(PerfTaskClock, totals.counts[PerfTaskClock] / 1e6);
+		column(PerfCycles, totals.counts[PerfCycles]);
+		column(PerfInstructions, instructions);
+		column(PerfCycles, totals.counts[PerfCycles] > 0 ? (double) instructions / totals.counts[PerfCycles] : 0);
+		column(PerfCacheMisses, instructions > 0 ? totals.counts[PerfCacheMisses] * 1000.0 / instructions : 0);
+		column(PerfBranchMisses, instructions > 0 ? totals.counts[PerfBranchMisses] * 1000.0 / instructions : 0);
+		std::cout << "\n";
+	}
+}
+
+//counters cover every circuit in the session, the difference to the peak
+//resident size is memory not tracked by subsystem (STL vectors, the heap)
+void CircuitREPL::printMemory()
+{
+	size_t total = 0;
+	std::cout << "subsystem\tcurrent MB\tpeak MB" << std::endl;
+	for (int i = 0; i < MemSubsystems; i++)
+	{
+		MemorySubsystem subsystem = (MemorySubsystem) i;
+		total += memoryCurrent(subsystem);
+		std::cout << memorySubsystemName(subsystem) << "\t" << memoryCurrent(subsystem) / (1024.0 * 1024.0) << "\t"
+			<< memoryPeak(subsystem) / (1024.0 * 1024.0) << std::endl;
+	}
+	std::cout << "total\t" << total / (1024.0 * 1024.0) << "\t" << memoryPeakTotal() / (1024.0 * 1024.0) << std::endl;
+	std::cout << "process peak resident\t\t" << processPeakResident() / (1024.0 * 1024.0) << std::endl;
 }
 
 void CircuitREPL::printHelp()
@@ -123,15 +326,56 @@ void CircuitREPL::printHelp()
 	std::cout << "This command prints the list of logical implications for the specified gate" << std::endl;
 	std::cout << "Example Usage to show implications of gate 1 at value 0: >imp 1 0" << std::endl << std::endl;
 	std::cout << "sim <input vector>" << std::endl;
-	std::cout << "This command prints the circuit PO's for the specified input vector" << std::endl;
+	std::cout << "This command prints the circuit PO's for the specified input vector. Only the inputs which differ" << std::endl;
+	std::cout << "from the last vector are simulated" << std::endl;
 	std::cout << "Example usage to simulate the vector 1X0 on the current circuit: >sim 1X0" << std::endl << std::endl;
+	std::cout << "simseq <vector file> [gray] [full] [quiet]" << std::endl;
+	std::cout << "This command simulates the vectors in a file (one per line) one after another and counts the events" << std::endl;
+	std::cout << "Add gray to simulate them in Gray code order (circuits without FFs), full to schedule every input" << std::endl;
+	std::cout << "of every vector as before, and quiet to print only the totals" << std::endl;
+	std::cout << "Example usage to compare a test stream against full scheduling: >simseq tests.vec quiet full" << std::endl << std::endl;
+	std::cout << "bench [rounds]" << std::endl;
+	std::cout << "This command times the gate evaluators on a random vector, fixed width against generic (default 100 rounds)" << std::endl << std::endl;
+	std::cout << "seqsim <sequence file> [quiet]" << std::endl;
+	std::cout << "This command simulates input sequences cycle by cycle, carrying the FF state from one cycle to the next" << std::endl;
+	std::cout << "The file holds one vector per line, with a blank line between sequences. The FFs start from" << std::endl;
+	std::cout << "<circuit>.initState if there is one, else X. Add quiet to print only the throughput" << std::endl;
+	std::cout << "seqsim random <sequences> <cycles> simulates random sequences and prints the throughput" << std::endl;
+	std::cout << "Example usage to simulate the sequences in reset.seq: >seqsim reset.seq" << std::endl << std::endl;
 	std::cout << "gate <gate number>" << std::endl;
 	std::cout << "This command prints a set of parameters for the specified gate" << std::endl;
 	std::cout << "Example Usage to show the information for gate 1: >gate 1" << std::endl << std::endl;
 	std::cout << "ckt" << std::endl;
 	std::cout << "This command prints a list of the parameters for the current circuit" << std::endl << std::endl;
-	std::cout << "stats" << std::endl;
-	std::cout << "This command prints some statistics about the implication finding process" << std::endl << std::endl;
+	std::cout << "stats [json]" << std::endl;
+	std::cout << "This command prints some statistics about the implication finding process" << std::endl;
+	std::cout << "Add json to print them with the memory counters as one JSON object" << std::endl;
+	std::cout << "Both include hardware counters (cycles, instructions, cache and branch misses) for each phase: load," << std::endl;
+	std::cout << "direct and indirect learning, closure queries and simulation, summed over every circuit in the session" << std::endl << std::endl;
+	std::cout << "mem" << std::endl;
+	std::cout << "This command prints the memory in use and its peak for the topology, implication lists, event wheels" << std::endl;
+	std::cout << "and simulation state of all loaded circuits" << std::endl << std::endl;
+	std::cout << "export <file> [binary|text] [closure]" << std::endl;
+	std::cout << "This command writes the implication list of every gate value to a file (binary by default)" << std::endl;
+	std::cout << "Add closure to write the full list of implications instead of the learned edges" << std::endl;
+	std::cout << "Example usage to write all closures as text: >export ckt.txt text closure" << std::endl << std::endl;
+	std::cout << "load <circuit path> [name]" << std::endl;
+	std::cout << "This command loads and learns another circuit in the background (name defaults to the file name)" << std::endl;
+	std::cout << "Example usage to load a second revision: >load designs/c432_eco c432_eco" << std::endl << std::endl;
+	std::cout << "switch <name>" << std::endl;
+	std::cout << "This command makes a loaded circuit the current circuit for all other commands" << std::endl << std::endl;
+	std::cout << "unload <name>" << std::endl;
+	std::cout << "This command releases a loaded circuit, stopping its learning if it is still running" << std::endl << std::endl;
+	std::cout << "circuits" << std::endl;
+	std::cout << "This command lists the loaded circuits with their status and memory usage" << std::endl << std::endl;
+	std::cout << "wait [name]" << std::endl;
+	std::cout << "This command waits until a circuit (default: the current one) has finished learning" << std::endl << std::endl;
+	std::cout << "orders [single]" << std::endl;
+	std::cout << "This command relearns the current circuit to a fixed point with each learning order and compares them" << std::endl;
+	std::cout << "Add single to compare single passes instead (the current circuit is not changed)" << std::endl << std::endl;
+	std::cout << "modes [single]" << std::endl;
+	std::cout << "This command relearns the current circuit to a fixed point with symbolic X values and with plain 0/1/X values," << std::endl;
+	std::cout << "and compares their speed and the implications each finds. Add single to compare single passes" << std::endl << std::endl;
 	std::cout << "quit" << std::endl;
 	std::cout << "This command quits the simulator" << std::endl;
 }
@@ -161,6 +405,7 @@ void CircuitREPL::printImplication(std::string command)
 		return;
 	}
 	//check for value
+	PerfScope scope(PerfQuery);
 	switch (impVal)
 	{
 	case 0:
@@ -224,14 +469,618 @@ void CircuitREPL::simVector(std::string command)
 		else if (command[i] != ' ')
 		{
 			std::cout << "ERROR: Bad input value " << command[i] << std::endl;
+			delete[] vector;
 			return;
 		}
 	}
-	if (vecIndex + 1 < sim->numpri)
+	if (vecIndex < sim->numpri)
 	{
 		std::cout << "ERROR: Bad input vector, too few values" << std::endl;
+		delete[] vector;
+		return;
+	}
+	if (vecIndex > sim->numpri)
+	{
+		std::cout << "ERROR: Bad input vector, too many values" << std::endl;
+		delete[] vector;
+		return;
+	}
+	{
+		PerfScope scope(PerfSimulation);
+		sim->applyVectorDelta(vector);
+		sim->goodsim(true);
+	}
+	delete[] vector;
+}
+
+//bits of a vector decoded from Gray code, X taken as 0. Vectors sorted by
+//their decoded bits are in Gray code order, so neighbours differ in few inputs
+static std::string grayRank(const std::string &vec)
+{
+	std::string rank(vec.size(), '0');
+	bool bit = false;
+	for (size_t i = 0; i < vec.size(); i++)
+	{
+		bit = bit != (vec[i] == '1');
+		rank[i] = bit ? '1' : '0';
+	}
+	return rank;
+}
+
+void CircuitREPL::simStream(std::string command)
+{
+	std::istringstream args(command);
+	std::string path;
+	std::string option;
+	std::vector<std::string> vectors;
+	bool gray = false;
+	bool full = false;
+	bool quiet = false;
+
+	if (!(args >> path))
+	{
+		std::cout << "ERROR: Invalid command format" << std::endl;
+		return;
+	}
+	while (args >> option)
+	{
+		if (option == "gray")
+			gray = true;
+		else if (option == "full")
+			full = true;
+		else if (option == "quiet")
+			quiet = true;
+		else
+		{
+			std::cout << "ERROR: Unknown option " << option << std::endl;
+			return;
+		}
+	}
+	if (gray && sim->numff > 0)
+	{
+		std::cout << "ERROR: Reordering the vectors would change the results of a circuit with FFs" << std::endl;
+		return;
+	}
+	std::ifstream in(path.c_str());
+	std::string line;
+	if (!in)
+	{
+		std::cout << "ERROR: Could not open " << path << std::endl;
 		return;
 	}
-	sim->applyVector(vector);
-	sim->goodsim(true);
+	while (std::getline(in, line))
+	{
+		std::string vec;
+		for (size_t i = 0; i < line.size() && line[i] != '#'; i++)
+		{
+			if (line[i] != ' ' && line[i] != '\t' && line[i] != '\r')
+			{
+				vec += line[i];
+			}
+		}
+		if (vec.empty())
+		{
+			continue;
+		}
+		if ((int) vec.size() != sim->numpri || vec.find_first_not_of("01xX") != std::string::npos)
+		{
+			std::cout << "ERROR: Bad input vector " << vectors.size() + 1 << " in " << path << std::endl;
+			return;
+		}
+		vectors.push_back(vec);
+	}
+
+	std::vector<size_t> order(vectors.size());
+	for (size_t v = 0; v < order.size(); v++)
+	{
+		order[v] = v;
+	}
+	if (gray)
+	{
+		std::vector<std::string> ranks(vectors.size());
+		for (size_t v = 0; v < vectors.size(); v++)
+		{
+			ranks[v] = grayRank(vectors[v]);
+		}
+		std::stable_sort(order.begin(), order.end(), [&ranks](size_t a, size_t b) { return ranks[a] < ranks[b]; });
+	}
+
+	//outputs are kept in file order and printed after the timing
+	std::vector<std::string> outputs(quiet ? 0 : vectors.size());
+	long events = sim->simulationEvents();
+	long toggles = 0;
+	std::string buffer;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	{
+		PerfScope scope(PerfSimulation);
+		for (size_t k = 0; k < order.size(); k++)
+		{
+			const std::string &vec = vectors[order[k]];
+			if (full)
+			{
+				buffer = vec;
+				sim->applyVector(&buffer[0]);
+				toggles += sim->numpri;
+			}
+			else
+			{
+				toggles += sim->applyVectorDelta(vec.c_str());
+			}
+			sim->goodsim(false);
+			if (!quiet)
+			{
+				outputs[order[k]] = sim->outputValues();
+			}
+		}
+	}
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	events = sim->simulationEvents() - events;
+
+	for (size_t v = 0; v < outputs.size(); v++)
+	{
+		std::cout << "output: " << outputs[v] << std::endl;
+	}
+	std::cout << "Simulated " << vectors.size() << " vectors in " << ms << " milliseconds with " << events << " events ("
+		<< (vectors.empty() ? 0 : (double) events / vectors.size()) << " per vector), " << toggles << " inputs scheduled" << std::endl;
+}
+
+//gates are evaluated on the values of one random vector with a quarter of
+//the inputs X, so the X comparisons are exercised as well as the constants
+void CircuitREPL::benchEvaluators(std::string command)
+{
+	std::istringstream args(command);
+	int rounds = 100;
+
+	if (!command.empty() && (!(args >> rounds) || rounds < 1))
+	{
+		std::cout << "ERROR: Invalid command format" << std::endl;
+		return;
+	}
+	std::mt19937 random(1);
+	std::string vec(sim->numpri, '0');
+	for (int i = 0; i < sim->numpri; i++)
+	{
+		int r = random() & 3;
+		vec[i] = r == 0 ? 'X' : (r == 1 ? '1' : '0');
+	}
+	SimContext *context = sim->createContext();
+	context->applyVector(&vec[0]);
+	context->goodsim(false);
+	//one untimed round first so both runs start warm
+	context->evaluationTime(true, 1);
+	double generic = context->evaluationTime(false, rounds);
+	double specialized = context->evaluationTime(true, rounds);
+	delete context;
+	std::cout << "generic evaluators: " << generic << " ns per gate" << std::endl;
+	std::cout << "fixed width evaluators: " << specialized << " ns per gate" << std::endl;
+	std::cout << "speedup: " << (specialized > 0 ? generic / specialized : 0) << "x over " << rounds << " rounds of "
+		<< sim->numgates - 1 << " gates" << std::endl;
+}
+
+void CircuitREPL::simSequences(std::string command)
+{
+	std::istringstream args(command);
+	std::string source;
+	std::string option;
+	std::vector<std::vector<std::string>> sequences;
+	bool quiet = false;
+	int numpri = sim->numpri;
+
+	if (!(args >> source))
+	{
+		std::cout << "ERROR: Invalid command format" << std::endl;
+		return;
+	}
+	if (source == "random")
+	{
+		int count = 0;
+		int cycles = 0;
+		if (!(args >> count >> cycles) || count < 1 || cycles < 1)
+		{
+			std::cout << "ERROR: Invalid command format" << std::endl;
+			return;
+		}
+		std::mt19937 random(1);
+		sequences.resize(count);
+		for (int s = 0; s < count; s++)
+		{
+			sequences[s].resize(cycles);
+			for (int t = 0; t < cycles; t++)
+			{
+				std::string &vec = sequences[s][t];
+				vec.resize(numpri);
+				for (int i = 0; i < numpri; i++)
+				{
+					vec[i] = (random() & 1) ? '1' : '0';
+				}
+			}
+		}
+		quiet = true;
+	}
+	else
+	{
+		std::ifstream in(source.c_str());
+		std::string line;
+		int lineNumber = 0;
+		if (!in)
+		{
+			std::cout << "ERROR: Could not open " << source << std::endl;
+			return;
+		}
+		sequences.resize(1);
+		while (std::getline(in, line))
+		{
+			std::string vec;
+			lineNumber++;
+			for (size_t i = 0; i < line.size() && line[i] != '#'; i++)
+			{
+				if (line[i] != ' ' && line[i] != '\t' && line[i] != '\r')
+				{
+					vec += line[i];
+				}
+			}
+			if (vec.empty())
+			{
+				//a blank line ends the current sequence
+				if (line.empty() && !sequences.back().empty())
+				{
+					sequences.resize(sequences.size() + 1);
+				}
+				continue;
+			}
+			if ((int) vec.size() != numpri || vec.find_first_not_of("01xX") != std::string::npos)
+			{
+				std::cout << "ERROR: Bad input vector on line " << lineNumber << " of " << source << std::endl;
+				return;
+			}
+			sequences.back().push_back(vec);
+		}
+		if (sequences.back().empty())
+		{
+			sequences.pop_back();
+		}
+		if (args >> option)
+		{
+			quiet = option == "quiet";
+		}
+	}
+
+	const Netlist *netlist = sim->getNetlist();
+	SequentialSim seq(netlist);
+	std::string state;
+	bool initialized = netlist->readInitialState(cktPath, state);
+	seq.setInitialState(state);
+	std::cout << "FFs start from " << (initialized ? cktPath + ".initState" : "X") << std::endl;
+
+	//outputs are kept until the batches are done, so printing is not timed
+	std::vector<std::vector<std::string>> outputs(quiet ? 0 : sequences.size());
+	long sequenceCycles = 0;
+	long clockCycles = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	{
+		PerfScope scope(PerfSimulation);
+		for (size_t first = 0; first < sequences.size(); first += SEQ_WIDTH)
+		{
+			size_t last = std::min(first + SEQ_WIDTH, sequences.size());
+			size_t length = 0;
+			for (size_t s = first; s < last; s++)
+			{
+				length = std::max(length, sequences[s].size());
+			}
+			seq.reset();
+			for (size_t t = 0; t < length; t++)
+			{
+				//a sequence which has ended keeps its last inputs, its outputs are not kept
+				for (size_t s = first; s < last; s++)
+				{
+					if (t < sequences[s].size())
+					{
+						seq.setInputs(s - first, sequences[s][t].c_str());
+						sequenceCycles++;
+					}
+				}
+				seq.clock();
+				clockCycles++;
+				for (size_t s = first; s < last && !quiet; s++)
+				{
+					if (t < sequences[s].size())
+					{
+						outputs[s].push_back(seq.outputValues(s - first));
+					}
+				}
+			}
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (size_t s = 0; s < outputs.size(); s++)
+	{
+		std::cout << "sequence " << s << ":" << std::endl;
+		for (size_t t = 0; t < outputs[s].size(); t++)
+		{
+			std::cout << "output: " << outputs[s][t] << std::endl;
+		}
+	}
+	std::cout << "Simulated " << sequences.size() << " sequences, " << sequenceCycles << " cycles in " << seconds * 1000
+		<< " milliseconds" << std::endl;
+	if (seconds > 0)
+	{
+		std::cout << (long) (clockCycles / seconds) << " clock cycles/s of up to " << SEQ_WIDTH << " sequences, "
+			<< (long) (sequenceCycles / seconds) << " sequence cycles/s" << std::endl;
+	}
+}
+
+void CircuitREPL::exportImplications(std::string command)
+{
+	std::istringstream args(command);
+	std::string path;
+	std::string option;
+	ExportFormat format = ExportBinary;
+	bool closure = false;
+	if (!(args >> path))
+	{
+		std::cout << "ERROR: Invalid command format" << std::endl;
+		return;
+	}
+	while (args >> option)
+	{
+		if (option == "binary")
+			format = ExportBinary;
+		else if (option == "text")
+			format = ExportText;
+		else if (option == "closure")
+			closure = true;
+		else
+		{
+			std::cout << "ERROR: Unknown export option " << option << std::endl;
+			return;
+		}
+	}
+	ImplicationExporter exporter(sim, std::thread::hardware_concurrency());
+	if (!exporter.exportLists(path, format, closure))
+	{
+		std::cout << "ERROR: Could not write " << path << std::endl;
+		return;
+	}
+	std::cout << "Wrote implications to " << path << std::endl;
+}
+
+//returns true if the current circuit can be queried, else prints why not
+bool CircuitREPL::currentReady()
+{
+	if (circuits.count(current) == 0)
+	{
+		std::cout << "ERROR: No circuit selected, use load or switch" << std::endl;
+		return false;
+	}
+	if (!circuits[current]->ready)
+	{
+		std::cout << "Circuit " << current << " is still learning, use wait or switch" << std::endl;
+		return false;
+	}
+	sim = circuits[current]->sim;
+	return true;
+}
+
+void CircuitREPL::loadCircuit(std::string command)
+{
+	std::istringstream args(command);
+	std::string path;
+	std::string name;
+	if (!(args >> path))
+	{
+		std::cout << "ERROR: Invalid command format" << std::endl;
+		return;
+	}
+	if (!(args >> name))
+	{
+		name = path.substr(path.find_last_of('/') + 1);
+	}
+	if (circuits.count(name) != 0)
+	{
+		std::cout << "ERROR: A circuit named " << name << " is already loaded" << std::endl;
+		return;
+	}
+	if (!Netlist::circuitExists(path))
+	{
+		std::cout << "ERROR: Can't open circuit " << path << std::endl;
+		return;
+	}
+
+	LoadedCircuit *circuit = new LoadedCircuit;
+	circuit->path = path;
+	circuit->sim = NULL;
+	circuit->ready = false;
+	circuit->cancelled = false;
+	circuit->loader = std::thread([circuit]() {
+		LogicSim *loaded = new LogicSim(circuit->path, false, false);
+		{
+			std::lock_guard<std::mutex> guard(circuit->lock);
+			circuit->sim = loaded;
+			if (circuit->cancelled)
+			{
+				loaded->requestStop();
+			}
+		}
+		loaded->generateImplicationLists();
+		circuit->ready = true;
+	});
+	circuits[name] = circuit;
+	std::cout << "Loading " << path << " as " << name << " in the background" << std::endl;
+}
+
+void CircuitREPL::switchCircuit(std::string command)
+{
+	std::istringstream args(command);
+	std::string name;
+	if (!(args >> name) || circuits.count(name) == 0)
+	{
+		std::cout << "ERROR: No circuit named " << command << std::endl;
+		return;
+	}
+	current = name;
+	cktPath = circuits[name]->path;
+	sim = circuits[name]->sim;
+	//a circuit still loading is picked up once it is ready
+	if (!circuits[name]->ready)
+	{
+		std::cout << "Circuit " << name << " is still learning" << std::endl;
+	}
+}
+
+void CircuitREPL::unloadCircuit(std::string command)
+{
+	std::istringstream args(command);
+	std::string name;
+	if (!(args >> name) || circuits.count(name) == 0)
+	{
+		std::cout << "ERROR: No circuit named " << command << std::endl;
+		return;
+	}
+	releaseCircuit(circuits[name]);
+	circuits.erase(name);
+	if (name == current)
+	{
+		current.clear();
+		cktPath.clear();
+		sim = NULL;
+	}
+	std::cout << "Unloaded " << name << std::endl;
+}
+
+void CircuitREPL::releaseCircuit(LoadedCircuit *circuit)
+{
+	{
+		std::lock_guard<std::mutex> guard(circuit->lock);
+		circuit->cancelled = true;
+		if (circuit->sim != NULL && !circuit->ready)
+		{
+			circuit->sim->requestStop();
+		}
+	}
+	if (circuit->loader.joinable())
+	{
+		circuit->loader.join();
+	}
+	delete circuit->sim;
+	delete circuit;
+}
+
+void CircuitREPL::listCircuits()
+{
+	for (auto it = circuits.begin(); it != circuits.end(); ++it)
+	{
+		LoadedCircuit *circuit = it->second;
+		std::cout << (it->first == current ? "* " : "  ") << it->first << "\t" << circuit->path << "\t";
+		if (circuit->ready)
+		{
+			std::cout << "ready\t" << circuit->sim->memoryUsage() / (1024.0 * 1024.0) << " MB" << std::endl;
+		}
+		else
+		{
+			std::cout << "learning" << std::endl;
+		}
+	}
+}
+
+void CircuitREPL::waitCircuit(std::string command)
+{
+	std::istringstream args(command);
+	std::string name;
+	if (!(args >> name))
+	{
+		name = current;
+	}
+	if (circuits.count(name) == 0)
+	{
+		std::cout << "ERROR: No circuit named " << name << std::endl;
+		return;
+	}
+	LoadedCircuit *circuit = circuits[name];
+	if (circuit->loader.joinable())
+	{
+		circuit->loader.join();
+	}
+	if (name == current)
+	{
+		sim = circuit->sim;
+	}
+	std::cout << "Circuit " << name << " is ready" << std::endl;
+}
+
+void CircuitREPL::compareOrders(std::string command)
+{
+	std::istringstream args(command);
+	std::string mode;
+	LearningOptions options;
+	options.fixedPoint = !(args >> mode && mode == "single");
+	std::cout << "order\tpasses\timplications\tsimulations\tms\timplications/s" << std::endl;
+	for (int order = OrderGate; order <= OrderPriority; order++)
+	{
+		options.order = (LearningOrder) order;
+		LogicSim learner(cktPath, false, false);
+		learner.setLearningOptions(options);
+		learner.generateImplicationLists();
+		double ms = learner.elapsedMsDirect + learner.elapsedMsIndirect;
+		std::cout << LogicSim::learningOrderName(options.order) << "\t" << learner.numLearningPasses << "\t"
+			<< learner.numIndirectImplications << "\t" << learner.numSimulations << "\t" << ms << "\t"
+			<< (ms > 0 ? (long) (learner.numIndirectImplications * 1000.0 / ms) : 0) << std::endl;
+	}
+}
+
+/*
+Both modes learn from the same default options, with the same order. The
+closures are compared edge by edge: edges only the symbolic lists hold are
+what treating every X alike loses. Ternary learning can also find edges the
+symbolic lists lack, where new X ids given out by a symbolic simulation
+overwrite a value of the closure.
+*/
+void CircuitREPL::compareModes(std::string command)
+{
+	std::istringstream args(command);
+	std::string mode;
+	LearningOptions options;
+	options.fixedPoint = !(args >> mode && mode == "single");
+	LogicSim *learners[2];
+	std::cout << "mode\tpasses\timplications\tsimulations\tunreachable\tms\tsimulations/s" << std::endl;
+	for (int i = 0; i < 2; i++)
+	{
+		options.ternary = i == 1;
+		learners[i] = new LogicSim(cktPath, false, false);
+		learners[i]->setLearningOptions(options);
+		learners[i]->generateImplicationLists();
+		double ms = learners[i]->elapsedMsDirect + learners[i]->elapsedMsIndirect;
+		std::cout << (options.ternary ? "ternary" : "symbolic") << "\t" << learners[i]->numLearningPasses << "\t"
+			<< learners[i]->numIndirectImplications << "\t" << learners[i]->numSimulations << "\t" << learners[i]->fixedNodeCounter
+			<< "\t" << ms << "\t" << (ms > 0 ? (long) (learners[i]->numSimulations * 1000.0 / ms) : 0) << std::endl;
+	}
+
+	long edges[2] = {0, 0};
+	long symbolicOnly = 0, ternaryOnly = 0;
+	ImplicationList closures[2];
+	for (uint32_t literal = 2; literal < 2 * (uint32_t) learners[0]->numgates; literal++)
+	{
+		uint32_t imp = literalFromIndex(literal);
+		for (int i = 0; i < 2; i++)
+		{
+			closures[i].clear();
+			if (!learners[i]->getDirectList(imp).empty())
+			{
+				learners[i]->buildImplicationList(imp, closures[i]);
+			}
+			edges[i] += closures[i].size();
+		}
+		for (auto it = closures[0].begin(); it != closures[0].end(); ++it)
+		{
+			symbolicOnly += closures[1].count(*it) == 0;
+		}
+		for (auto it = closures[1].begin(); it != closures[1].end(); ++it)
+		{
+			ternaryOnly += closures[0].count(*it) == 0;
+		}
+	}
+	std::cout << "closure edges: " << edges[0] << " symbolic, " << edges[1] << " ternary (" << symbolicOnly << " only symbolic, "
+		<< ternaryOnly << " only ternary)" << std::endl;
+	delete learners[0];
+	delete learners[1];
 }
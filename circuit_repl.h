@@ -12,8 +12,12 @@
 #include "implication_structure.h"
 
 //STL includes
+#include <atomic>
+#include <map>
+#include <mutex>
 #include <string>
 #include <iostream>
+#include <thread>
 #include <vector>
 
 enum Command
@@ -25,7 +29,30 @@ enum Command
 	GetCktInfo,
 	SimVector,
 	Quit,
-	Stats
+	Stats,
+	Export,
+	Load,
+	Switch,
+	Unload,
+	ListCircuits,
+	Wait,
+	CompareOrders,
+	CompareModes,
+	Memory,
+	SimSequences,
+	SimStream,
+	Benchmark
+};
+
+//a circuit resident in the REPL session
+struct LoadedCircuit
+{
+	std::string path;
+	LogicSim *sim;				// set by the loader once the netlist is read
+	std::thread loader;			// reads and learns the circuit in the background
+	std::atomic<bool> ready;	// learning has finished
+	bool cancelled;				// unloaded before learning finished
+	std::mutex lock;			// guards sim and cancelled while loading
 };
 
 class CircuitREPL
@@ -33,8 +60,12 @@ class CircuitREPL
 public:
 	//overloaded constructor which takes a file path
 	CircuitREPL(std::string circuitPath);
+	//starts on a circuit which was already learned, taking ownership of it
+	CircuitREPL(std::string circuitPath, LogicSim *learned);
 	//default constructor
 	CircuitREPL();
+	//destructor, releases the simulator
+	~CircuitREPL();
 	//function to start the REPL
 	void startREPL();
 private:
@@ -54,14 +85,49 @@ private:
 	void printCktInfo();
 	//function to send a vector input and print PO
 	void simVector(std::string command);
-	//function to print statistics
-	void printStats();
+	//function to simulate input sequences cycle by cycle, 64 at a time
+	void simSequences(std::string command);
+	//function to simulate a file of vectors one after another, counting events
+	void simStream(std::string command);
+	//function to time the fixed width gate evaluators against the generic ones
+	void benchEvaluators(std::string command);
+	//function to print statistics, as text or as one JSON object
+	void printStats(std::string command);
+	//function to print the hardware counters of each phase
+	void printPerfCounters();
+	//function to print bytes in use and peak bytes by subsystem
+	void printMemory();
+	//function to write all implication lists to a file
+	void exportImplications(std::string command);
+	//function to start loading another circuit in the background
+	void loadCircuit(std::string command);
+	//function to make another loaded circuit current
+	void switchCircuit(std::string command);
+	//function to release a loaded circuit
+	void unloadCircuit(std::string command);
+	//function to list the loaded circuits
+	void listCircuits();
+	//function to block until a circuit has finished learning
+	void waitCircuit(std::string command);
+	//function to relearn the current circuit with every learning order and compare
+	void compareOrders(std::string command);
+	//function to relearn the current circuit with symbolic and ternary simulation and compare
+	void compareModes(std::string command);
+	//returns true if there is a current circuit which has finished learning
+	bool currentReady();
+	//stops, joins and frees one circuit
+	void releaseCircuit(LoadedCircuit *circuit);
 
-	//simulator
+	//simulator for the current circuit
 	LogicSim *sim;
 
-	//path to the circuit file
+	//path to the current circuit file
 	std::string cktPath;
+
+	//every circuit in the session, by name
+	std::map<std::string, LoadedCircuit *> circuits;
+	//name of the current circuit
+	std::string current;
 };
 
 #endif
\ No newline at end of file
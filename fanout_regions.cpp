@@ -0,0 +1,102 @@
+// Filename:	fanout_regions.cpp
+// Description:	Fanout stems, fanout-free regions and post-dominators of a
+//				netlist, computed in one sweep against the levelization.
+
+#include "fanout_regions.h"
+
+//STL includes
+#include <algorithm>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////
+// FanoutRegions class
+////////////////////////////////////////////////////////////////////////
+
+/*
+Gates are visited from the highest level down, so every successor is done
+before the gates feeding it. A gate's immediate dominator is the nearest
+common dominator of its successors (Cooper, Harvey and Kennedy), with
+outputs, flip flops and gates without fanout hanging off a virtual sink.
+The gate where the branches of a stem meet again is its dominator.
+*/
+FanoutRegions::FanoutRegions(const Netlist *circuit)
+{
+	int numgates = circuit->numgates;
+	vector<int> order;
+
+	ckt = circuit;
+	stem.assign(numgates, 0);
+	root.assign(numgates, 0);
+	idom.assign(numgates, DOMINATOR_SINK);
+	depth.assign(numgates, 0);
+	reconvergence.assign(numgates, 0);
+	numStems = numReconvergence = 0;
+
+	for (int i = 1; i < numgates; i++)
+	{
+		order.push_back(i);
+	}
+	stable_sort(order.begin(), order.end(), [this](int a, int b) { return ckt->levelNum[a] > ckt->levelNum[b]; });
+
+	for (size_t k = 0; k < order.size(); k++)
+	{
+		int gate = order[k];
+		bool ends = ckt->fanout[gate] == 0 || ckt->gtype[gate] == T_output;
+		for (int i = 0; i < ckt->fanout[gate]; i++)
+		{
+			int successor = ckt->fnlist[gate][i];
+			if (ckt->gtype[successor] == T_output || ckt->gtype[successor] == T_dff)
+			{
+				ends = true;
+			}
+		}
+		stem[gate] = ends || ckt->fanout[gate] > 1;
+		if (stem[gate])
+		{
+			numStems++;
+			root[gate] = gate;
+		}
+		else
+		{
+			root[gate] = root[ckt->fnlist[gate][0]];
+		}
+
+		if (ends)
+		{
+			idom[gate] = DOMINATOR_SINK;
+		}
+		else
+		{
+			int dom = ckt->fnlist[gate][0];
+			for (int i = 1; i < ckt->fanout[gate]; i++)
+			{
+				dom = intersect(dom, ckt->fnlist[gate][i]);
+			}
+			idom[gate] = dom;
+		}
+		depth[gate] = idom[gate] == DOMINATOR_SINK ? 1 : depth[idom[gate]] + 1;
+
+		if (ckt->fanout[gate] > 1 && idom[gate] != DOMINATOR_SINK && !reconvergence[idom[gate]])
+		{
+			reconvergence[idom[gate]] = 1;
+			numReconvergence++;
+		}
+	}
+}
+
+int FanoutRegions::intersect(int a, int b) const
+{
+	while (a != b)
+	{
+		if (depth[a] < depth[b])
+		{
+			b = idom[b];
+		}
+		else
+		{
+			a = idom[a];
+		}
+	}
+	return a;
+}
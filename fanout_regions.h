@@ -0,0 +1,54 @@
+// Filename:	fanout_regions.h
+// Description:	Header file for the structural analysis used to choose which
+//				literals need learning by simulation. Finds fanout stems,
+//				fanout-free regions and immediate post-dominators.
+
+#ifndef FANOUT_REGIONS
+#define FANOUT_REGIONS
+
+//STL includes
+#include <vector>
+
+//user defined includes
+#include "netlist.h"
+
+//post-dominator of gates whose paths end at different outputs
+#define DOMINATOR_SINK 0
+
+////////////////////////////////////////////////////////////////////////
+// FanoutRegions class
+//	A stem is a gate with more than one fanout, or one which drives an
+//	output or flip flop. Every other gate belongs to the fanout-free
+//	region of the stem its single path of fanouts leads to. Dominators
+//	are taken towards the outputs, with flip flop inputs counted as
+//	outputs.
+////////////////////////////////////////////////////////////////////////
+class FanoutRegions
+{
+public:
+	FanoutRegions(const Netlist *circuit);
+
+	//gate has fanout to more than one gate, an output or a flip flop
+	bool isStem(int gate) const { return stem[gate] != 0; }
+	//the stem whose fanout-free region contains gate (gate itself for stems)
+	int regionRoot(int gate) const { return root[gate]; }
+	//nearest gate every path from gate to an output passes through
+	int immediateDominator(int gate) const { return idom[gate]; }
+	//gate is where the branches of some stem meet again
+	bool isReconvergence(int gate) const { return reconvergence[gate] != 0; }
+
+	int numStems;
+	int numReconvergence;
+
+private:
+	int intersect(int a, int b) const;	// nearest common dominator of a and b
+
+	const Netlist *ckt;
+	std::vector<char> stem;
+	std::vector<int> root;
+	std::vector<int> idom;
+	std::vector<int> depth;
+	std::vector<char> reconvergence;
+};
+
+#endif
@@ -0,0 +1,425 @@
+// Filename:	gate_clauses.cpp
+// Description:	Clause form of a netlist, with unit propagation over it
+
+#include "gate_clauses.h"
+
+//STL includes
+#include <algorithm>
+
+using namespace std;
+
+#define UNASSIGNED 2
+
+//literal of gate at value
+static inline uint32_t gateLiteral(int gate, int value)
+{
+	return value ? (gate | VALUE) : (uint32_t) gate;
+}
+
+////////////////////////////////////////////////////////////////////////
+// GateClauses class
+////////////////////////////////////////////////////////////////////////
+
+//constructor, writes the clauses of every gate and propagates the ties
+GateClauses::GateClauses(const Netlist *netlist)
+{
+	int gateN;
+
+	ckt = netlist;
+	numMuxes = 0;
+	stamp = 0;
+	clauseStart.push_back(0);
+	for (gateN = 1; gateN < ckt->numgates; gateN++)
+	{
+		addGate(gateN);
+		addMux(gateN);
+	}
+
+	//counting sort of the clauses by the literal which wakes them up
+	watchStart.assign(2 * ckt->numgates + 1, 0);
+	for (size_t k = 0; k < clauseLiterals.size(); k++)
+	{
+		watchStart[literalIndex(clauseLiterals[k] ^ VALUE) + 1]++;
+	}
+	for (size_t k = 1; k < watchStart.size(); k++)
+	{
+		watchStart[k] += watchStart[k - 1];
+	}
+	watchClauses.resize(clauseLiterals.size());
+	vector<int> fill(watchStart.begin(), watchStart.end() - 1);
+	for (int c = 0; c < numClauses(); c++)
+	{
+		for (int k = clauseStart[c]; k < clauseStart[c + 1]; k++)
+		{
+			watchClauses[fill[literalIndex(clauseLiterals[k] ^ VALUE)]++] = c;
+		}
+	}
+	markSources();
+
+	//the baseline holds the ties and what they imply, as the all X simulation does
+	value.assign(ckt->numgates, UNASSIGNED);
+	for (int i = 0; i < ckt->numTieNodes; i++)
+	{
+		int tie = ckt->TIES[i];
+		if (ckt->gtype[tie] == T_tie0 || ckt->gtype[tie] == T_tie1)
+		{
+			assign(gateLiteral(tie, ckt->gtype[tie] == T_tie1));
+		}
+	}
+	unitPropagate(0);
+	baseline = value;
+	trail.clear();
+	visited.assign(ckt->numgates, 0);
+
+	stateBytes = (clauseLiterals.size() + trail.capacity()) * sizeof(uint32_t)
+		+ (clauseStart.size() + watchStart.size() + watchClauses.size() + visited.size()) * sizeof(int)
+		+ value.size() + baseline.size() + unencoded.size() + signature.size() * sizeof(uint64_t);
+	memoryAllocated(MemTopology, stateBytes);
+}
+
+GateClauses::~GateClauses()
+{
+	memoryReleased(MemTopology, stateBytes);
+}
+
+void GateClauses::addGate(int gateN)
+{
+	vector<uint32_t> clause;
+	int fanin = ckt->fanin[gateN];
+	const int *in = ckt->inlist[gateN];
+	int control, invert;
+	int i;
+
+	switch (ckt->gtype[gateN])
+	{
+	case T_and:
+	case T_nand:
+	case T_or:
+	case T_nor:
+		if (fanin == 0)
+		{
+			break;
+		}
+		control = (ckt->gtype[gateN] == T_and || ckt->gtype[gateN] == T_nand) ? 0 : 1;
+		invert = (ckt->gtype[gateN] == T_nand || ckt->gtype[gateN] == T_nor) ? 1 : 0;
+		//a controlling input sets the output
+		for (i = 0; i < fanin; i++)
+		{
+			clause.assign(1, gateLiteral(in[i], !control));
+			clause.push_back(gateLiteral(gateN, control ^ invert));
+			addClause(clause);
+		}
+		//no controlling input sets the other output
+		clause.clear();
+		for (i = 0; i < fanin; i++)
+		{
+			clause.push_back(gateLiteral(in[i], control));
+		}
+		clause.push_back(gateLiteral(gateN, !control ^ invert));
+		addClause(clause);
+		break;
+	case T_xor:
+	case T_xnor:
+		if (fanin < 2 || fanin > MAX_XOR_CLAUSE_INPUTS)
+		{
+			break;
+		}
+		invert = ckt->gtype[gateN] == T_xnor ? 1 : 0;
+		//one clause rules out the wrong output for each input combination
+		for (int bits = 0; bits < (1 << fanin); bits++)
+		{
+			int parity = 0;
+			clause.clear();
+			for (i = 0; i < fanin; i++)
+			{
+				int bit = (bits >> i) & 1;
+				clause.push_back(gateLiteral(in[i], !bit));
+				parity ^= bit;
+			}
+			clause.push_back(gateLiteral(gateN, parity ^ invert));
+			addClause(clause);
+		}
+		break;
+	case T_buf:
+	case T_output:
+	case T_not:
+		if (fanin == 0)
+		{
+			break;
+		}
+		invert = ckt->gtype[gateN] == T_not ? 1 : 0;
+		clause.assign(1, gateLiteral(in[0], 0));
+		clause.push_back(gateLiteral(gateN, 1 ^ invert));
+		addClause(clause);
+		clause.assign(1, gateLiteral(in[0], 1));
+		clause.push_back(gateLiteral(gateN, invert));
+		addClause(clause);
+		break;
+	default:
+		//inputs, ties and flip flops have no clauses
+		break;
+	}
+}
+
+/*
+y = (s & a) | (~s & b) as OR of ANDs or NAND of NANDs, or its complement as
+NOR of ANDs or AND of NANDs. With a and b equal y is known even when s is
+not, which neither the gate clauses nor a three valued simulation see, so
+(~a + ~b + y) and (a + b + ~y) are added.
+*/
+void GateClauses::addMux(int gateN)
+{
+	int type = ckt->gtype[gateN];
+	int term;
+	bool positive;
+
+	switch (type)
+	{
+	case T_or:
+	case T_nor:
+		term = T_and;
+		break;
+	case T_nand:
+	case T_and:
+		term = T_nand;
+		break;
+	default:
+		return;
+	}
+	positive = type == T_or || type == T_nand;
+	if (ckt->fanin[gateN] != 2)
+	{
+		return;
+	}
+	const int *p = ckt->inlist[ckt->inlist[gateN][0]];
+	const int *q = ckt->inlist[ckt->inlist[gateN][1]];
+	for (int k = 0; k < 2; k++)
+	{
+		int g = ckt->inlist[gateN][k];
+		if (ckt->gtype[g] != term || ckt->fanin[g] != 2)
+		{
+			return;
+		}
+	}
+	//a select and its complement, one in each term
+	auto complementary = [this](int u, int v)
+	{
+		return (ckt->gtype[v] == T_not && ckt->inlist[v][0] == u) || (ckt->gtype[u] == T_not && ckt->inlist[u][0] == v);
+	};
+	for (int i = 0; i < 2; i++)
+	{
+		for (int j = 0; j < 2; j++)
+		{
+			if (complementary(p[i], q[j]))
+			{
+				vector<uint32_t> clause;
+				int a = p[1 - i];
+				int b = q[1 - j];
+				clause.push_back(gateLiteral(a, 0));
+				clause.push_back(gateLiteral(b, 0));
+				clause.push_back(gateLiteral(gateN, positive));
+				addClause(clause);
+				clause.assign(1, gateLiteral(a, 1));
+				clause.push_back(gateLiteral(b, 1));
+				clause.push_back(gateLiteral(gateN, !positive));
+				addClause(clause);
+				numMuxes++;
+				return;
+			}
+		}
+	}
+}
+
+void GateClauses::addClause(vector<uint32_t> &clause)
+{
+	sort(clause.begin(), clause.end());
+	clause.erase(unique(clause.begin(), clause.end()), clause.end());
+	//a clause holding both literals of a gate is always true
+	for (size_t i = 0; i < clause.size(); i++)
+	{
+		for (size_t j = i + 1; j < clause.size(); j++)
+		{
+			if ((clause[i] ^ clause[j]) == VALUE)
+			{
+				return;
+			}
+		}
+	}
+	clauseLiterals.insert(clauseLiterals.end(), clause.begin(), clause.end());
+	clauseStart.push_back(clauseLiterals.size());
+}
+
+/*
+A source starts unknown values of its own: inputs, flip flops and X or Z
+ties. Each one sets a bit of a 64 bit signature, and a gate's signature is
+the union of its fanins'. Unknowns on two gates can only be related (an X
+and its complement, or the same X twice) if their signatures share a bit.
+*/
+void GateClauses::markSources()
+{
+	vector<int> order;
+	int gateN;
+
+	for (gateN = 1; gateN < ckt->numgates; gateN++)
+	{
+		order.push_back(gateN);
+	}
+	stable_sort(order.begin(), order.end(), [this](int a, int b) { return ckt->levelNum[a] < ckt->levelNum[b]; });
+	signature.assign(ckt->numgates, 0);
+	unencoded.assign(ckt->numgates, 0);
+	for (size_t k = 0; k < order.size(); k++)
+	{
+		gateN = order[k];
+		switch (ckt->gtype[gateN])
+		{
+		case T_input:
+		case T_dff:
+		case T_tieX:
+		case T_tieZ:
+			signature[gateN] = (uint64_t) 1 << (((uint32_t) gateN * 2654435761u) >> 26);
+			continue;
+		case T_xor:
+		case T_xnor:
+			unencoded[gateN] = ckt->fanin[gateN] > MAX_XOR_CLAUSE_INPUTS;
+			break;
+		default:
+			break;
+		}
+		for (int i = 0; i < ckt->fanin[gateN]; i++)
+		{
+			signature[gateN] |= signature[ckt->inlist[gateN][i]];
+		}
+	}
+}
+
+bool GateClauses::related(int gateN, int successor) const
+{
+	int uses = 0;
+
+	for (int i = 0; i < ckt->fanin[successor]; i++)
+	{
+		int other = ckt->inlist[successor][i];
+		if (other == gateN)
+		{
+			uses++;
+		}
+		else if (value[other] == UNASSIGNED && (signature[other] & signature[gateN]) != 0)
+		{
+			return true;
+		}
+	}
+	return uses > 1;
+}
+
+inline bool GateClauses::assign(uint32_t imp)
+{
+	int gateN = imp & GATE;
+	unsigned char want = imp >> 31;
+
+	if (value[gateN] == want)
+	{
+		return true;
+	}
+	if (value[gateN] != UNASSIGNED)
+	{
+		return false;
+	}
+	value[gateN] = want;
+	trail.push_back(imp);
+	return true;
+}
+
+//a clause whose literals are all false but one makes that one true
+bool GateClauses::unitPropagate(size_t from)
+{
+	for (size_t t = from; t < trail.size(); t++)
+	{
+		uint32_t index = literalIndex(trail[t]);
+		for (int w = watchStart[index]; w < watchStart[index + 1]; w++)
+		{
+			int c = watchClauses[w];
+			int open = 0;
+			uint32_t unit = 0;
+			bool satisfied = false;
+			for (int k = clauseStart[c]; k < clauseStart[c + 1] && !satisfied; k++)
+			{
+				uint32_t literal = clauseLiterals[k];
+				unsigned char v = value[literal & GATE];
+				if (v == UNASSIGNED)
+				{
+					open++;
+					unit = literal;
+				}
+				else
+				{
+					satisfied = v == literal >> 31;
+				}
+			}
+			if (satisfied || open > 1)
+			{
+				continue;
+			}
+			if (open == 0 || !assign(unit))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool GateClauses::propagate(const ImplicationList &seeds, vector<uint32_t> &implied)
+{
+	bool consistent = true;
+
+	//undo the last propagation
+	for (size_t t = 0; t < trail.size(); t++)
+	{
+		value[trail[t] & GATE] = baseline[trail[t] & GATE];
+	}
+	trail.clear();
+	for (auto it = seeds.begin(); it != seeds.end() && consistent; ++it)
+	{
+		consistent = assign(*it);
+	}
+	consistent = consistent && unitPropagate(0);
+	implied.assign(trail.begin(), trail.end());
+	return consistent;
+}
+
+//the changed values spread through unknown gates, stopping at gates which
+//propagation gave a value (a simulation holds the same constant there)
+bool GateClauses::reachesReconvergence()
+{
+	vector<int> stack;
+
+	stamp++;
+	for (size_t t = 0; t < trail.size(); t++)
+	{
+		stack.push_back(trail[t] & GATE);
+		visited[trail[t] & GATE] = stamp;
+	}
+	while (!stack.empty())
+	{
+		int gateN = stack.back();
+		stack.pop_back();
+		for (int i = 0; i < ckt->fanout[gateN]; i++)
+		{
+			int successor = ckt->fnlist[gateN][i];
+			if (value[successor] != UNASSIGNED)
+			{
+				continue;
+			}
+			if (unencoded[successor] || related(gateN, successor))
+			{
+				return true;
+			}
+			if (visited[successor] != stamp)
+			{
+				visited[successor] = stamp;
+				stack.push_back(successor);
+			}
+		}
+	}
+	return false;
+}
@@ -0,0 +1,80 @@
+// Filename:	gate_clauses.h
+// Description:	Header file for the clause form of a netlist. Each gate's
+//				function is written as clauses over gate literals, and unit
+//				propagation over them finds implications in both directions
+//				through a gate without simulating.
+
+#ifndef GATE_CLAUSES
+#define GATE_CLAUSES
+
+//STL includes
+#include <cstdint>
+#include <vector>
+
+//user defined includes
+#include "implication_structure.h"
+#include "netlist.h"
+
+//widest XOR written as clauses, one clause per input combination
+#define MAX_XOR_CLAUSE_INPUTS 4
+
+////////////////////////////////////////////////////////////////////////
+// GateClauses class
+//	Literals are in the in memory form (gate | VALUE when the gate is 1).
+//	The clauses of an n input AND are (~y + x) for every input and
+//	(y + ~x1 + ... + ~xn), the other types follow from it. XOR and XNOR
+//	of up to MAX_XOR_CLAUSE_INPUTS inputs are written out in full, and
+//	2 to 1 multiplexers built from AND-OR or NAND-NAND get the two
+//	clauses which make the output known when both data inputs agree,
+//	whatever the select. Flip flops are left free.
+//
+//	Propagation starts from the baseline, where the tie cells are known,
+//	and its result is only valid until the next call.
+////////////////////////////////////////////////////////////////////////
+class GateClauses
+{
+public:
+	GateClauses(const Netlist *netlist);
+	~GateClauses();
+
+	//assigns the seed literals on top of the baseline and propagates them.
+	//implied gets every literal the baseline did not hold, seeds included.
+	//False if the literals conflict, so the seeds can not all hold
+	bool propagate(const ImplicationList &seeds, std::vector<uint32_t> &implied);
+	//true if the last propagation changes the fanin of a gate where two
+	//unknown values from the same source can meet, or of a gate without
+	//clauses, which is where a simulation with X identities may find more
+	bool reachesReconvergence();
+
+	int numClauses() const { return (int) clauseStart.size() - 1; }
+	int numMuxes;
+
+private:
+	void addGate(int gateN);
+	void addMux(int gateN);
+	void addClause(std::vector<uint32_t> &clause);	// drops repeated literals and tautologies
+	bool assign(uint32_t imp);	// false if the gate holds the other value
+	bool unitPropagate(size_t from);	// propagates the trail from position from
+	void markSources();	// fills signature
+	bool related(int gateN, int successor) const;	// gateN may meet a related unknown at successor
+
+	const Netlist *ckt;	// shared topology (not owned)
+	//clause literals back to back, clause c is clauseStart[c] to clauseStart[c + 1]
+	std::vector<uint32_t> clauseLiterals;
+	std::vector<int> clauseStart;
+	//clauses holding the complement of each literal (by literalIndex), the
+	//ones to visit when the literal becomes true
+	std::vector<int> watchStart;
+	std::vector<int> watchClauses;
+
+	std::vector<unsigned char> value;		// 0, 1 or UNASSIGNED per gate
+	std::vector<unsigned char> baseline;	// values with only the ties known
+	std::vector<uint32_t> trail;			// literals assigned by the last propagation
+	std::vector<uint64_t> signature;		// sources of unknowns in the fanin cone, hashed to a bit each
+	std::vector<char> unencoded;			// gates simulated but not written as clauses
+	std::vector<int> visited;				// visit stamp per gate in reachesReconvergence
+	int stamp;
+	size_t stateBytes;
+};
+
+#endif
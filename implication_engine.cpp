@@ -0,0 +1,223 @@
+// Filename:	implication_engine.cpp
+// Description:	Library interface to the gate implication simulator. Wraps a
+//				learned LogicSim, answers batches of closure queries on a
+//				thread pool and simulates vectors on a context of its own.
+
+#include "implication_engine.h"
+#include "implication_export.h"
+#include "logic_sim.h"
+#include "memory_accounting.h"
+#include "perf_counters.h"
+#include "thread_pool.h"
+
+//STL includes
+#include <algorithm>
+#include <thread>
+
+using namespace std;
+
+//batches smaller than this are answered on the calling thread
+#define QUERY_PARALLEL_BATCH 64
+
+EngineOptions::EngineOptions()
+	: order("gate"), fixedPoint(false), sweep(false), prune(false), clauses(false), timeBudgetSeconds(0), iterationCap(0),
+	listMemoryMB(0), signatureBits(0), ternary(false), threads(0), verbose(false)
+{
+}
+
+ImplicationEngine::ImplicationEngine(LogicSim *learned, int threads)
+{
+	sim = learned;
+	context = sim->createContext();
+	if (threads <= 0)
+	{
+		threads = max(1, (int) thread::hardware_concurrency());
+	}
+	pool = threads > 1 ? new ThreadPool(threads) : NULL;
+}
+
+ImplicationEngine::~ImplicationEngine()
+{
+	delete pool;
+	delete context;
+	delete sim;
+}
+
+ImplicationEngine * ImplicationEngine::open(const string &path, const EngineOptions &options, string &error)
+{
+	LearningOptions learning;
+
+	if (!LogicSim::parseLearningOrder(options.order, learning.order))
+	{
+		error = "unknown learning order " + options.order;
+		return NULL;
+	}
+	if (!Netlist::circuitExists(path))
+	{
+		error = "no circuit at " + path;
+		return NULL;
+	}
+	learning.fixedPoint = options.fixedPoint;
+	learning.sweep = options.sweep;
+	learning.prune = options.prune;
+	learning.clauses = options.clauses;
+	learning.timeBudgetMs = (int) (options.timeBudgetSeconds * 1000);
+	learning.iterationCap = options.iterationCap;
+	learning.spillDirectory = options.spillDirectory;
+	learning.listMemoryBytes = (size_t) (options.listMemoryMB * 1024 * 1024);
+	learning.signatureBits = options.signatureBits;
+	learning.ternary = options.ternary;
+
+	LogicSim *sim = new LogicSim(path, options.verbose, false);
+	sim->setLearningOptions(learning);
+	sim->generateImplicationLists();
+	return new ImplicationEngine(sim, options.threads);
+}
+
+ImplicationEngine * ImplicationEngine::openDatabase(const string &path, const string &database, string &error)
+{
+	ImplicationReader lists;
+
+	if (!Netlist::circuitExists(path))
+	{
+		error = "no circuit at " + path;
+		return NULL;
+	}
+	if (!lists.open(database))
+	{
+		error = database + " is not a binary implication export";
+		return NULL;
+	}
+	LogicSim *sim = new LogicSim(path, false, false);
+	if (!sim->loadImplicationLists(lists))
+	{
+		error = database + " was not exported for " + path;
+		delete sim;
+		return NULL;
+	}
+	return new ImplicationEngine(sim, 0);
+}
+
+int ImplicationEngine::numGates() const
+{
+	return sim->numgates;
+}
+
+int ImplicationEngine::numInputs() const
+{
+	return sim->numpri;
+}
+
+int ImplicationEngine::numOutputs() const
+{
+	return sim->getNetlist()->numout;
+}
+
+size_t ImplicationEngine::query(const uint32_t *literals, size_t count, uint32_t *results, size_t capacity, size_t *offsets)
+{
+	vector<vector<uint32_t>> closures(count);
+	size_t i;
+
+	for (i = 0; i < count; i++)
+	{
+		if (literals[i] < 2 || literals[i] >= 2 * (uint32_t) sim->numgates)
+		{
+			return ENGINE_BAD_LITERAL;
+		}
+	}
+	//each closure is built with its own traversal state, so they run in parallel
+	auto body = [&](int begin, int end, int)
+	{
+		PerfScope scope(PerfQuery);
+		ImplicationList closure;
+		for (int q = begin; q < end; q++)
+		{
+			vector<uint32_t> &out = closures[q];
+			if (!sim->buildImplicationList(literalFromIndex(literals[q]), closure))
+			{
+				continue;
+			}
+			out.reserve(closure.size());
+			for (auto it = closure.begin(); it != closure.end(); ++it)
+			{
+				out.push_back(literalIndex(*it));
+			}
+			sort(out.begin(), out.end());
+		}
+	};
+	if (pool != NULL && count >= QUERY_PARALLEL_BATCH)
+	{
+		pool->parallelFor((int) count, QUERY_PARALLEL_BATCH / 4, body);
+	}
+	else
+	{
+		body(0, (int) count, 0);
+	}
+
+	size_t total = 0;
+	for (i = 0; i < count; i++)
+	{
+		offsets[i] = total;
+		total += closures[i].size();
+	}
+	offsets[count] = total;
+	if (total > capacity)
+	{
+		return total;
+	}
+	for (i = 0; i < count; i++)
+	{
+		copy(closures[i].begin(), closures[i].end(), results + offsets[i]);
+	}
+	return total;
+}
+
+bool ImplicationEngine::simulate(const char *vectors, size_t count, char *outputs)
+{
+	int inputs = numInputs();
+	int outs = numOutputs();
+	size_t total = count * inputs;
+
+	//the simulator exits on a bad vector, so they are all checked first
+	for (size_t i = 0; i < total; i++)
+	{
+		char c = vectors[i];
+		if (c != '0' && c != '1' && c != 'x' && c != 'X')
+		{
+			return false;
+		}
+	}
+	lock_guard<mutex> guard(simLock);
+	PerfScope scope(PerfSimulation);
+	string vec;
+	for (size_t v = 0; v < count; v++)
+	{
+		vec.assign(vectors + v * inputs, inputs);
+		context->applyVector(&vec[0]);
+		context->goodsim(false);
+		string values = context->outputValues();
+		copy(values.begin(), values.begin() + outs, outputs + v * outs);
+	}
+	return true;
+}
+
+void ImplicationEngine::stats(EngineStats &out) const
+{
+	const Netlist *circuit = sim->getNetlist();
+
+	out.gates = sim->numgates;
+	out.inputs = sim->numpri;
+	out.outputs = circuit->numout;
+	out.flipFlops = sim->numff;
+	out.implications = sim->numIndirectImplications;
+	out.simulations = sim->numSimulations;
+	out.fixedGates = sim->fixedNodeCounter;
+	out.learningMs = sim->elapsedMsDirect + sim->elapsedMsIndirect;
+	out.literals = sim->coverage.literals;
+	out.coveredLiterals = sim->coverage.covered;
+	out.memoryBytes = 0;
+	for (int subsystem = 0; subsystem < MemSubsystems; subsystem++)
+	{
+		out.memoryBytes += memoryCurrent((MemorySubsystem) subsystem);
+	}
+}
@@ -0,0 +1,106 @@
+// Filename:	implication_engine.h
+// Description:	Header file for the library interface to the gate implication
+//				simulator. Other tools link the engine and query it directly
+//				instead of driving the REPL. Only this header and
+//				implication_engine_c.h are part of the stable interface.
+
+#ifndef IMPLICATION_ENGINE
+#define IMPLICATION_ENGINE
+
+//STL includes
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+class LogicSim;
+class SimContext;
+class ThreadPool;
+
+//returned by ImplicationEngine::query for a literal outside the circuit
+#define ENGINE_BAD_LITERAL ((size_t) -1)
+
+//how a circuit is learned when it is opened
+struct EngineOptions
+{
+	EngineOptions();
+
+	std::string order;			// learning order name: gate (default), level, reverse, cone or priority
+	bool fixedPoint;			// learn to a fixed point instead of a single pass
+	bool sweep;					// learn on the swept netlist
+	bool prune;					// simulate only stems and reconvergence points
+	bool clauses;				// propagate gate clauses before simulating
+	double timeBudgetSeconds;	// stop learning after this long, 0 for no limit
+	int iterationCap;			// simulations per literal, 0 for no limit
+	std::string spillDirectory;	// where lists over listMemoryMB are spilled, and the database kept
+	double listMemoryMB;		// implication lists held in memory, 0 to keep them all
+	int signatureBits;			// random patterns that rule out simulations, 0 for none
+	bool ternary;				// learn with plain 0/1/X simulation
+	int threads;				// workers for batched queries, 0 for one per hardware thread
+	bool verbose;				// print learning progress
+};
+
+struct EngineStats
+{
+	int gates;				// gate ids run from 1 to gates - 1
+	int inputs;
+	int outputs;
+	int flipFlops;
+	long implications;		// implications found by simulation
+	long simulations;		// simulations run while learning
+	long fixedGates;		// gate values which can not occur
+	double learningMs;		// direct and indirect learning time
+	int literals;			// literals in the learning sequence
+	int coveredLiterals;	// literals learning reached before any budget ran out
+	size_t memoryBytes;		// memory tracked for every engine in the process
+};
+
+////////////////////////////////////////////////////////////////////////
+// ImplicationEngine class
+//	A learned circuit. Literals are numbered 2 * gate + value, as in the
+//	export files. Queries only read the implication lists and may run on
+//	any number of threads; simulations are serialized by the engine.
+//	A circuit file which can not be parsed ends the process, as it does
+//	for the simulator itself.
+////////////////////////////////////////////////////////////////////////
+class ImplicationEngine
+{
+public:
+	//reads and learns the circuit at path (path.lev, .lev.gz or .lev.zst),
+	//NULL with a message in error if there is no such circuit
+	static ImplicationEngine * open(const std::string &path, const EngineOptions &options, std::string &error);
+	//reads the circuit and takes its lists from a binary export made for it
+	static ImplicationEngine * openDatabase(const std::string &path, const std::string &database, std::string &error);
+	~ImplicationEngine();
+
+	int numGates() const;
+	int numInputs() const;
+	int numOutputs() const;
+
+	//closures of count literals. The closure of literals[i] is written
+	//sorted to results[offsets[i]] .. results[offsets[i + 1] - 1], so offsets
+	//holds count + 1 entries; an empty closure means the literal can not
+	//occur. Returns the number of results. When that is more than capacity
+	//only offsets are written, and the call can be repeated with a larger
+	//buffer. Returns ENGINE_BAD_LITERAL if a literal is not in the circuit
+	size_t query(const uint32_t *literals, size_t count, uint32_t *results, size_t capacity, size_t *offsets);
+	//simulates count vectors of numInputs() characters (0, 1 or X), one
+	//after another, and writes numOutputs() characters per vector to outputs.
+	//False if a vector holds any other character
+	bool simulate(const char *vectors, size_t count, char *outputs);
+	void stats(EngineStats &out) const;
+
+private:
+	ImplicationEngine(LogicSim *learned, int threads);
+
+	//the engine owns its simulator, so it cannot be copied
+	ImplicationEngine(const ImplicationEngine &);
+	ImplicationEngine & operator=(const ImplicationEngine &);
+
+	LogicSim *sim;
+	SimContext *context;	// for simulate, guarded by simLock
+	ThreadPool *pool;		// for large query batches
+	std::mutex simLock;
+};
+
+#endif
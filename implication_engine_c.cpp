@@ -0,0 +1,107 @@
+// Filename:	implication_engine_c.cpp
+// Description:	C interface to the gate implication engine
+
+#include "implication_engine_c.h"
+#include "implication_engine.h"
+
+//STL includes
+#include <string>
+
+using namespace std;
+
+struct gis_engine
+{
+	ImplicationEngine *engine;
+};
+
+static thread_local string lastError;
+
+static gis_engine * wrap(ImplicationEngine *engine, const string &error)
+{
+	if (engine == NULL)
+	{
+		lastError = error;
+		return NULL;
+	}
+	gis_engine *handle = new gis_engine;
+	handle->engine = engine;
+	return handle;
+}
+
+extern "C" gis_engine * gis_open(const char *path, const char *order, int fixed_point, double time_budget_seconds, int threads)
+{
+	EngineOptions options;
+	string error;
+
+	if (order != NULL)
+	{
+		options.order = order;
+	}
+	options.fixedPoint = fixed_point != 0;
+	options.timeBudgetSeconds = time_budget_seconds;
+	options.threads = threads;
+	return wrap(ImplicationEngine::open(path, options, error), error);
+}
+
+extern "C" gis_engine * gis_open_database(const char *path, const char *database)
+{
+	string error;
+	return wrap(ImplicationEngine::openDatabase(path, database, error), error);
+}
+
+extern "C" void gis_close(gis_engine *engine)
+{
+	if (engine != NULL)
+	{
+		delete engine->engine;
+		delete engine;
+	}
+}
+
+extern "C" const char * gis_last_error(void)
+{
+	return lastError.c_str();
+}
+
+extern "C" int gis_num_gates(const gis_engine *engine)
+{
+	return engine->engine->numGates();
+}
+
+extern "C" int gis_num_inputs(const gis_engine *engine)
+{
+	return engine->engine->numInputs();
+}
+
+extern "C" int gis_num_outputs(const gis_engine *engine)
+{
+	return engine->engine->numOutputs();
+}
+
+extern "C" long long gis_query(gis_engine *engine, const uint32_t *literals, size_t count, uint32_t *results, size_t capacity, size_t *offsets)
+{
+	size_t total = engine->engine->query(literals, count, results, capacity, offsets);
+	return total == ENGINE_BAD_LITERAL ? -1 : (long long) total;
+}
+
+extern "C" int gis_simulate(gis_engine *engine, const char *vectors, size_t count, char *outputs)
+{
+	return engine->engine->simulate(vectors, count, outputs) ? 1 : 0;
+}
+
+extern "C" void gis_get_stats(const gis_engine *engine, gis_stats *out)
+{
+	EngineStats stats;
+	engine->engine->stats(stats);
+	out->gates = stats.gates;
+	out->inputs = stats.inputs;
+	out->outputs = stats.outputs;
+	out->flip_flops = stats.flipFlops;
+	out->implications = stats.implications;
+	out->simulations = stats.simulations;
+	out->fixed_gates = stats.fixedGates;
+	out->learning_ms = stats.learningMs;
+	out->literals = stats.literals;
+	out->covered_literals = stats.coveredLiterals;
+	out->memory_bytes = stats.memoryBytes;
+}
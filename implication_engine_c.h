@@ -0,0 +1,57 @@
+// Filename:	implication_engine_c.h
+// Description:	C interface to the gate implication engine, for tools that
+//				can not link C++ (and for binding it to other languages).
+//				Functions mirror ImplicationEngine in implication_engine.h.
+
+#ifndef IMPLICATION_ENGINE_C
+#define IMPLICATION_ENGINE_C
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct gis_engine gis_engine;
+
+typedef struct gis_stats
+{
+	int gates;
+	int inputs;
+	int outputs;
+	int flip_flops;
+	long implications;
+	long simulations;
+	long fixed_gates;
+	double learning_ms;
+	int literals;
+	int covered_literals;
+	size_t memory_bytes;
+} gis_stats;
+
+//learns the circuit at path with a learning order name (NULL for gate order).
+//NULL on failure, with the reason from gis_last_error
+gis_engine * gis_open(const char *path, const char *order, int fixed_point, double time_budget_seconds, int threads);
+//reads the circuit and takes its lists from a binary export
+gis_engine * gis_open_database(const char *path, const char *database);
+void gis_close(gis_engine *engine);
+//reason the last gis_open on this thread failed
+const char * gis_last_error(void);
+
+int gis_num_gates(const gis_engine *engine);
+int gis_num_inputs(const gis_engine *engine);
+int gis_num_outputs(const gis_engine *engine);
+
+//closures of count literals (2 * gate + value) into results, as
+//ImplicationEngine::query. Returns the number of results, or -1 for a bad literal
+long long gis_query(gis_engine *engine, const uint32_t *literals, size_t count, uint32_t *results, size_t capacity, size_t *offsets);
+//simulates count vectors, 1 on success and 0 for a bad vector
+int gis_simulate(gis_engine *engine, const char *vectors, size_t count, char *outputs);
+void gis_get_stats(const gis_engine *engine, gis_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
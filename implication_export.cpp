@@ -0,0 +1,382 @@
+// Filename:	implication_export.cpp
+// Description:	Bulk export of implication lists. Literals are encoded in
+//				parallel chunks by a thread pool and written in order by the
+//				calling thread, so memory use is bounded by a few chunks.
+
+#include "implication_export.h"
+#include "thread_pool.h"
+
+//STL includes
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+
+//number of literals encoded by one task
+#define EXPORT_CHUNK 4096
+
+//append a little endian fixed width value
+static void appendFixed(std::string &buffer, uint64_t value, int bytes)
+{
+	for (int i = 0; i < bytes; i++)
+	{
+		buffer += (char) ((value >> (8 * i)) & 0xFF);
+	}
+}
+
+static uint64_t readFixed(const unsigned char *pos, int bytes)
+{
+	uint64_t value = 0;
+	for (int i = 0; i < bytes; i++)
+	{
+		value |= (uint64_t) pos[i] << (8 * i);
+	}
+	return value;
+}
+
+void encodeLiteralList(std::string &buffer, std::vector<uint32_t> &literals)
+{
+	uint32_t previous = 0;
+	std::sort(literals.begin(), literals.end());
+	appendVarint(buffer, literals.size());
+	for (size_t i = 0; i < literals.size(); i++)
+	{
+		appendVarint(buffer, literals[i] - previous);
+		previous = literals[i];
+	}
+}
+
+bool decodeLiteralList(const unsigned char *&pos, const unsigned char *end, std::vector<uint32_t> &literals)
+{
+	uint64_t count, delta;
+	uint32_t previous = 0;
+	literals.clear();
+	if (!readVarint(pos, end, count))
+	{
+		return false;
+	}
+	literals.reserve(count);
+	for (uint64_t i = 0; i < count; i++)
+	{
+		if (!readVarint(pos, end, delta))
+		{
+			return false;
+		}
+		previous += (uint32_t) delta;
+		literals.push_back(previous);
+	}
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////
+// ImplicationExporter class
+////////////////////////////////////////////////////////////////////////
+
+ImplicationExporter::ImplicationExporter(const LogicSim *simulator, int numThreads)
+{
+	sim = simulator;
+	threads = numThreads;
+	shardIndex = numShards = 0;
+}
+
+void ImplicationExporter::encodeChunk(uint32_t first, uint32_t last, ExportFormat format, bool closure, std::string &buffer)
+{
+	ImplicationList closureList;
+	std::vector<uint32_t> literals;
+	for (uint32_t literal = first; literal < last; literal++)
+	{
+		uint32_t imp = literalFromIndex(literal);
+		literals.clear();
+		if ((imp & GATE) != 0)
+		{
+			if (closure)
+			{
+				//conflicting closures mean the literal is not reachable
+				if (sim->buildImplicationList(imp, closureList))
+				{
+					for (auto it = closureList.begin(); it != closureList.end(); ++it)
+					{
+						literals.push_back(literalIndex(*it));
+					}
+				}
+			}
+			else
+			{
+				const StoredImplicationList &direct = sim->getDirectList(imp);
+				for (auto it = direct.begin(); it != direct.end(); ++it)
+				{
+					literals.push_back(literalIndex(*it));
+				}
+			}
+		}
+
+		if (format == ExportBinary)
+		{
+			encodeLiteralList(buffer, literals);
+		}
+		else
+		{
+			std::sort(literals.begin(), literals.end());
+			buffer += std::to_string(literal >> 1) + " " + std::to_string(literal & 0x1) + " " + std::to_string(literals.size());
+			for (size_t i = 0; i < literals.size(); i++)
+			{
+				buffer += ' ';
+				buffer += std::to_string(literals[i]);
+			}
+			buffer += '\n';
+		}
+	}
+}
+
+/*
+Chunks are handed to the pool a bounded distance ahead of the writer. The
+writer takes them strictly in literal order, recording the offset of every
+record for the binary index as it goes.
+*/
+bool ImplicationExporter::exportLists(const std::string &path, ExportFormat format, bool closure)
+{
+	uint32_t numLiterals = 2 * sim->numgates;
+	uint32_t numChunks = (numLiterals + EXPORT_CHUNK - 1) / EXPORT_CHUNK;
+	std::vector<std::string> buffers(numChunks);
+	std::vector<char> ready(numChunks, 0);
+	std::vector<uint64_t> offsets;
+	std::mutex readyLock;
+	std::condition_variable chunkReady;
+	std::string header;
+	uint64_t position;
+	uint32_t submitted = 0;
+	bool ok = true;
+
+	FILE *out = fopen(path.c_str(), "wb");
+	if (out == NULL)
+	{
+		return false;
+	}
+	setvbuf(out, NULL, _IOFBF, 1 << 20);
+
+	if (format == ExportBinary)
+	{
+		header.append(EXPORT_MAGIC, 8);
+		appendFixed(header, EXPORT_VERSION, 4);
+		appendFixed(header, (closure ? EXPORT_CLOSURE : 0) | (numShards > 0 ? EXPORT_SHARD : 0), 4);
+		appendFixed(header, sim->numgates, 4);
+		appendFixed(header, numShards > 0 ? ((uint32_t) numShards << 16) | shardIndex : 0, 4);
+		appendFixed(header, 0, 8);	// index offset, patched at the end
+		offsets.reserve(numLiterals + 1);
+	}
+	else
+	{
+		header = "# GateImplicationSim " + std::string(closure ? "closure" : "direct") + " implications, "
+			+ std::to_string(sim->numgates) + " gates: <gate> <value> <count> <literal = 2*gate+value> ...\n";
+	}
+	ok = fwrite(header.data(), 1, header.length(), out) == header.length();
+	position = header.length();
+
+	{
+		ThreadPool pool(threads);
+		uint32_t window = 2 * pool.size() + 2;
+		for (uint32_t chunk = 0; chunk < numChunks; chunk++)
+		{
+			//keep the pool busy without buffering the whole export
+			while (submitted < numChunks && submitted < chunk + window)
+			{
+				uint32_t index = submitted++;
+				pool.submit([&, index](int) {
+					uint32_t first = index * EXPORT_CHUNK;
+					uint32_t last = std::min(numLiterals, first + EXPORT_CHUNK);
+					std::string buffer;
+					encodeChunk(first, last, format, closure, buffer);
+					std::lock_guard<std::mutex> guard(readyLock);
+					buffers[index].swap(buffer);
+					ready[index] = 1;
+					chunkReady.notify_all();
+				});
+			}
+
+			std::unique_lock<std::mutex> guard(readyLock);
+			chunkReady.wait(guard, [&] { return ready[chunk] != 0; });
+			std::string buffer;
+			buffer.swap(buffers[chunk]);
+			guard.unlock();
+
+			if (format == ExportBinary)
+			{
+				//walk the records to find where each one starts
+				const unsigned char *pos = (const unsigned char *) buffer.data();
+				const unsigned char *end = pos + buffer.length();
+				uint64_t count, delta;
+				while (pos < end)
+				{
+					offsets.push_back(position + (pos - (const unsigned char *) buffer.data()));
+					readVarint(pos, end, count);
+					for (uint64_t i = 0; i < count; i++)
+					{
+						readVarint(pos, end, delta);
+					}
+				}
+			}
+			if (ok)
+			{
+				ok = fwrite(buffer.data(), 1, buffer.length(), out) == buffer.length();
+			}
+			position += buffer.length();
+		}
+	}
+
+	if (format == ExportBinary)
+	{
+		std::string index;
+		offsets.push_back(position);
+		for (size_t i = 0; i < offsets.size(); i++)
+		{
+			appendFixed(index, offsets[i], 8);
+		}
+		if (ok)
+		{
+			ok = fwrite(index.data(), 1, index.length(), out) == index.length();
+		}
+		//patch the index offset in the header
+		std::string indexOffset;
+		appendFixed(indexOffset, position, 8);
+		if (ok)
+		{
+			ok = fseek(out, 24, SEEK_SET) == 0 && fwrite(indexOffset.data(), 1, 8, out) == 8;
+		}
+	}
+	if (fclose(out) != 0)
+	{
+		ok = false;
+	}
+	return ok;
+}
+
+////////////////////////////////////////////////////////////////////////
+// ImplicationReader class
+////////////////////////////////////////////////////////////////////////
+
+ImplicationReader::ImplicationReader()
+{
+	file = NULL;
+	numgates = 0;
+	flags = 0;
+	shardIndex = numShards = 0;
+	indexOffset = 0;
+	cache = NULL;
+}
+
+ImplicationReader::~ImplicationReader()
+{
+	close();
+}
+
+void ImplicationReader::setPageCache(size_t bytes)
+{
+	delete cache;
+	cache = new PageCache(bytes);
+}
+
+bool ImplicationReader::open(const std::string &path)
+{
+	unsigned char header[EXPORT_HEADER_SIZE];
+	close();
+	file = fopen(path.c_str(), "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+	if (fread(header, 1, EXPORT_HEADER_SIZE, file) != EXPORT_HEADER_SIZE || memcmp(header, EXPORT_MAGIC, 8) != 0
+		|| readFixed(header + 8, 4) != EXPORT_VERSION)
+	{
+		close();
+		return false;
+	}
+	flags = (uint32_t) readFixed(header + 12, 4);
+	numgates = (uint32_t) readFixed(header + 16, 4);
+	shardIndex = numShards = 0;
+	if (flags & EXPORT_SHARD)
+	{
+		shardIndex = (uint32_t) readFixed(header + 20, 2);
+		numShards = (uint32_t) readFixed(header + 22, 2);
+	}
+	indexOffset = readFixed(header + 24, 8);
+	return true;
+}
+
+void ImplicationReader::close()
+{
+	if (file != NULL)
+	{
+		fclose(file);
+		file = NULL;
+	}
+	delete cache;
+	cache = NULL;
+}
+
+bool ImplicationReader::readBytes(uint64_t offset, size_t length, std::string &out)
+{
+	out.clear();
+	while (length > 0)
+	{
+		uint64_t pageNumber = offset / PAGE_BYTES;
+		std::shared_ptr<const std::string> page = cache->get(pageNumber, [&](std::string &bytes) {
+			bytes.resize(PAGE_BYTES);
+			if (fseek(file, pageNumber * PAGE_BYTES, SEEK_SET) != 0)
+			{
+				return false;
+			}
+			bytes.resize(fread(&bytes[0], 1, PAGE_BYTES, file));
+			return !bytes.empty();
+		});
+		size_t at = offset % PAGE_BYTES;
+		if (page == NULL || at >= page->size())
+		{
+			return false;
+		}
+		size_t take = std::min(length, page->size() - at);
+		out.append(page->data() + at, take);
+		offset += take;
+		length -= take;
+	}
+	return true;
+}
+
+bool ImplicationReader::readList(uint32_t literal, std::vector<uint32_t> &literals)
+{
+	unsigned char range[16];
+	literals.clear();
+	if (file == NULL || literal >= 2 * numgates)
+	{
+		return false;
+	}
+	if (cache != NULL)
+	{
+		std::string bytes;
+		if (!readBytes(indexOffset + 8 * (uint64_t) literal, 16, bytes))
+		{
+			return false;
+		}
+		uint64_t start = readFixed((const unsigned char *) bytes.data(), 8);
+		uint64_t end = readFixed((const unsigned char *) bytes.data() + 8, 8);
+		if (!readBytes(start, end - start, bytes))
+		{
+			return false;
+		}
+		const unsigned char *pos = (const unsigned char *) bytes.data();
+		return decodeLiteralList(pos, pos + bytes.length(), literals);
+	}
+	//two adjacent index entries give the start and end of the record
+	if (fseek(file, indexOffset + 8 * (uint64_t) literal, SEEK_SET) != 0 || fread(range, 1, 16, file) != 16)
+	{
+		return false;
+	}
+	uint64_t start = readFixed(range, 8);
+	uint64_t end = readFixed(range + 8, 8);
+	buffer.resize(end - start);
+	if (fseek(file, start, SEEK_SET) != 0 || fread(&buffer[0], 1, buffer.length(), file) != buffer.length())
+	{
+		return false;
+	}
+	const unsigned char *pos = (const unsigned char *) buffer.data();
+	return decodeLiteralList(pos, pos + buffer.length(), literals);
+}
@@ -0,0 +1,132 @@
+// Filename:	implication_export.h
+// Description:	Header file for bulk export of implication lists, in a compact
+//				delta encoded binary format or a streaming text format, and
+//				for random access reads of the binary format.
+
+#ifndef IMPLICATION_EXPORT
+#define IMPLICATION_EXPORT
+
+//user defined includes
+#include "logic_sim.h"
+#include "page_cache.h"
+
+//STL includes
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/*
+Binary format (all fixed width fields little endian):
+
+	char[8]		magic "GISIMP01"
+	uint32		version
+	uint32		flags (EXPORT_CLOSURE if records hold full closures, EXPORT_SHARD
+				if they hold what one shard of a sharded run learned)
+	uint32		number of gates
+	uint32		shard, the number of shards in the high 16 bits and this
+				shard's index in the low 16 bits (0 unless EXPORT_SHARD)
+	uint64		file offset of the record index
+	records		one per literal 0 .. 2*gates-1 (literal = 2*gate + value):
+				varint count, then count varints, the sorted literals delta
+				encoded against the previous one (the first against 0).
+				A count of 0 marks a literal that is not reachable.
+	index		2*gates+1 uint64 record offsets, the last one is the end of
+				the records, so any single list can be read with two seeks.
+
+Text format: a '#' header line, then one line per literal,
+	<gate> <value> <count> <literal> <literal> ...
+*/
+
+#define EXPORT_MAGIC "GISIMP01"
+#define EXPORT_VERSION 1
+#define EXPORT_HEADER_SIZE 32
+#define EXPORT_CLOSURE 0x1
+#define EXPORT_SHARD 0x2
+
+enum ExportFormat
+{
+	ExportBinary,
+	ExportText
+};
+
+//append an unsigned LEB128 varint
+inline void appendVarint(std::string &buffer, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		buffer += (char) ((value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+	buffer += (char) value;
+}
+
+//read an unsigned LEB128 varint, returns false if it runs past end
+inline bool readVarint(const unsigned char *&pos, const unsigned char *end, uint64_t &value)
+{
+	int shift = 0;
+	value = 0;
+	while (pos < end && shift < 64)
+	{
+		value |= (uint64_t) (*pos & 0x7F) << shift;
+		if (!(*pos++ & 0x80))
+		{
+			return true;
+		}
+		shift += 7;
+	}
+	return false;
+}
+
+//append a list as count followed by delta encoded sorted literals
+void encodeLiteralList(std::string &buffer, std::vector<uint32_t> &literals);
+//decode a list written by encodeLiteralList
+bool decodeLiteralList(const unsigned char *&pos, const unsigned char *end, std::vector<uint32_t> &literals);
+
+class ImplicationExporter
+{
+public:
+	ImplicationExporter(const LogicSim *simulator, int numThreads);
+	//writes every literal's list to path, returns false on an I/O error
+	bool exportLists(const std::string &path, ExportFormat format, bool closure);
+	//marks a binary export as the result of shard index of count
+	void setShard(int index, int count) { shardIndex = index; numShards = count; }
+
+private:
+	//encodes literals [first, last) into buffer
+	void encodeChunk(uint32_t first, uint32_t last, ExportFormat format, bool closure, std::string &buffer);
+
+	const LogicSim *sim;
+	int threads;
+	int shardIndex, numShards;
+};
+
+class ImplicationReader
+{
+public:
+	ImplicationReader();
+	~ImplicationReader();
+	//opens a binary export and reads its header, returns false if it is not one
+	bool open(const std::string &path);
+	void close();
+	//reads the list for literal (2*gate + value), false on an I/O error
+	bool readList(uint32_t literal, std::vector<uint32_t> &literals);
+	//after open, reads go through a page cache of up to bytes instead of
+	//seeking for every list, and may come from several threads at once
+	void setPageCache(size_t bytes);
+	const PageCache * pageCache() const { return cache; }
+
+	uint32_t numgates;
+	uint32_t flags;
+	uint32_t shardIndex, numShards;	// 0 unless flags has EXPORT_SHARD
+
+private:
+	bool readBytes(uint64_t offset, size_t length, std::string &out);	// through the page cache
+
+	FILE *file;
+	uint64_t indexOffset;
+	std::string buffer;
+	PageCache *cache;
+};
+
+#endif
@@ -0,0 +1,321 @@
+// Filename:	implication_spill.cpp
+// Description:	Sorted, compressed run files of spilled implication lists
+
+#include "implication_spill.h"
+#include "implication_export.h"
+
+//STL includes
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace std;
+
+static void appendUint32(string &buffer, uint32_t value)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		buffer += (char) ((value >> (8 * i)) & 0xFF);
+	}
+}
+
+static uint32_t readUint32(const unsigned char *pos)
+{
+	return pos[0] | (pos[1] << 8) | (pos[2] << 16) | ((uint32_t) pos[3] << 24);
+}
+
+//where an edge sets its bits in the filter
+static uint64_t edgeHash(uint32_t literal, uint32_t target)
+{
+	uint64_t hash = (((uint64_t) literal << 32) | target) + 0x9E3779B97F4A7C15ULL;
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+	return hash ^ (hash >> 31);
+}
+
+////////////////////////////////////////////////////////////////////////
+// ListSpill class
+////////////////////////////////////////////////////////////////////////
+
+ListSpill::ListSpill(const string &directory, uint32_t numLiterals, size_t cacheBytes, size_t filterBytes)
+	: cache(cacheBytes)
+{
+	this->directory = directory;
+	isSpilled.assign(numLiterals, 0);
+	filter.assign(max((size_t) 1, filterBytes / sizeof(uint64_t)), 0);
+	memoryAllocated(MemImplications, filter.size() * sizeof(uint64_t));
+	nextRunId = 0;
+	spilledLists = 0;
+	spilledBytes = 0;
+	numCompactions = 0;
+}
+
+ListSpill::~ListSpill()
+{
+	for (size_t r = 0; r < runs.size(); r++)
+	{
+		fclose(runs[r].file);
+		remove(runs[r].path.c_str());
+	}
+	memoryReleased(MemImplications, filter.size() * sizeof(uint64_t));
+}
+
+bool ListSpill::mayHold(uint32_t literal, uint32_t target) const
+{
+	uint64_t hash = edgeHash(literal, target);
+	uint64_t step = (hash >> 32) | 1;
+	uint64_t numBits = filter.size() * 64;
+	for (int i = 0; i < SPILL_FILTER_HASHES; i++)
+	{
+		uint64_t bit = (hash + i * step) % numBits;
+		if ((filter[bit >> 6] & ((uint64_t) 1 << (bit & 63))) == 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void ListSpill::addToFilter(uint32_t literal, const vector<uint32_t> &list)
+{
+	uint64_t numBits = filter.size() * 64;
+	for (size_t i = 0; i < list.size(); i++)
+	{
+		uint64_t hash = edgeHash(literal, list[i]);
+		uint64_t step = (hash >> 32) | 1;
+		for (int k = 0; k < SPILL_FILTER_HASHES; k++)
+		{
+			uint64_t bit = (hash + k * step) % numBits;
+			filter[bit >> 6] |= (uint64_t) 1 << (bit & 63);
+		}
+	}
+}
+
+bool ListSpill::writeRun(vector<SpilledList> &lists)
+{
+	Run run;
+	string raw;
+	bool ok;
+
+	sort(lists.begin(), lists.end(), [](const SpilledList &a, const SpilledList &b) { return a.first < b.first; });
+	ok = startRun(run);
+	for (size_t i = 0; i < lists.size() && ok; i++)
+	{
+		addToFilter(lists[i].first, lists[i].second);
+		isSpilled[lists[i].first] = 1;
+		spilledLists++;
+		ok = appendRecord(run, raw, lists[i].first, lists[i].second);
+	}
+	ok = ok && finishRun(run, raw);
+	//kept even when a write failed, so the destructor removes the file
+	if (run.file != NULL)
+	{
+		runs.push_back(run);
+	}
+	if (ok && runs.size() > SPILL_MAX_RUNS)
+	{
+		ok = compactRuns();
+	}
+	return ok;
+}
+
+bool ListSpill::startRun(Run &run)
+{
+	run.id = nextRunId++;
+	run.path = directory + "/run" + to_string(run.id) + ".spill";
+	run.bytes = 0;
+	run.file = fopen(run.path.c_str(), "w+b");
+	if (run.file == NULL)
+	{
+		return false;
+	}
+	return fwrite(SPILL_MAGIC, 1, 8, run.file) == 8;
+}
+
+bool ListSpill::appendRecord(Run &run, string &raw, uint32_t literal, vector<uint32_t> &list)
+{
+	run.literals.push_back(literal);
+	run.blockOf.push_back(run.blockOffset.size());
+	run.recordStart.push_back(raw.size());
+	appendVarint(raw, literal);
+	encodeLiteralList(raw, list);
+	return raw.size() < SPILL_BLOCK_BYTES || writeBlock(run, raw);
+}
+
+bool ListSpill::finishRun(Run &run, string &raw)
+{
+	return (raw.empty() || writeBlock(run, raw)) && fflush(run.file) == 0;
+}
+
+/*
+Every run is in ascending literal order, so a heap holding the next literal
+of each run gives the records of one literal together. Their lists are
+joined into one record of the merged run, reading each run a block at a time
+around the page cache, which keeps the blocks learning reads. The old runs
+are only removed once the merged one is written.
+*/
+bool ListSpill::compactRuns()
+{
+	typedef pair<uint32_t, size_t> Head;	// next literal of a run, and the run
+	priority_queue<Head, vector<Head>, greater<Head>> heads;
+	vector<size_t> next(runs.size(), 0);
+	vector<string> blocks(runs.size());
+	vector<uint32_t> loaded(runs.size(), UINT32_MAX);
+	vector<uint32_t> list, part;
+	Run merged;
+	string raw;
+
+	for (size_t r = 0; r < runs.size(); r++)
+	{
+		if (!runs[r].literals.empty())
+		{
+			heads.push(Head(runs[r].literals[0], r));
+		}
+	}
+	bool ok = startRun(merged);
+	while (ok && !heads.empty())
+	{
+		uint32_t literal = heads.top().first;
+		list.clear();
+		while (ok && !heads.empty() && heads.top().first == literal)
+		{
+			size_t r = heads.top().second;
+			const Run &run = runs[r];
+			heads.pop();
+			uint32_t block = run.blockOf[next[r]];
+			if (loaded[r] != block)
+			{
+				ok = loadBlock(run, block, blocks[r]);
+				loaded[r] = block;
+			}
+			ok = ok && decodeRecord(blocks[r], run.recordStart[next[r]], literal, part);
+			list.insert(list.end(), part.begin(), part.end());
+			if (++next[r] < run.literals.size())
+			{
+				heads.push(Head(run.literals[next[r]], r));
+			}
+		}
+		sort(list.begin(), list.end());
+		list.erase(unique(list.begin(), list.end()), list.end());
+		ok = ok && appendRecord(merged, raw, literal, list);
+	}
+	ok = ok && finishRun(merged, raw);
+	if (!ok)
+	{
+		if (merged.file != NULL)
+		{
+			fclose(merged.file);
+			remove(merged.path.c_str());
+		}
+		spilledBytes -= merged.bytes;
+		return false;
+	}
+	for (size_t r = 0; r < runs.size(); r++)
+	{
+		fclose(runs[r].file);
+		remove(runs[r].path.c_str());
+		spilledBytes -= runs[r].bytes;
+	}
+	runs.assign(1, merged);
+	numCompactions++;
+	return true;
+}
+
+bool ListSpill::writeBlock(Run &run, string &raw)
+{
+	string stored;
+#ifdef HAVE_ZLIB
+	uLongf size = compressBound(raw.size());
+	stored.resize(size);
+	if (compress2((Bytef *) &stored[0], &size, (const Bytef *) raw.data(), raw.size(), 1) == Z_OK && size < raw.size())
+	{
+		stored.resize(size);
+	}
+	else
+	{
+		stored = raw;
+	}
+#else
+	stored = raw;
+#endif
+	string header;
+	appendUint32(header, raw.size());
+	appendUint32(header, stored.size());
+	off_t offset = ftello(run.file);
+	if (offset < 0 || fwrite(header.data(), 1, header.size(), run.file) != header.size()
+		|| fwrite(stored.data(), 1, stored.size(), run.file) != stored.size())
+	{
+		return false;
+	}
+	run.blockOffset.push_back(offset);
+	run.bytes += header.size() + stored.size();
+	spilledBytes += header.size() + stored.size();
+	raw.clear();
+	return true;
+}
+
+bool ListSpill::loadBlock(const Run &run, uint32_t block, string &raw)
+{
+	unsigned char header[8];
+	if (fseeko(run.file, run.blockOffset[block], SEEK_SET) != 0 || fread(header, 1, 8, run.file) != 8)
+	{
+		return false;
+	}
+	uint32_t rawSize = readUint32(header);
+	uint32_t storedSize = readUint32(header + 4);
+	string stored(storedSize, '\0');
+	if (fread(&stored[0], 1, storedSize, run.file) != storedSize)
+	{
+		return false;
+	}
+	if (storedSize == rawSize)
+	{
+		raw.swap(stored);
+		return true;
+	}
+#ifdef HAVE_ZLIB
+	uLongf size = rawSize;
+	raw.resize(rawSize);
+	return uncompress((Bytef *) &raw[0], &size, (const Bytef *) stored.data(), storedSize) == Z_OK && size == rawSize;
+#else
+	return false;
+#endif
+}
+
+bool ListSpill::decodeRecord(const string &raw, uint32_t start, uint32_t literal, vector<uint32_t> &list)
+{
+	const unsigned char *pos = (const unsigned char *) raw.data() + start;
+	const unsigned char *end = (const unsigned char *) raw.data() + raw.size();
+	uint64_t recordLiteral;
+	return readVarint(pos, end, recordLiteral) && recordLiteral == literal && decodeLiteralList(pos, end, list);
+}
+
+bool ListSpill::readSpilled(uint32_t literal, vector<uint32_t> &targets)
+{
+	vector<uint32_t> list;
+
+	for (size_t r = 0; r < runs.size(); r++)
+	{
+		const Run &run = runs[r];
+		auto found = lower_bound(run.literals.begin(), run.literals.end(), literal);
+		if (found == run.literals.end() || *found != literal)
+		{
+			continue;
+		}
+		size_t record = found - run.literals.begin();
+		uint32_t block = run.blockOf[record];
+		shared_ptr<const string> raw = cache.get(((uint64_t) run.id << 32) | block, [&](string &bytes) {
+			return loadBlock(run, block, bytes);
+		});
+		if (raw == NULL || !decodeRecord(*raw, run.recordStart[record], literal, list))
+		{
+			return false;
+		}
+		targets.insert(targets.end(), list.begin(), list.end());
+	}
+	return true;
+}
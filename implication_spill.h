@@ -0,0 +1,107 @@
+// Filename:	implication_spill.h
+// Description:	Header file for spilling implication lists to disk while
+//				learning, so the lists of a large design need not all fit
+//				in memory at once.
+
+#ifndef IMPLICATION_SPILL
+#define IMPLICATION_SPILL
+
+//STL includes
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+//user defined includes
+#include "page_cache.h"
+
+/*
+Run file format:
+
+	char[8]		magic "GISRUN01"
+	blocks		uint32 raw size, uint32 stored size, then the stored bytes,
+				deflated when zlib was found at build time (stored size
+				equal to the raw size means the block is not compressed).
+				A raw block is a sequence of records, each a varint literal
+				(2*gate + value) and its list as in the binary export.
+				Records are in ascending literal order across the run.
+
+A run's index (literal of each record, its block and its offset in the raw
+block) is kept in memory, the blocks are read back through the page cache.
+Once there are more than SPILL_MAX_RUNS runs they are merged into one, so a
+read never looks in more than that many.
+*/
+
+#define SPILL_MAGIC "GISRUN01"
+//raw bytes of records gathered into one block before it is written
+#define SPILL_BLOCK_BYTES 65536
+//runs kept before they are merged into one
+#define SPILL_MAX_RUNS 8
+//bits set in the spilled edge filter per edge
+#define SPILL_FILTER_HASHES 3
+//file the spilled lists are merged into at the end of learning
+#define SPILL_DATABASE "implications.gis"
+
+//one literal's list to spill, both in the 2*gate + value numbering
+typedef std::pair<uint32_t, std::vector<uint32_t>> SpilledList;
+
+////////////////////////////////////////////////////////////////////////
+// ListSpill class
+//	A literal may be spilled many times as it gains edges, each time to a
+//	new run, and its spilled list is the union of what every run holds.
+//	Every spilled edge is also entered in a Bloom filter, so an edge added
+//	to a spilled literal's resident list (which holds its edges until the
+//	next run) only needs the list read back when the filter says it may
+//	be on disk already.
+////////////////////////////////////////////////////////////////////////
+class ListSpill
+{
+public:
+	ListSpill(const std::string &directory, uint32_t numLiterals, size_t cacheBytes, size_t filterBytes);
+	~ListSpill();	// removes the run files
+
+	//writes the lists to a new run, sorting them by literal, and merges the
+	//runs once there are too many. False on an I/O error
+	bool writeRun(std::vector<SpilledList> &lists);
+	bool spilled(uint32_t literal) const { return isSpilled[literal] != 0; }
+	//false if no run holds the edge, true if one may
+	bool mayHold(uint32_t literal, uint32_t target) const;
+	//appends the spilled list of literal from every run, false on an I/O error
+	bool readSpilled(uint32_t literal, std::vector<uint32_t> &targets);
+
+	int numRuns() const { return (int) runs.size(); }
+	long spilledLists;		// lists written over all runs
+	size_t spilledBytes;	// bytes in the current runs
+	int numCompactions;		// times the runs were merged into one
+	PageCache cache;		// decoded blocks of every run
+
+private:
+	struct Run
+	{
+		uint32_t id;		// names the file and keys its cached blocks
+		std::string path;
+		FILE *file;
+		size_t bytes;
+		std::vector<uint32_t> literals;		// literal of each record, ascending
+		std::vector<uint32_t> blockOf;		// block holding each record
+		std::vector<uint32_t> recordStart;	// offset of each record in its raw block
+		std::vector<uint64_t> blockOffset;	// file offset of each block header
+	};
+	bool startRun(Run &run);
+	bool appendRecord(Run &run, std::string &raw, uint32_t literal, std::vector<uint32_t> &list);
+	bool finishRun(Run &run, std::string &raw);
+	bool writeBlock(Run &run, std::string &raw);
+	bool loadBlock(const Run &run, uint32_t block, std::string &raw);
+	static bool decodeRecord(const std::string &raw, uint32_t start, uint32_t literal, std::vector<uint32_t> &list);
+	bool compactRuns();	// k-way merge of every run into one
+	void addToFilter(uint32_t literal, const std::vector<uint32_t> &list);
+
+	std::string directory;
+	std::vector<Run> runs;
+	uint32_t nextRunId;
+	std::vector<char> isSpilled;	// per literal, some run holds part of its list
+	std::vector<uint64_t> filter;	// Bloom filter of the spilled edges
+};
+
+#endif
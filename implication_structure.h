@@ -6,9 +6,30 @@
 #ifndef IMPLICATION_STRUCTURE
 #define IMPLICATION_STRUCTURE
 
+#include <cstdint>
+#include <functional>
 #include <unordered_set>
 
+#include "memory_accounting.h"
+
 //a list of implications (msb is value, 1 or 0)
 typedef std::unordered_set<uint32_t> ImplicationList;
 
+//the list a circuit keeps for each literal, counted as implication memory.
+//Closures and other transient lists are ImplicationLists, which are not
+typedef std::unordered_set<uint32_t, std::hash<uint32_t>, std::equal_to<uint32_t>,
+	CountingAllocator<uint32_t, MemImplications> > StoredImplicationList;
+
+//dense literal numbering used outside of memory (files, sockets): 2 * gate + value
+inline uint32_t literalIndex(uint32_t imp)
+{
+	return ((imp & 0x7FFFFFFF) << 1) | (imp >> 31);
+}
+
+//inverse of literalIndex, returns the msb-is-value form
+inline uint32_t literalFromIndex(uint32_t index)
+{
+	return (index >> 1) | ((index & 0x1) << 31);
+}
+
 #endif
@@ -0,0 +1,397 @@
+// Filename:	lev_reader.cpp
+// Description:	Parallel tokenizer for *.lev circuit files, with support for
+//				gzip and zstd compressed input
+
+#include "lev_reader.h"
+
+//STL includes
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+//system includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+//user defined includes
+#include "netlist.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+//skips spaces and line ends, true if anything is left
+static inline bool skipSpace(const char *&p, const char *end)
+{
+	while (p < end && (*p == SPACE || *p == TAB || *p == RETURN || *p == '\r'))
+	{
+		p++;
+	}
+	return p < end;
+}
+
+//reads the next integer, false at the end of the range or on a non-number
+static inline bool readInt(const char *&p, const char *end, int &value)
+{
+	if (!skipSpace(p, end))
+	{
+		return false;
+	}
+	from_chars_result result = from_chars(p, end, value);
+	if (result.ec != errc())
+	{
+		return false;
+	}
+	p = result.ptr;
+	return true;
+}
+
+//file names are passed to the shell in single quotes
+static string shellQuote(const string &text)
+{
+	string quoted = "'";
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		if (text[i] == '\'')
+			quoted += "'\\''";
+		else
+			quoted += text[i];
+	}
+	return quoted + "'";
+}
+
+static bool endsWith(const string &text, const string &suffix)
+{
+	return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+// LevReader class
+////////////////////////////////////////////////////////////////////////
+
+LevReader::LevReader()
+{
+	count = 0;
+	data = NULL;
+	size = 0;
+	mapping = NULL;
+}
+
+LevReader::~LevReader()
+{
+	if (mapping != NULL)
+	{
+		munmap(mapping, size);
+	}
+}
+
+//the uncompressed file is preferred when there are several
+string LevReader::findFile(string cktName)
+{
+	const char *suffixes[] = {".lev", ".lev.gz", ".lev.zst"};
+	for (int i = 0; i < 3; i++)
+	{
+		string fileName = cktName + suffixes[i];
+		if (access(fileName.c_str(), R_OK) == 0)
+		{
+			return fileName;
+		}
+	}
+	return "";
+}
+
+bool LevReader::mapFile(string fileName)
+{
+	struct stat info;
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	if (fstat(fd, &info) != 0)
+	{
+		close(fd);
+		return false;
+	}
+	size = info.st_size;
+	if (size > 0)
+	{
+		mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED)
+		{
+			mapping = NULL;
+			close(fd);
+			return false;
+		}
+		madvise(mapping, size, MADV_SEQUENTIAL);
+	}
+	close(fd);
+	data = (const char *) mapping;
+	return true;
+}
+
+//gzip is read with zlib where it was found at build time, otherwise (and
+//for zstd) the command line tool is run on the file
+bool LevReader::decompress(string fileName)
+{
+	char block[1 << 16];
+	buffer.clear();
+#ifdef HAVE_ZLIB
+	if (endsWith(fileName, ".gz"))
+	{
+		gzFile in = gzopen(fileName.c_str(), "rb");
+		if (in == NULL)
+		{
+			return false;
+		}
+		gzbuffer(in, sizeof(block));
+		int got;
+		while ((got = gzread(in, block, sizeof(block))) > 0)
+		{
+			buffer.append(block, got);
+		}
+		bool ok = got == 0;
+		gzclose(in);
+		data = buffer.data();
+		size = buffer.size();
+		return ok;
+	}
+#endif
+	string command = (endsWith(fileName, ".gz") ? "gzip -dc " : "zstd -dc ") + shellQuote(fileName);
+	FILE *in = popen(command.c_str(), "r");
+	if (in == NULL)
+	{
+		return false;
+	}
+	size_t got;
+	while ((got = fread(block, 1, sizeof(block), in)) > 0)
+	{
+		buffer.append(block, got);
+	}
+	bool ok = pclose(in) == 0;
+	data = buffer.data();
+	size = buffer.size();
+	return ok;
+}
+
+/*
+Reads whole records from the chunk, with the same layout and checks as the
+original stream reader: netnum, type, level, fanin count, the fanin list
+twice, the fanout count and list, and the observability values (a number,
+a single character and two more numbers). A record cut off by the end of
+the chunk leaves the chunk incomplete.
+*/
+void LevReader::parseChunk(Chunk &chunk, int count)
+{
+	const char *p = chunk.begin;
+	const char *end = chunk.end;
+	int netnum, f1, f2, f3, junk, j;
+
+	chunk.complete = true;
+	while (skipSpace(p, end))
+	{
+		if (!readInt(p, end, netnum) || !readInt(p, end, f1) || !readInt(p, end, f2) || !readInt(p, end, f3))
+		{
+			chunk.complete = false;
+			return;
+		}
+		if (netnum < 0 || netnum >= count)
+		{
+			chunk.error = "Gate number " + to_string(netnum) + " out of range\n";
+			return;
+		}
+		if (f2 < 0 || f2 + 5 > MAXlevels)
+		{
+			chunk.error = "MAXIMUM level (" + to_string(f2 + 5) + ") exceeded.\n";
+			return;
+		}
+		if (f3 < 0 || f3 > MAXFanout)
+		{
+			chunk.error = "Fanin count (" + to_string(f3) + " exceeded\n";
+			return;
+		}
+		chunk.records.push_back(netnum);
+		chunk.records.push_back(f1);
+		chunk.records.push_back(f2);
+		chunk.records.push_back(f3);
+
+		for (j = 0; j < f3; j++)
+		{
+			if (!readInt(p, end, f1))
+			{
+				chunk.complete = false;
+				return;
+			}
+			chunk.lists.push_back(f1);
+		}
+		for (j = 0; j < f3; j++)	// followed by close to samethings
+		{
+			if (!readInt(p, end, junk))
+			{
+				chunk.complete = false;
+				return;
+			}
+		}
+		if (!readInt(p, end, f1) || f1 < 0)
+		{
+			chunk.complete = false;
+			return;
+		}
+		if (f1 > MAXFanout)
+		{
+			chunk.error = "Fanout count (" + to_string(f1) + ") exceeded\n";
+			return;
+		}
+		chunk.records.push_back(f1);
+		for (j = 0; j < chunk.records.back(); j++)
+		{
+			if (!readInt(p, end, f1))
+			{
+				chunk.complete = false;
+				return;
+			}
+			chunk.lists.push_back(f1);
+		}
+		// observability values, the character is skipped as it stands
+		if (!readInt(p, end, junk) || !skipSpace(p, end))
+		{
+			chunk.complete = false;
+			return;
+		}
+		p++;
+		if (!readInt(p, end, junk) || !readInt(p, end, junk))
+		{
+			chunk.complete = false;
+			return;
+		}
+	}
+}
+
+/*
+The header is read first, then the rest of the file is cut into one chunk
+per thread at line ends. Chunks are tokenized in parallel, and a second
+parallel pass copies them into the staging vectors at offsets found from
+their sizes.
+*/
+bool LevReader::read(string fileName)
+{
+	int junk;
+	bool compressed = endsWith(fileName, ".gz") || endsWith(fileName, ".zst");
+	if (!(compressed ? decompress(fileName) : mapFile(fileName)))
+	{
+		cerr << "Can't open .lev file\n";
+		return false;
+	}
+
+	const char *p = data;
+	const char *end = data + size;
+	if (!readInt(p, end, count) || !readInt(p, end, junk))
+	{
+		cerr << "Missing gate count in " << fileName << "\n";
+		return false;
+	}
+	records.clear();
+	lists.clear();
+	if (count <= 1)
+	{
+		return true;
+	}
+
+	int numThreads = thread::hardware_concurrency();
+	int numChunks = size < LEV_PARALLEL_BYTES || numThreads < 2 ? 1 : numThreads;
+	vector<Chunk> chunks(numChunks);
+	const char *start = p;
+	for (int i = 0; i < numChunks; i++)
+	{
+		const char *cut = i + 1 == numChunks ? end : start + (end - start) * (i + 1) / numChunks;
+		cut = find(max(cut, p), end, RETURN);
+		if (cut < end)
+		{
+			cut++;
+		}
+		chunks[i].begin = p;
+		chunks[i].end = cut;
+		p = cut;
+	}
+
+	ThreadPool *pool = numChunks > 1 ? new ThreadPool(numChunks) : NULL;
+	if (pool != NULL)
+	{
+		pool->parallelFor(numChunks, 1, [&chunks, this](int begin, int last, int /*worker*/)
+		{
+			for (int i = begin; i < last; i++)
+			{
+				parseChunk(chunks[i], count);
+			}
+		});
+	}
+	else
+	{
+		parseChunk(chunks[0], count);
+	}
+
+	//a record split over lines was cut, read the whole file on one thread
+	for (int i = 0; i + 1 < numChunks; i++)
+	{
+		if (!chunks[i].complete && chunks[i].error.empty())
+		{
+			chunks.assign(1, Chunk());
+			chunks[0].begin = start;
+			chunks[0].end = end;
+			parseChunk(chunks[0], count);
+			break;
+		}
+	}
+
+	vector<size_t> recordAt(chunks.size() + 1, 0);
+	vector<size_t> listAt(chunks.size() + 1, 0);
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		if (!chunks[i].error.empty())
+		{
+			cerr << chunks[i].error;
+			delete pool;
+			return false;
+		}
+		recordAt[i + 1] = recordAt[i] + chunks[i].records.size();
+		listAt[i + 1] = listAt[i] + chunks[i].lists.size();
+	}
+	if (recordAt.back() < 5 * (size_t) (count - 1))
+	{
+		cerr << "Unexpected end of " << fileName << " after " << recordAt.back() / 5 << " of " << count - 1 << " gates\n";
+		delete pool;
+		return false;
+	}
+
+	records.resize(recordAt.back());
+	lists.resize(listAt.back());
+	auto copyChunks = [&](int begin, int last, int /*worker*/)
+	{
+		for (int i = begin; i < last; i++)
+		{
+			copy(chunks[i].records.begin(), chunks[i].records.end(), records.begin() + recordAt[i]);
+			copy(chunks[i].lists.begin(), chunks[i].lists.end(), lists.begin() + listAt[i]);
+		}
+	};
+	if (pool != NULL && chunks.size() > 1)
+		pool->parallelFor(chunks.size(), 1, copyChunks);
+	else
+		copyChunks(0, chunks.size(), 0);
+	delete pool;
+
+	//records past the gate count are ignored, as the stream reader did
+	size_t used = 0;
+	for (size_t r = 0; r < 5 * (size_t) (count - 1); r += 5)
+	{
+		used += records[r + 3] + records[r + 4];
+	}
+	records.resize(5 * (count - 1));
+	lists.resize(used);
+	return true;
+}
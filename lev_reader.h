@@ -0,0 +1,67 @@
+// Filename:	lev_reader.h
+// Description:	Header file for the *.lev text loader. The file is mapped (or
+//				decompressed into memory for *.lev.gz and *.lev.zst), cut
+//				into chunks at line ends and tokenized on several threads.
+//				The result is the staging layout the Netlist is built from.
+
+#ifndef LEV_READER
+#define LEV_READER
+
+//STL includes
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//files smaller than this are tokenized by the calling thread alone
+#define LEV_PARALLEL_BYTES (1 << 20)
+
+////////////////////////////////////////////////////////////////////////
+// LevReader class
+//	Each gate record of a .lev file is expected on one line, which is what
+//	lets the file be split without reading it first. A chunk which ends
+//	inside a record is detected, and the file is then read again by one
+//	thread, so files with other line breaks still load correctly.
+////////////////////////////////////////////////////////////////////////
+class LevReader
+{
+public:
+	LevReader();
+	~LevReader();
+
+	//the file read for cktName (plain, .gz or .zst), empty if there is none
+	static std::string findFile(std::string cktName);
+	//loads and tokenizes the file, false (with a message) if it can't be read
+	bool read(std::string fileName);
+
+	int count;					// gate count from the header
+	std::vector<int> records;	// netnum, type, level, fanin, fanout per gate
+	std::vector<int> lists;		// fanin list followed by fanout list per gate
+
+private:
+	//parsed output of one chunk of the file
+	struct Chunk
+	{
+		const char *begin;
+		const char *end;
+		std::vector<int> records;
+		std::vector<int> lists;
+		bool complete;		// chunk ended on a record boundary
+		std::string error;
+	};
+
+	bool mapFile(std::string fileName);
+	bool decompress(std::string fileName);
+	static void parseChunk(Chunk &chunk, int count);
+
+	//file contents, either mapped or held in buffer
+	const char *data;
+	size_t size;
+	void *mapping;
+	std::string buffer;
+
+	//the reader owns the mapping, so it cannot be copied
+	LevReader(const LevReader &);
+	LevReader & operator=(const LevReader &);
+};
+
+#endif
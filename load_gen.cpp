@@ -0,0 +1,240 @@
+// Filename:	load_gen.cpp
+// Description:	Load generator for the gate implication query server. Opens
+//				a number of concurrent clients, pipelines random requests and
+//				reports queries per second and latency percentiles.
+
+//STL includes
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+//system includes
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+struct LoadOptions
+{
+	string socketPath;
+	int clients;
+	int requests;	// per client
+	int depth;		// requests in flight per client
+	string mix;		// imp, gate, sim or mixed
+};
+
+//opens a connection to the server, exits on failure
+int connectServer(const string &path)
+{
+	struct sockaddr_un addr;
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+	if (fd < 0 || connect(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0)
+	{
+		cerr << "ERROR: Could not connect to " << path << ": " << strerror(errno) << endl;
+		exit(EXIT_FAILURE);
+	}
+	return fd;
+}
+
+//reads one response line, keeping any extra bytes in pending
+bool readLine(int fd, string &pending, string &line)
+{
+	char buffer[65536];
+	size_t end;
+	while ((end = pending.find('\n')) == string::npos)
+	{
+		ssize_t count = read(fd, buffer, sizeof(buffer));
+		if (count <= 0)
+		{
+			return false;
+		}
+		pending.append(buffer, count);
+	}
+	line = pending.substr(0, end);
+	pending.erase(0, end + 1);
+	return true;
+}
+
+bool sendAll(int fd, const string &data)
+{
+	size_t written = 0;
+	while (written < data.length())
+	{
+		ssize_t count = send(fd, data.data() + written, data.length() - written, MSG_NOSIGNAL);
+		if (count <= 0)
+		{
+			return false;
+		}
+		written += count;
+	}
+	return true;
+}
+
+//one client, records the latency of every request in nanoseconds
+void runClient(const LoadOptions &options, int numGates, int numPI, int seed, vector<long> &latencies, long &errors)
+{
+	mt19937 rng(seed);
+	uniform_int_distribution<int> gateDist(1, numGates - 1);
+	uniform_int_distribution<int> bitDist(0, 2);
+	deque<Clock::time_point> inFlight;
+	string pending;
+	string line;
+	string batch;
+	int sent = 0;
+	int fd = connectServer(options.socketPath);
+
+	errors = 0;
+	latencies.reserve(options.requests);
+	while ((int) latencies.size() < options.requests)
+	{
+		//top up the pipeline
+		batch.clear();
+		while (sent < options.requests && (int) inFlight.size() < options.depth)
+		{
+			string kind = options.mix;
+			if (kind == "mixed")
+			{
+				int pick = bitDist(rng);
+				kind = pick == 0 ? "imp" : (pick == 1 ? "gate" : "sim");
+			}
+			if (kind == "sim")
+			{
+				batch += "sim ";
+				for (int i = 0; i < numPI; i++)
+				{
+					batch += "01X"[bitDist(rng)];
+				}
+			}
+			else if (kind == "gate")
+			{
+				batch += "gate " + to_string(gateDist(rng));
+			}
+			else
+			{
+				batch += "imp " + to_string(gateDist(rng)) + " " + to_string(bitDist(rng) & 1);
+			}
+			batch += '\n';
+			inFlight.push_back(Clock::now());
+			sent++;
+		}
+		if (!batch.empty() && !sendAll(fd, batch))
+		{
+			break;
+		}
+		if (!readLine(fd, pending, line))
+		{
+			break;
+		}
+		latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - inFlight.front()).count());
+		inFlight.pop_front();
+		if (line.compare(0, 2, "OK") != 0)
+		{
+			errors++;
+		}
+	}
+	sendAll(fd, "quit\n");
+	close(fd);
+}
+
+void printUsage()
+{
+	cerr << "Usage: ImplicationLoadGen <socket> [--clients n] [--requests n] [--depth n] [--mix imp|gate|sim|mixed]" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+	LoadOptions options;
+	options.clients = 8;
+	options.requests = 10000;
+	options.depth = 16;
+	options.mix = "imp";
+
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		if (arg == "--clients" && i + 1 < argc)
+			options.clients = atoi(argv[++i]);
+		else if (arg == "--requests" && i + 1 < argc)
+			options.requests = atoi(argv[++i]);
+		else if (arg == "--depth" && i + 1 < argc)
+			options.depth = max(1, atoi(argv[++i]));
+		else if (arg == "--mix" && i + 1 < argc)
+			options.mix = argv[++i];
+		else if (arg[0] != '-' && options.socketPath.empty())
+			options.socketPath = arg;
+		else
+		{
+			printUsage();
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (options.socketPath.empty())
+	{
+		printUsage();
+		exit(EXIT_FAILURE);
+	}
+
+	//ask the server for the circuit size so requests stay in range
+	int numGates, numPI, numPO, numFF;
+	{
+		string pending, line;
+		int fd = connectServer(options.socketPath);
+		if (!sendAll(fd, "ckt\n") || !readLine(fd, pending, line)
+			|| sscanf(line.c_str(), "OK %d %d %d %d", &numGates, &numPI, &numPO, &numFF) != 4)
+		{
+			cerr << "ERROR: Unexpected response to ckt: " << line << endl;
+			exit(EXIT_FAILURE);
+		}
+		sendAll(fd, "quit\n");
+		close(fd);
+	}
+
+	vector<vector<long>> latencies(options.clients);
+	vector<long> errors(options.clients);
+	vector<thread> clients;
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < options.clients; i++)
+	{
+		clients.emplace_back(runClient, cref(options), numGates, numPI, i + 1, ref(latencies[i]), ref(errors[i]));
+	}
+	for (size_t i = 0; i < clients.size(); i++)
+	{
+		clients[i].join();
+	}
+	double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+	vector<long> all;
+	long totalErrors = 0;
+	for (int i = 0; i < options.clients; i++)
+	{
+		all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+		totalErrors += errors[i];
+	}
+	if (all.empty())
+	{
+		cerr << "ERROR: No responses received" << endl;
+		exit(EXIT_FAILURE);
+	}
+	sort(all.begin(), all.end());
+	auto percentile = [&all](double p) { return all[min(all.size() - 1, (size_t) (p * all.size()))] / 1000.0; };
+
+	cout << "clients: " << options.clients << ", pipeline depth: " << options.depth << ", mix: " << options.mix << endl;
+	cout << "requests: " << all.size() << " (" << totalErrors << " errors) in " << seconds << " s" << endl;
+	cout << "throughput: " << (long) (all.size() / seconds) << " queries/s" << endl;
+	cout << "latency us: p50 " << percentile(0.50) << ", p90 " << percentile(0.90) << ", p99 " << percentile(0.99)
+		<< ", p99.9 " << percentile(0.999) << ", max " << all.back() / 1000.0 << endl;
+	exit(EXIT_SUCCESS);
+}
@@ -10,15 +10,17 @@
 ///////////////////////////////////////////////////////////////////////
 
 #include "logic_sim.h"
+#include "fanout_regions.h"
+#include "gate_clauses.h"
+#include "implication_export.h"
+#include "implication_spill.h"
+#include "perf_counters.h"
+#include "random_signatures.h"
+#include "ternary_sim.h"
 
-using namespace std;
+#include <algorithm>
 
-////////////////////////////////////////////////////////////////////////
-inline void LogicSim::insertEvent(int levelN, int gateN)
-{
-    levelEvents[levelN][levelLen[levelN]] = gateN;
-    levelLen[levelN]++;
-}
+using namespace std;
 
 ////////////////////////////////////////////////////////////////////////
 // LogicSim class
@@ -31,288 +33,360 @@ LogicSim::LogicSim()
 }
 
 // constructor: reads in the *.lev file for the gate-level ckt
-LogicSim::LogicSim(string cktName)
+LogicSim::LogicSim(string cktName, bool verbose, bool learn)
+{
+	//read the shared topology and create the primary simulation context
+	Netlist *circuit;
+	{
+		PerfScope scope(PerfLoad);
+		circuit = new Netlist(cktName);
+	}
+	setup(circuit, verbose);
+	derived = false;
+
+	//generate implication lists
+	if (learn)
+	{
+		generateImplicationLists();
+	}
+}
+
+// constructor: simulator for a netlist built from another circuit
+LogicSim::LogicSim(Netlist *circuit, bool verbose)
+{
+	setup(circuit, verbose);
+	derived = true;
+}
+
+void LogicSim::setup(Netlist *circuit, bool verbose)
 {
 	//set initial values
-	x_number = 4;			//distinguishing X starting value
-	TIES = new int[512];	//initialize array for ties
-	INIT0 = 0;				//don't initialize FF's
+	verboseLearning = verbose;
+	stopRequested = false;
 	fixedNodeCounter = 0;
 	
 	numSimulations = 0;
 	numIndirectImplications = 0;
-
-    ifstream yyin;
-    string fName;
-    int i, j, count;
-    char c;
-    int netnum, junk;
-    int f1, f2, f3;
-    int levelSize[MAXlevels];
-
-    fName = cktName + ".lev";
-    yyin.open(fName.c_str(), ios::in);
-    if (!yyin)
-    {
-	cerr << "Can't open .lev file\n";
-	exit(-1);
-    }
-
-    numpri = numgates = numout = maxlevels = numff = 0;
-    maxLevelSize = 32;
-    for (i=0; i<MAXlevels; i++)
-	levelSize[i] = 0;
-
-    yyin >>  count;	// number of gates
-    yyin >> junk;
-
-    // allocate space for gates
-    gtype = new unsigned char[count+64];
-    fanin = new short[count+64];
-    fanout = new short[count+64];
-    levelNum = new int[count+64];
-    po = new unsigned[count+64];
-    inlist = new int * [count+64];
-    fnlist = new int * [count+64];
-    sched = new char[count+64];
-
-	//instantiate array for gate values
-    GateValues = new unsigned int[count+64];
-	OrigGateValues = new unsigned int[count + 64];
+	elapsedMsDirect = elapsedMsIndirect = 0;
+	numLearningPasses = 0;
+	learning = LearningOptions();
+	coverage.literals = coverage.covered = coverage.capped = 0;
+	coverage.stopReason = "complete";
+	numPrunedLiterals = 0;
+	numClauseLiterals = numClauseImplications = 0;
+	numSignatureSkips = 0;
+	resumedMs = 0;
+	reduced = NULL;
+	sweepMap = NULL;
+	simPool = NULL;
+	spill = NULL;
+	database = NULL;
+	ternary = NULL;
+	gateClauses = NULL;
+	randomSignatures = NULL;
+
+	netlist = circuit;
+	ctx = new SimContext(netlist);
+
+	numgates = netlist->numgates;
+	numpri = netlist->numpri;
+	numff = netlist->numff;
+
+	//instantiate array for default gate values
+	OrigGateValues = new unsigned int[numgates + 64];
 
 	//instantiate implication list arrays
-	zeroList = new ImplicationList[count + 64];
-	oneList = new ImplicationList[count + 64];
-
-    // now read in the circuit
-    numTieNodes = 0;
-    for (i=1; i<count; i++)
-    {
-	yyin >> netnum;
-	yyin >> f1;
-	yyin >> f2;
-	yyin >> f3;
+	zeroList = new StoredImplicationList[numgates + 64];
+	oneList = new StoredImplicationList[numgates + 64];
+	for (int i = 0; i < numgates + 64; i++)
+	{
+		zeroList[i] = StoredImplicationList(StoredImplicationList::allocator_type(&listMemory));
+		oneList[i] = StoredImplicationList(StoredImplicationList::allocator_type(&listMemory));
+	}
+	memoryAllocated(MemSimState, (numgates + 64) * sizeof(unsigned int));
+	memoryAllocated(MemImplications, 2 * (numgates + 64) * sizeof(StoredImplicationList));
+	listMemory.allocated(2 * (numgates + 64) * sizeof(StoredImplicationList));
+}
 
-	numgates++;
-	gtype[netnum] = (unsigned char) f1;
-	f2 = (int) f2;
-	levelNum[netnum] = f2;
-	levelSize[f2]++;
+//destructor, contexts must be released before the netlist they reference
+LogicSim::~LogicSim()
+{
+	delete reduced.load();
+	delete sweepMap;
+	delete ctx;
+	delete simPool;
+	delete spill;
+	delete database;
+	delete ternary;
+	delete gateClauses;
+	delete randomSignatures;
+	delete netlist;
+	delete[] OrigGateValues;
+	delete[] zeroList;
+	delete[] oneList;
+	memoryReleased(MemSimState, (numgates + 64) * sizeof(unsigned int));
+	memoryReleased(MemImplications, 2 * (numgates + 64) * sizeof(StoredImplicationList));
+	listMemory.released(2 * (numgates + 64) * sizeof(StoredImplicationList));
+}
 
-	if (f2 >= (maxlevels))
-	    maxlevels = f2 + 5;
-	if (maxlevels > MAXlevels)
+//creates an additional, independent simulation context on this circuit
+SimContext * LogicSim::createContext() const
+{
+	if (reduced != NULL)
 	{
-	    cerr << "MAXIMUM level (" << maxlevels << ") exceeded.\n";
-	    exit(-1);
+		return reduced.load()->createContext();
 	}
+	return new SimContext(netlist);
+}
 
-	fanin[netnum] = (int) f3;
-	if (f3 > MAXFanout)
+//apply an input vector to the primary simulation context
+void LogicSim::applyVector(char *vec)
+{
+	if (reduced != NULL)
 	{
-		cerr << "Fanin count (" << f3 << " exceeded\n";
-		exit(-1);
+		reduced.load()->applyVector(vec);
+		return;
 	}
-		
-	if (gtype[netnum] == T_input)
+	ctx->applyVector(vec);
+}
+
+//apply only the changes from the last vector to the primary simulation context
+int LogicSim::applyVectorDelta(const char *vec)
+{
+	if (reduced != NULL)
 	{
-	    inputs[numpri] = netnum;
-	    numpri++;
+		return reduced.load()->applyVectorDelta(vec);
 	}
-	if (gtype[netnum] == T_dff)
+	return ctx->applyVectorDelta(vec);
+}
+
+long LogicSim::simulationEvents() const
+{
+	if (reduced != NULL)
 	{
-	    if (numff >= (MAXFFS-1))
-	    {
-		cerr << "The circuit has more than " << MAXFFS -1 << " FFs\n";
-		exit(-1);
-	    }
-	    ff_list[numff] = netnum;
-	    numff++;
+		return reduced.load()->simulationEvents();
 	}
+	return ctx->numEvents;
+}
 
-	sched[netnum] = 0;
+string LogicSim::outputValues() const
+{
+	if (reduced != NULL)
+	{
+		return reduced.load()->outputValues();
+	}
+	return ctx->outputValues();
+}
 
-	// now read in the faninlist
-	inlist[netnum] = new int[fanin[netnum]];
-	for (j=0; j<fanin[netnum]; j++)
+//logic simulate the primary simulation context
+void LogicSim::goodsim(bool verbose)
+{
+	numSimulations++;
+	if (reduced != NULL)
 	{
-	    yyin >> f1;
-	    inlist[netnum][j] = (int) f1;
+		reduced.load()->goodsim(verbose);
+		return;
 	}
+	ctx->goodsim(verbose);
+}
 
-	for (j=0; j<fanin[netnum]; j++)	  // followed by close to samethings
-	    yyin >> junk;
+//the pool is only used by the primary context, contexts for other threads
+//stay serial
+void LogicSim::setSimulationThreads(int numThreads)
+{
+	ctx->setThreadPool(NULL);
+	delete simPool;
+	simPool = NULL;
+	if (numThreads > 1)
+	{
+		simPool = new ThreadPool(numThreads);
+		ctx->setThreadPool(simPool);
+	}
+	if (reduced != NULL)
+	{
+		reduced.load()->setSimulationThreads(numThreads);
+	}
+}
 
-	// read in the fanout list
-	yyin >> f1;
-	fanout[netnum] = (int) f1;
+//the reduced circuit, once there is one, learns in place of this one
+void LogicSim::requestStop()
+{
+	stopRequested = true;
+	LogicSim *small = reduced;
+	if (small != NULL)
+	{
+		small->requestStop();
+	}
+}
 
-	if (gtype[netnum] == T_output)
+void LogicSim::generateImplicationLists()
+{
+	if (learning.sweep && !derived)
 	{
-	    po[netnum] = TRUE;
-	    outputs[numout] = netnum;
-	    numout++;
+		sweepAndLearn();
+		return;
 	}
-	else
-	    po[netnum] = 0;
+	startDirect = chrono::steady_clock::now();
+	{
+		PerfScope scope(PerfDirect);
+		genDirectImplications();
+	}
+	if (verboseLearning)
+		cout << "Finished finding all direct implications\n";
+	endDirect = chrono::steady_clock::now();
+	elapsedMsDirect = chrono::duration_cast<chrono::milliseconds>(endDirect - startDirect).count();
+	{
+		PerfScope scope(PerfIndirect);
+		genIndirectImplications();
+	}
+	if (verboseLearning)
+		cout << "Finished finding all indirect implications\n";
+	endIndirect = chrono::steady_clock::now();
+	elapsedMsIndirect = chrono::duration_cast<chrono::milliseconds>(endIndirect - endDirect).count() + resumedMs;
+}
 
-	if (fanout[netnum] > MAXFanout)
-	    cerr << "Fanout count (" << fanout[netnum] << ") exceeded\n";
+//approximate memory footprint, counting hash set buckets and nodes
+size_t LogicSim::memoryUsage() const
+{
+	size_t bytes = netlist->memoryBytes();
+	//primary context: values, schedule flags, event wheel
+	bytes += (numgates + 64) * (sizeof(unsigned int) + sizeof(char));
+	bytes += (size_t) netlist->maxlevels * (netlist->maxLevelSize + 1) * sizeof(int);
+	bytes += (numgates + 64) * sizeof(unsigned int);	// OrigGateValues
+	for (int i = 0; i < numgates + 64; i++)
+	{
+		bytes += 2 * sizeof(StoredImplicationList);
+		bytes += (zeroList[i].bucket_count() + oneList[i].bucket_count()) * sizeof(void *);
+		//each entry is a separately allocated node (next pointer and key, plus malloc overhead)
+		bytes += (zeroList[i].size() + oneList[i].size()) * 4 * sizeof(void *);
+	}
+	if (reduced != NULL)
+	{
+		bytes += reduced.load()->memoryUsage();
+	}
+	return bytes;
+}
 
-	fnlist[netnum] = new int[fanout[netnum]];
-	for (j=0; j<fanout[netnum]; j++)
+//the implication lists are counted as they grow. The netlist is added, but
+//not the contexts, which do not grow while learning
+size_t LogicSim::trackedMemory() const
+{
+	size_t bytes = listMemory.current() + netlist->memoryBytes();
+	if (reduced != NULL)
 	{
-	    yyin >> f1;
-	    fnlist[netnum][j] = (int) f1;
+		bytes += reduced.load()->trackedMemory();
 	}
+	return bytes;
+}
 
-	if (gtype[netnum] == T_tie1)
-        {
-	    TIES[numTieNodes] = netnum;
-	    numTieNodes++;
-	    if (numTieNodes > 511)
-	    {
-		cerr, "Can't handle more than 512 tied nodes\n";
-		exit(-1);
-	    }
-			GateValues[netnum] = 1;
-        }
-        else if (gtype[netnum] == T_tie0)
-        {
-	    TIES[numTieNodes] = netnum;
-	    numTieNodes++;
-	    if (numTieNodes > 511)
-	    {
-		cerr << "Can't handle more than 512 tied nodes\n";
-		exit(-1);
-	    }
-			GateValues[netnum] = 0;
-        }
-        else
-        {
-	    // assign all values to unknown (unassigned x)
-	    GateValues[netnum] = ALLONES;
-	}
-
-	// read in and discard the observability values
-        yyin >> junk;
-        yyin >> c;    // some character here
-        yyin >> junk;
-        yyin >> junk;
-
-    }	// for (i...)
-    yyin.close();
-    numgates++;
-    numFaultFreeGates = numgates;
-
-    // now compute the maximum width of the level
-    for (i=0; i<maxlevels; i++)
-    {
-	if (levelSize[i] > maxLevelSize)
-	    maxLevelSize = levelSize[i] + 1;
-    }
-
-    // allocate space for the faulty gates
-    for (i = numgates; i < numgates+64; i+=2)
-    {
-        inlist[i] = new int[2];
-        fnlist[i] = new int[MAXFanout];
-        po[i] = 0;
-        fanin[i] = 2;
-        inlist[i][0] = i+1;
-	sched[i] = 0;
-    }
-
-    goodState = new char[numff];
-    ffMap = new int[numgates];
-    // get the ffMap
-    for (i=0; i<numff; i++)
-    {
-	ffMap[ff_list[i]] = i;
-	goodState[i] = 'X';
-    }
-
-    setupWheel(maxlevels, maxLevelSize);
-    setFaninoutMatrix();
-
-    if (INIT0)	// if start from a initial state
-    {
-	RESET_FF1 = new unsigned int [numff+2];
-	RESET_FF2 = new unsigned int [numff+2];
-
-	fName = cktName + ".initState";
-	yyin.open(fName.c_str(), ios::in);
-	if (!yyin)
-	{	cerr << "Can't open " << fName << "\n";
-		exit(-1);}
-
-	for (i=0; i<numff; i++)
-	{
-	    yyin >>  c;
-
-	    if (c == '0')
-	    {
-		RESET_FF1[i] = 0;
-		RESET_FF2[i] = 0;
-	    }
-	    else if (c == '1')
-	    {
-		RESET_FF1[i] = ALLONES;
-		RESET_FF2[i] = ALLONES;
-	    }
-	    else 
-	    {
-		RESET_FF1[i] = 0;
-		RESET_FF2[i] = ALLONES;
-	    }
-	}
-
-	yyin.close();
-    }
+ImplicationList LogicSim::getImplicationList(uint32_t imp) const
+{
+	ImplicationList currentList;
+	buildImplicationList(imp, currentList);
+	return currentList;
+}
 
-	//generate implication lists
-	generateImplicationLists();
+//returns the stored (not transitively closed) list of implications for imp.
+//A list on disk is read into a scratch list (counted like the stored ones,
+//it holds one list at a time), valid until the next call on this thread
+const StoredImplicationList & LogicSim::getDirectList(uint32_t imp) const
+{
+	const StoredImplicationList &list = (imp & VALUE) ? oneList[imp & GATE] : zeroList[imp & GATE];
+	if (database == NULL && (spill == NULL || !spill->spilled(literalIndex(imp))))
+	{
+		return list;
+	}
+	static thread_local StoredImplicationList scratch;
+	std::vector<uint32_t> targets;
+	readDirectList(imp, targets);
+	scratch.clear();
+	scratch.insert(targets.begin(), targets.end());
+	return scratch;
 }
 
-void LogicSim::generateImplicationLists()
+//the direct list of imp: the database once learning has finished, otherwise
+//the resident list and whatever was spilled of it. An empty resident list is
+//a fixed node, whatever was spilled before it was fixed
+void LogicSim::readDirectList(uint32_t imp, std::vector<uint32_t> &targets) const
+{
+	std::vector<uint32_t> literals;
+	targets.clear();
+	if (database != NULL)
+	{
+		if (!database->readList(literalIndex(imp), literals))
+		{
+			cerr << "ERROR: Could not read implications for gate " << (imp & GATE) << " from " << databasePath() << endl;
+			exit(-1);
+		}
+		for (size_t i = 0; i < literals.size(); i++)
+		{
+			targets.push_back(literalFromIndex(literals[i]));
+		}
+		return;
+	}
+	const StoredImplicationList &list = (imp & VALUE) ? oneList[imp & GATE] : zeroList[imp & GATE];
+	targets.assign(list.begin(), list.end());
+	if (!list.empty() && spill != NULL && spill->spilled(literalIndex(imp)))
+	{
+		if (!spill->readSpilled(literalIndex(imp), literals))
+		{
+			cerr << "ERROR: Could not read spilled implications for gate " << (imp & GATE) << endl;
+			exit(-1);
+		}
+		for (size_t i = 0; i < literals.size(); i++)
+		{
+			targets.push_back(literalFromIndex(literals[i]));
+		}
+	}
+}
+
+std::string LogicSim::databasePath() const
 {
-	startDirect = clock();
-	genDirectImplications();
-	cout << "Finished finding all direct implications\n";
-	endDirect = clock();
-	elapsedMsDirect = ((endDirect - startDirect) * 1000) / CLOCKS_PER_SEC;
-	genIndirectImplications();
-	cout << "Finished finding all indirect implications\n";
-	endIndirect = clock();
-	elapsedMsIndirect = ((endIndirect - endDirect) * 1000) / CLOCKS_PER_SEC;
+	if (database == NULL)
+	{
+		return "";
+	}
+	return learning.spillDirectory + "/" + SPILL_DATABASE;
 }
 
-ImplicationList LogicSim::getImplicationList(uint32_t imp)
+//Builds the full list of implications for imp into currentList. Uses only
+//local state, so any number of threads may query concurrently once learning
+//has finished. Returns false if the implications conflict (imp is not reachable)
+bool LogicSim::buildImplicationList(uint32_t imp, ImplicationList &currentList) const
 {
 	//treats implications like a linked list. Traverses the list, starting at the specified node
+	ImplicationList traversedList;
+	bool badImpValue = false;
 	currentList.clear();
-	traversedList.clear();
-	badImpValue = false;
 	//mark first node as traversed
 	traversedList.insert(imp);
-	if (imp & VALUE)
+	if (spill != NULL || database != NULL)
+	{
+		std::vector<uint32_t> targets;
+		readDirectList(imp, targets);
+		for (size_t i = 0; i < targets.size(); i++)
+		{
+			recursiveListGen(targets[i], currentList, traversedList, badImpValue);
+		}
+	}
+	else if (imp & VALUE)
 	{
 		for (auto it = oneList[imp & GATE].begin(); it != oneList[imp & GATE].end(); ++it)
 		{
-			recursiveListGen(*it);
+			recursiveListGen(*it, currentList, traversedList, badImpValue);
 		}
 	}
 	else
 	{
 		for (auto it = zeroList[imp & GATE].begin(); it != zeroList[imp & GATE].end(); ++it)
 		{
-			recursiveListGen(*it);
+			recursiveListGen(*it, currentList, traversedList, badImpValue);
 		}
 	}
-	return currentList;
+	return !badImpValue;
 }
 
-void LogicSim::recursiveListGen(uint32_t imp)
+void LogicSim::recursiveListGen(uint32_t imp, ImplicationList &currentList, ImplicationList &traversedList, bool &badImpValue) const
 {
 	//check for conflicting implications
 	if (badImpValue)
@@ -330,18 +404,27 @@ void LogicSim::recursiveListGen(uint32_t imp)
 	if (traversedList.count(imp) == 0)
 	{
 		traversedList.insert(imp);
-		if (imp & VALUE)
+		if (spill != NULL || database != NULL)
+		{
+			std::vector<uint32_t> targets;
+			readDirectList(imp, targets);
+			for (size_t i = 0; i < targets.size(); i++)
+			{
+				recursiveListGen(targets[i], currentList, traversedList, badImpValue);
+			}
+		}
+		else if (imp & VALUE)
 		{
 			for (auto it = oneList[imp & GATE].begin(); it != oneList[imp & GATE].end(); ++it)
 			{
-				recursiveListGen(*it);
+				recursiveListGen(*it, currentList, traversedList, badImpValue);
 			}
 		}
 		else
 		{
 			for (auto it = zeroList[imp & GATE].begin(); it != zeroList[imp & GATE].end(); ++it)
 			{
-				recursiveListGen(*it);
+				recursiveListGen(*it, currentList, traversedList, badImpValue);
 			}
 		}
 	}
@@ -375,15 +458,15 @@ void LogicSim::firstLevelImplications(uint32_t imp)
 	//find gate number and values
 	gateNum = imp & GATE;
 	gateVal = imp & VALUE;
-	switch (gtype[gateNum])
+	switch (netlist->gtype[gateNum])
 	{
 	case T_and:
 		if (gateVal)
 		{
 			//AND at 1 implies all fanin is 1
-			for (index = 0; index < fanin[gateNum]; index++)
+			for (index = 0; index < netlist->fanin[gateNum]; index++)
 			{
-				localList.push_back(inlist[gateNum][index] | VALUE);
+				localList.push_back(netlist->inlist[gateNum][index] | VALUE);
 			}
 		}
 		break;
@@ -391,9 +474,9 @@ void LogicSim::firstLevelImplications(uint32_t imp)
 		if (!gateVal)
 		{
 			//NAND at 0 implies all fanin is 1
-			for (index = 0; index < fanin[gateNum]; index++)
+			for (index = 0; index < netlist->fanin[gateNum]; index++)
 			{
-				localList.push_back(inlist[gateNum][index] | VALUE);
+				localList.push_back(netlist->inlist[gateNum][index] | VALUE);
 			}
 		}
 		break;
@@ -401,9 +484,9 @@ void LogicSim::firstLevelImplications(uint32_t imp)
 		if (!gateVal)
 		{
 			//OR at 0 implies all fanin is 0
-			for (index = 0; index < fanin[gateNum]; index++)
+			for (index = 0; index < netlist->fanin[gateNum]; index++)
 			{
-				localList.push_back(inlist[gateNum][index]);
+				localList.push_back(netlist->inlist[gateNum][index]);
 			}
 		}
 		break;
@@ -411,31 +494,31 @@ void LogicSim::firstLevelImplications(uint32_t imp)
 		if (gateVal)
 		{
 			//NOR at 1 implies all fanin is 0
-			for (index = 0; index < fanin[gateNum]; index++)
+			for (index = 0; index < netlist->fanin[gateNum]; index++)
 			{
-				localList.push_back(inlist[gateNum][index]);
+				localList.push_back(netlist->inlist[gateNum][index]);
 			}
 		}
 		break;
 	case T_output:
 		//implies that value is present on fanin
-		localList.push_back(inlist[gateNum][0] | gateVal);
+		localList.push_back(netlist->inlist[gateNum][0] | gateVal);
 		break;
 	case T_buf:
 		//implies that value is present on fanin
-		localList.push_back(inlist[gateNum][0] | gateVal);
+		localList.push_back(netlist->inlist[gateNum][0] | gateVal);
 		break;
 	case T_not:
 		//implies opposite value is present on fanin
 		if (gateVal)
 		{
 			//add 0 implication for input
-			localList.push_back(inlist[gateNum][0] & GATE);
+			localList.push_back(netlist->inlist[gateNum][0] & GATE);
 		}
 		else
 		{
 			//add 1 implication for input
-			localList.push_back(inlist[gateNum][0] | VALUE);
+			localList.push_back(netlist->inlist[gateNum][0] | VALUE);
 		}
 		break;
 	default:
@@ -492,799 +575,916 @@ A seperate list tracks the number of elements in each node list. This function
 only returns when the number of elements does not change between simulation 
 passes, indicating that all indirect implications have been found.
 */
-void LogicSim::genIndirectImplications()
+/*
+Literals are learned in the configured order. A single pass learns each
+literal once, so a literal only sees implications found before its turn
+(including contrapositives of edges learned for other literals).
+With fixedPoint set, later passes learn again every literal whose closure
+reaches a list that changed after that literal was last learned, until a
+pass changes nothing.
+*/
+void LogicSim::genIndirectImplications(const std::vector<char> *learnOnly)
 {
+	std::vector<uint32_t> sequence;
+	LearningProgress progress;
+	bool budgetHit = false;
+
 	//run initial simulation to set OrigGateValues
 	initialSim();
-	//for each gate, perform simulations until done
-	for (int i = 1; i < numgates; i++)
+	numPrunedLiterals = 0;
+	numClauseLiterals = numClauseImplications = 0;
+	numSignatureSkips = 0;
+	buildLearningSequence(learnOnly, sequence);
+	startLearningHelpers();
+	startProgress(progress, sequence.size());
+	//lists which can not be spilled (every literal keeps one) stay in memory,
+	//so after a spill the next one waits until memory grows by a quarter again
+	size_t spillAt = learning.listMemoryBytes;
+	if (!learning.spillDirectory.empty() && learning.listMemoryBytes > 0)
 	{
-		indirectImplicationSim(i);
-		indirectImplicationSim(i | VALUE);
+		delete spill;
+		spill = new ListSpill(learning.spillDirectory, 2 * numgates, learning.listMemoryBytes / 8, learning.listMemoryBytes / 16);
 	}
-}
 
-void LogicSim::indirectImplicationSim(uint32_t imp)
-{
-	bool done = false;
-	int index;
-	int gateN;
-	int successor;
-	int sucLevel;
-	ImplicationList currentList;
-	while (!done)
+	while (!stopRequested && !budgetHit)
 	{
-		//reset the circuit to its default state (simulated with all X inputs)
-		resetCircuit();
-		//for the given node, add all implications successors to the event wheel
-		currentList = getImplicationList(imp);
-		//if there was a bad implication value (conflicting) clear the list for the current imp
-		if (badImpValue)
-		{
-			fixedNodeCounter++;
-			badImpValue = false;
-			if (imp & VALUE)
-			{
-				oneList[imp & GATE].clear();
-			}
-			else
-			{
-				zeroList[imp & GATE].clear();
-			}
-			return;
-		}
-		for (auto it = currentList.begin(); it != currentList.end(); ++it)
+		numLearningPasses = progress.pass;
+		budgetHit = !learningPass(sequence, progress, spillAt);
+		if (stopRequested || budgetHit || !learning.fixedPoint)
 		{
-			gateN = *it & GATE;
-			GateValues[gateN] = (*it & VALUE) >> 31;
-			for (index = 0; index<fanout[gateN]; index++)
-			{
-				successor = fnlist[gateN][index];
-				sucLevel = levelNum[successor];
-				insertEvent(sucLevel, successor);
-				sched[successor] = 1;
-			}
-		}
-		//run simulation
-		goodsim(false);
-		if (changes.size() > 0)
-		{
-			numIndirectImplications = numIndirectImplications + changes.size();
-			done = false;
-			//add the changes found from simulation
-			for (index = 0; index < changes.size(); index++)
-			{
-				if (imp & VALUE)
-				{
-					oneList[imp & GATE].insert(changes[index]);
-				}
-				else
-				{
-					zeroList[imp & GATE].insert(changes[index]);
-				}
-			}
+			break;
 		}
-		else
+		if (verboseLearning)
+			cout << "Finished learning pass " << progress.pass << "\n";
+		if (!progress.changed)
 		{
-			//done with this node if no new implications are found
-			done = true;
+			break;
 		}
+		findStaleLiterals(progress.learnedAt, progress.changedAt, progress.stale);
+		progress.pass++;
+		progress.position = 0;
+		progress.changed = false;
 	}
-}
-
-//restores circuit values to defaults, when all inputs are X
-void LogicSim::resetCircuit()
-{
-	for (int i = 0; i < numgates; i++)
+	if (stopRequested && !budgetHit)
 	{
-		GateValues[i] = OrigGateValues[i];
+		coverage.stopReason = "stopped";
 	}
-	x_number = x_number_reset;
-	changes.clear();
-}
-
-//performs initial simulation with all X inputs. These "default" values 
-//are used to check for implications during the indirect implication stage
-void LogicSim::initialSim()
-{
-	char * vec = new char[numpri];
-	for (int i = 0; i < numpri; i++)
+	coverage.covered = progress.pass > 1 ? sequence.size() : progress.position;
+	if (verboseLearning && (budgetHit || coverage.capped > 0))
 	{
-		vec[i] = 'x';
+		cout << "Learning covered " << coverage.covered << " of " << coverage.literals << " literals (" << coverage.stopReason
+			<< "), " << coverage.capped << " literals stopped at the iteration cap\n";
 	}
-	applyVector(vec);
-	goodsim(false);
-	for (int i = 0; i < numgates; i++)
+	finishLearningHelpers();
+	//the last checkpoint holds the finished lists, or where a stopped run got to
+	if (!learning.checkpointPath.empty())
+	{
+		writeCheckpoint(progress, sequence.size());
+	}
+	if (spill != NULL)
 	{
-		OrigGateValues[i] = GateValues[i];
+		finishSpill();
 	}
-	x_number_reset = x_number;
 }
 
-void LogicSim::printGateInfo(int gateNumber)
+//the literals to learn: every literal in the configured order, then only
+//those in learnOnly, those the pruning keeps and this shard's share
+void LogicSim::buildLearningSequence(const std::vector<char> *learnOnly, std::vector<uint32_t> &sequence)
 {
-	if (gateNumber > numgates)
-	{
-		cout << "ERROR: Invalid gate number" << endl;
-		return;
-	}
-	cout << "Gate Type: ";
-	switch (gtype[gateNumber])
+	learningSequence(sequence);
+	if (learnOnly != NULL)
 	{
-	case T_and:
-		cout << "AND" << endl;
-		break;
-	case T_nand:
-		cout << "NAND" << endl;
-		break;
-	case T_or:
-		cout << "OR" << endl;
-		break;
-	case T_nor:
-		cout << "NOR" << endl;
-		break;
-	case T_xor:
-		cout << "XOR" << endl;
-		break;
-	case T_xnor:
-		cout << "XNOR" << endl;
-		break;
-	case T_not:
-		cout << "Inverter" << endl;
-		break;
-	case T_buf:
-		cout << "Buffer" << endl;
-		break;
-	case T_dff:
-		cout << "D Flip Flop" << endl;
-		break;
-	case T_output:
-		cout << "Primary Output" << endl;
-		break;
-	case T_input:
-		cout << "Primary Input" << endl;
-		break;
-	default:
-		cout << "ERROR: Invalid Gate Type" << endl;
-		return;
-		break;
+		sequence.erase(std::remove_if(sequence.begin(), sequence.end(),
+			[learnOnly](uint32_t imp) { return !(*learnOnly)[literalIndex(imp)]; }), sequence.end());
 	}
-	cout << "Direct Fan-In:";
-	for (int i = 0; i < fanin[gateNumber]; i++)
+	if (learning.prune)
 	{
-		cout << " " << inlist[gateNumber][i];
+		pruneSequence(sequence);
 	}
-	cout << endl << "Direct Fan-Out:";
-	for (int i = 0; i < fanout[gateNumber]; i++)
+	if (learning.numShards > 1)
 	{
-		cout << " " << fnlist[gateNumber][i];
+		size_t kept = 0;
+		for (size_t i = learning.shardIndex; i < sequence.size(); i += learning.numShards)
+		{
+			sequence[kept++] = sequence[i];
+		}
+		sequence.resize(kept);
+		if (verboseLearning)
+			cout << "Shard " << learning.shardIndex << " of " << learning.numShards << " learning " << kept << " literals\n";
 	}
-	cout << endl;
-}
-
-void LogicSim::printCircuitInfo()
-{
-	cout << "\t" << numpri << " PIs.\n";
-	cout << "\t" << numout << " POs.\n";
-	cout << "\t" << numff << " Dffs.\n";
-	cout << "\t" << numFaultFreeGates << " total number of gates.\n";
-	cout << "\t" << maxlevels / 5 << " levels in the circuit.\n";
 }
 
-////////////////////////////////////////////////////////////////////////
-// setFaninoutMatrix()
-//	This function builds the matrix of succOfPredOutput and 
-// predOfSuccInput.
-////////////////////////////////////////////////////////////////////////
-void LogicSim::setFaninoutMatrix()
+//the gate clauses, random pattern signatures and ternary simulator the
+//learning options ask for
+void LogicSim::startLearningHelpers()
 {
-    int i, j, k;
-    int predecessor, successor;
-    int checked[MAXFanout];
-    int checkID;	// needed for gates with fanouts to SAME gate
-    int prevSucc, found;
-
-    predOfSuccInput = new int *[numgates+64];
-    succOfPredOutput = new int *[numgates+64];
-    for (i=0; i<MAXFanout; i++)
-	checked[i] = 0;
-    checkID = 1;
-
-    prevSucc = -1;
-    for (i=1; i<numgates; i++)
-    {
-	predOfSuccInput[i] = new int [fanout[i]];
-	succOfPredOutput[i] = new int [fanin[i]];
-
-	for (j=0; j<fanout[i]; j++)
-	{
-	    if (prevSucc != fnlist[i][j])
-		checkID++;
-	    prevSucc = fnlist[i][j];
-
-	    successor = fnlist[i][j];
-	    k=found=0;
-	    while ((k<fanin[successor]) && (!found))
-	    {
-		if ((inlist[successor][k] == i) && (checked[k] != checkID))
-		{
-		    predOfSuccInput[i][j] = k;
-		    checked[k] = checkID;
-		    found = 1;
-		}
-		k++;
-	    }
+	if (learning.clauses)
+	{
+		gateClauses = new GateClauses(netlist);
+		if (verboseLearning)
+			cout << "Wrote " << gateClauses->numClauses() << " gate clauses (" << gateClauses->numMuxes << " multiplexers)\n";
 	}
-
-	for (j=0; j<fanin[i]; j++)
+	signatureChecks = 0;
+	if (learning.signatureBits > 0)
 	{
-	    if (prevSucc != inlist[i][j])
-		checkID++;
-	    prevSucc = inlist[i][j];
-
-	    predecessor = inlist[i][j];
-	    k=found=0;
-	    while ((k<fanout[predecessor]) && (!found))
-	    {
-		if ((fnlist[predecessor][k] == i) && (checked[k] != checkID))
+		randomSignatures = new RandomSignatures(netlist, learning.signatureBits);
+		if (randomSignatures->usable())
+		{
+			randomSignatures->index(OrigGateValues);
+			if (verboseLearning)
+				cout << "Simulated " << 64 * randomSignatures->numWords << " random patterns, " << randomSignatures->numEquivalentGates
+					<< " gates in " << randomSignatures->numEquivalenceClasses << " candidate equivalence classes\n";
+		}
+		else
 		{
-		    succOfPredOutput[i][j] = k;
-		    checked[k] = checkID;
-		    found=1;
+			if (verboseLearning)
+				cout << "Random pattern signatures are not used, the circuit has FFs or unsupported gates\n";
+			delete randomSignatures;
+			randomSignatures = NULL;
 		}
-		k++;
-	    }
 	}
-    }
-
-    for (i=numgates; i<numgates+64; i+=2)
-    {
-	predOfSuccInput[i] = new int[MAXFanout];
-	succOfPredOutput[i] = new int[MAXFanout];
-    }
+	if (learning.ternary)
+	{
+		delete ternary;
+		ternary = new TernarySim(netlist);
+		ternary->setResetValues(OrigGateValues);
+	}
 }
 
-////////////////////////////////////////////////////////////////////////
-// setTieEvents()
-//	This function set up the events for tied nodes
-////////////////////////////////////////////////////////////////////////
-void LogicSim::setTieEvents()
+void LogicSim::finishLearningHelpers()
 {
-    int predecessor, successor;
-    int i, j;
-
-    for (i = 0; i < numTieNodes; i++)
-    {
-	  // different from previous time frame, place in wheel
-	  for (j=0; j<fanout[TIES[i]]; j++)
-	  {
-	    successor = fnlist[TIES[i]][j];
-	    if (sched[successor] == 0)
-	    {
-	    	insertEvent(levelNum[successor], successor);
-			sched[successor] = 1;
-	    }
-	  }
-    }	// for (i...)
-
-    // initialize state if necessary
-    if (INIT0 == 1)
-    {
-cout << "Initialize circuit to values in *.initState!\n";
-	for (i=0; i<numff; i++)
-	{
-	    GateValues[ff_list[i]] = RESET_FF1[i];
-
-	  for (j=0; j<fanout[ff_list[i]]; j++)
-	  {
-	    successor = fnlist[ff_list[i]][j];
-	    if (sched[successor] == 0)
-	    {
-	    	insertEvent(levelNum[successor], successor);
-		sched[successor] = 1;
-	    }
-	  }	// for j
-
-	    predecessor = inlist[ff_list[i]][0];
-		GateValues[predecessor] = RESET_FF1[i];
-	  for (j=0; j<fanout[predecessor]; j++)
-	  {
-	    successor = fnlist[predecessor][j];
-	    if (sched[successor] == 0)
-	    {
-	    	insertEvent(levelNum[successor], successor);
-		sched[successor] = 1;
-	    }
-	  }	// for j
-
-	}	// for i
-    }	// if (INIT0)
+	delete gateClauses;
+	gateClauses = NULL;
+	delete randomSignatures;
+	randomSignatures = NULL;
+	delete ternary;
+	ternary = NULL;
 }
 
-////////////////////////////////////////////////////////////////////////
-// applyVector()
-//	This function applies the vector to the inputs of the ckt.
-////////////////////////////////////////////////////////////////////////
-void LogicSim::applyVector(char *vec)
+//continues from the checkpoint when resuming from one, otherwise starts the
+//first pass with every literal stale
+void LogicSim::startProgress(LearningProgress &progress, size_t sequenceLength)
 {
-    int successor;
-    int i, j;
-
-    for (i = 0; i < numpri; i++)
-    {
-	  switch (vec[i])
-	  {
-	    case '0':
-		GateValues[inputs[i]] = 0;
-		break;
-	    case '1':
-		GateValues[inputs[i]] = 1;
-		break;
-	    case 'x':
-	    case 'X':
-		//assign to current X instance
-		GateValues[inputs[i]] = x_number;
-		//increment the x counter
-		x_number = x_number + 2;
-		break;
-	    default:
-		cerr << vec[i] << ": error in the input vector.\n";
-		exit(-1);
-	  }	// switch
-
-	  // different from previous time frame, place in wheel
-	  for (j=0; j<fanout[inputs[i]]; j++)
-	  {
-	    successor = fnlist[inputs[i]][j];
-	    if (sched[successor] == 0)
-	    {
-	    	insertEvent(levelNum[successor], successor);
-			sched[successor] = 1;
-	    }
-	  }
-    }	// for (i...)
+	resumedMs = 0;
+	coverage.capped = 0;
+	if (!learning.resume || !readCheckpoint(progress, sequenceLength))
+	{
+		progress.pass = 1;
+		progress.position = 0;
+		progress.step = 0;
+		progress.changed = false;
+		progress.learnedAt.assign(2 * numgates, 0);
+		progress.changedAt.assign(2 * numgates, 0);
+		progress.stale.assign(2 * numgates, 1);
+	}
+	progress.started = progress.lastCheckpoint = progress.lastReport = chrono::steady_clock::now();
+	progress.startSimulations = numSimulations;
+	progress.startStep = progress.step;
+	coverage.literals = sequenceLength;
+	coverage.stopReason = "complete";
 }
 
-////////////////////////////////////////////////////////////////////////
-// lowWheel class
-////////////////////////////////////////////////////////////////////////
-
-void LogicSim::setupWheel(int numLevels, int levelSize)
+//learns the stale literals from progress.position to the end of the
+//sequence, spilling lists as memory grows past spillAt. False if a budget
+//ran out first
+bool LogicSim::learningPass(const std::vector<uint32_t> &sequence, LearningProgress &progress, size_t &spillAt)
 {
-    int i;
-
-    numlevels = numLevels;
-    levelLen = new int[numLevels];
-    levelEvents = new int * [numLevels];
-    for (i=0; i < numLevels; i++)
-    {
-	levelEvents[i] = new int[levelSize];
-	levelLen[i] = 0;
-    }
-    activation = new int[levelSize];
-    
-    actFFList = new int[numff + 1];
-}
+	std::vector<uint32_t> changedLists;
 
-////////////////////////////////////////////////////////////////////////
-int LogicSim::retrieveEvent()
+	//for each literal, perform simulations until done
+	for (; progress.position < sequence.size() && !stopRequested; progress.position++)
+	{
+		size_t i = progress.position;
+		reportProgress(progress, sequence.size());
+		if (budgetReached())
+		{
+			return false;
+		}
+		uint32_t literal = literalIndex(sequence[i]);
+		if (!progress.stale[literal])
+		{
+			continue;
+		}
+		//an equivalent literal was learned already, its closure is this one's
+		if (learning.prune && progress.pass == 1 && equivalentToLearned(sequence[i], progress.learnedAt))
+		{
+			numPrunedLiterals++;
+			continue;
+		}
+		learnLiteral(sequence[i], progress, changedLists);
+		if (spill != NULL && listMemory.current() > spillAt)
+		{
+			spillColdLists(progress);
+			spillAt = max(learning.listMemoryBytes, listMemory.current() + learning.listMemoryBytes / 4);
+		}
+	}
+	return true;
+}
+
+//clause propagation and simulation of one literal, recording which lists
+//it changed in progress
+void LogicSim::learnLiteral(uint32_t imp, LearningProgress &progress, std::vector<uint32_t> &changedLists)
 {
-    while ((levelLen[currLevel] == 0) && (currLevel < maxlevels))
-	currLevel++;
-
-    if (currLevel < maxlevels)
-    {
-    	levelLen[currLevel]--;
-        return(levelEvents[currLevel][levelLen[currLevel]]);
-    }
-    else
-	return(-1);
+	progress.step++;
+	progress.learnedAt[literalIndex(imp)] = progress.step;
+	changedLists.clear();
+	int fixedBefore = fixedNodeCounter;
+	bool simulate = true;
+	if (gateClauses != NULL)
+	{
+		clauseImplications(imp, *gateClauses, &changedLists, simulate);
+	}
+	if (simulate)
+	{
+		indirectImplicationSim(imp, ctx, &changedLists, randomSignatures);
+		//where the signatures rarely rule anything out, checking them only costs time
+		if (randomSignatures != NULL && ++signatureChecks == SIGNATURE_TRIAL && numSignatureSkips * 100 < signatureChecks)
+		{
+			if (verboseLearning)
+				cout << "Random pattern signatures ruled out " << numSignatureSkips << " of " << signatureChecks
+					<< " simulations, no longer checking them\n";
+			delete randomSignatures;
+			randomSignatures = NULL;
+		}
+	}
+	else
+	{
+		numClauseLiterals++;
+	}
+	//the gate can only take the other value from now on
+	if (learning.sweep && fixedNodeCounter > fixedBefore)
+	{
+		propagateConstant(imp ^ VALUE);
+	}
+	for (size_t j = 0; j < changedLists.size(); j++)
+	{
+		progress.changedAt[changedLists[j]] = progress.step;
+		progress.changed = true;
+	}
 }
 
-// Gate Evaluation functions. Each returns the gate output (1, 0, or X id)
-unsigned int LogicSim::evalAND(int gateN)
+/*
+Lists whose literal changed longest ago are the least likely to gain edges
+again, so they go first. Each keeps only its identity literal in memory (any
+one literal, if it has no identity) so it still reads as not fixed, and the
+rest goes to a new run until the tracked implication memory is under three
+quarters of the ceiling.
+*/
+void LogicSim::spillColdLists(const LearningProgress &progress)
 {
-	//read fanin values into the gatevalues vector
-	int i, j;
-	bool allEqual = true;
-	uint32_t val = GateValues[inlist[gateN][0]];
+	std::vector<uint32_t> candidates;
+	std::vector<SpilledList> lists;
+	size_t target = learning.listMemoryBytes / 4 * 3;
 
-	evalValues.clear();
-	for (i = 0; i < fanin[gateN]; i++)
+	for (uint32_t literal = 2; literal < 2 * (uint32_t) numgates; literal++)
 	{
-		evalValues.push_back(GateValues[inlist[gateN][i]]);
-		//check for controlling value (0)
-		if (GateValues[inlist[gateN][i]] == 0)
+		uint32_t imp = literalFromIndex(literal);
+		if (((imp & VALUE) ? oneList[imp & GATE] : zeroList[imp & GATE]).size() > 1)
 		{
-			return 0;
+			candidates.push_back(literal);
 		}
-		//check for same x inputs on all
-		if (val != GateValues[inlist[gateN][i]])
+	}
+	std::stable_sort(candidates.begin(), candidates.end(), [&progress](uint32_t a, uint32_t b) {
+		return progress.changedAt[a] < progress.changedAt[b];
+	});
+	for (size_t k = 0; k < candidates.size() && listMemory.current() > target; k++)
+	{
+		uint32_t imp = literalFromIndex(candidates[k]);
+		StoredImplicationList &list = (imp & VALUE) ? oneList[imp & GATE] : zeroList[imp & GATE];
+		uint32_t keep = list.count(imp) != 0 ? imp : *list.begin();
+		lists.push_back(SpilledList(candidates[k], std::vector<uint32_t>()));
+		for (auto it = list.begin(); it != list.end(); ++it)
 		{
-			allEqual = false;
+			if (*it != keep)
+			{
+				lists.back().second.push_back(literalIndex(*it));
+			}
 		}
-		val = GateValues[inlist[gateN][i]];
+		StoredImplicationList resident(list.get_allocator());
+		resident.insert(keep);
+		list.swap(resident);
 	}
-	//if same input on all return that
-	if (allEqual)
+	if (lists.empty())
 	{
-		return val;
+		return;
 	}
-	//different X input (complements squash to 0)
-	for (i = 0; i < evalValues.size(); i++)
+	if (!spill->writeRun(lists))
 	{
-		if (evalValues[i] & 0x1) //if odd
+		cerr << "ERROR: Could not write spilled implication lists to " << learning.spillDirectory << endl;
+		exit(-1);
+	}
+	if (verboseLearning)
+		cout << "Spilled " << lists.size() << " implication lists, " << spill->numRuns() << " runs after "
+			<< spill->numCompactions << " merges (" << spill->spilledBytes / (1024 * 1024) << " MB on disk)\n";
+}
+
+//the resident and spilled lists are merged into a binary export, and every
+//later read goes through the database's page cache
+void LogicSim::finishSpill()
+{
+	std::string path = learning.spillDirectory + "/" + SPILL_DATABASE;
+	ImplicationExporter exporter(this, 1);
+	if (!exporter.exportLists(path, ExportBinary, false))
+	{
+		cerr << "ERROR: Could not write the implication database " << path << endl;
+		exit(-1);
+	}
+	if (verboseLearning)
+		cout << "Merged " << spill->spilledLists << " spilled lists from " << spill->numRuns() << " runs into " << path << "\n";
+	delete spill;
+	spill = NULL;
+	for (int i = 0; i < numgates; i++)
+	{
+		StoredImplicationList(zeroList[i].get_allocator()).swap(zeroList[i]);
+		StoredImplicationList(oneList[i].get_allocator()).swap(oneList[i]);
+	}
+	delete database;
+	database = new ImplicationReader();
+	if (!database->open(path))
+	{
+		cerr << "ERROR: Could not open the implication database " << path << endl;
+		exit(-1);
+	}
+	database->setPageCache(learning.listMemoryBytes / 2);
+}
+
+//memory is what this circuit holds, other circuits loaded in the same
+//process do not count against it. Time runs from the start of direct learning
+bool LogicSim::budgetReached()
+{
+	if (learning.timeBudgetMs > 0 && chrono::steady_clock::now() - startDirect >= chrono::milliseconds(learning.timeBudgetMs))
+	{
+		coverage.stopReason = "time budget";
+		return true;
+	}
+	if (learning.memoryBudgetBytes > 0 && trackedMemory() >= learning.memoryBudgetBytes)
+	{
+		coverage.stopReason = "memory budget";
+		return true;
+	}
+	return false;
+}
+
+/*
+Literals of a gate inside a fanout-free region reach the rest of the circuit
+only through the region's stem, so they are left to composition: their
+direct implications, plus the contrapositives of what the stems learn about
+them. Stems and the gates where a stem's branches reconverge are simulated.
+*/
+void LogicSim::pruneSequence(std::vector<uint32_t> &literals)
+{
+	FanoutRegions regions(netlist);
+	size_t kept = 0;
+	for (size_t i = 0; i < literals.size(); i++)
+	{
+		int gate = literals[i] & GATE;
+		if (regions.isStem(gate) || regions.isReconvergence(gate))
+		{
+			literals[kept++] = literals[i];
+		}
+	}
+	numPrunedLiterals += literals.size() - kept;
+	literals.resize(kept);
+	if (verboseLearning)
+		cout << "Learning " << kept << " literals of " << regions.numStems << " stems and " << regions.numReconvergence
+			<< " reconvergence points\n";
+}
+
+//true if imp implies a literal which was learned already and whose closure
+//implies imp in turn, so that the two closures are the same
+bool LogicSim::equivalentToLearned(uint32_t imp, const std::vector<int> &learnedAt) const
+{
+	ImplicationList closure;
+	const StoredImplicationList &direct = getDirectList(imp);
+	for (auto it = direct.begin(); it != direct.end(); ++it)
+	{
+		if (*it != imp && learnedAt[literalIndex(*it)] > 0 && buildImplicationList(*it, closure) && closure.count(imp) != 0)
 		{
-			for (j = 0; j < evalValues.size(); j++)
+			return true;
+		}
+	}
+	return false;
+}
+
+//every gate's two literals, in the order given by the learning options
+void LogicSim::learningSequence(std::vector<uint32_t> &literals) const
+{
+	std::vector<int> gates;
+	literals.clear();
+	for (int i = 1; i < numgates; i++)
+	{
+		gates.push_back(i);
+	}
+	switch (learning.order)
+	{
+	case OrderLevel:
+		std::stable_sort(gates.begin(), gates.end(), [this](int a, int b) { return netlist->levelNum[a] < netlist->levelNum[b]; });
+		break;
+	case OrderReverseTopo:
+		std::stable_sort(gates.begin(), gates.end(), [this](int a, int b) { return netlist->levelNum[a] > netlist->levelNum[b]; });
+		break;
+	case OrderFanoutCone:
+	{
+		//preorder walk of the fanout cones, starting from the lowest level gates
+		std::vector<char> visited(numgates, 0);
+		std::vector<int> stack;
+		std::vector<int> roots = gates;
+		std::stable_sort(roots.begin(), roots.end(), [this](int a, int b) { return netlist->levelNum[a] < netlist->levelNum[b]; });
+		gates.clear();
+		for (size_t r = 0; r < roots.size(); r++)
+		{
+			if (visited[roots[r]])
 			{
-				if (evalValues[j] == (evalValues[i] - 1))
+				continue;
+			}
+			visited[roots[r]] = 1;
+			stack.push_back(roots[r]);
+			while (!stack.empty())
+			{
+				int gate = stack.back();
+				stack.pop_back();
+				gates.push_back(gate);
+				for (int i = netlist->fanout[gate] - 1; i >= 0; i--)
 				{
-					return 0;
+					int successor = netlist->fnlist[gate][i];
+					if (!visited[successor])
+					{
+						visited[successor] = 1;
+						stack.push_back(successor);
+					}
 				}
 			}
 		}
-		else //if even
+		break;
+	}
+	case OrderPriority:
+	{
+		//fanout cone size estimated by summing over successors, highest level
+		//first. Reconvergence is counted more than once, which only overstates
+		//gates whose cones reconverge a lot
+		std::vector<double> cone(numgates, 0);
+		std::vector<int> byLevel = gates;
+		std::stable_sort(byLevel.begin(), byLevel.end(), [this](int a, int b) { return netlist->levelNum[a] > netlist->levelNum[b]; });
+		for (size_t k = 0; k < byLevel.size(); k++)
 		{
-			for (j = 0; j < evalValues.size(); j++)
+			int gate = byLevel[k];
+			for (int i = 0; i < netlist->fanout[gate]; i++)
 			{
-				if (evalValues[j] == (evalValues[i] + 1))
-				{
-					return 0;
-				}
+				cone[gate] = std::min(cone[gate] + 1 + cone[netlist->fnlist[gate][i]], 1e300);
 			}
 		}
+		std::stable_sort(gates.begin(), gates.end(), [this, &cone](int a, int b)
+		{
+			return cone[a] != cone[b] ? cone[a] > cone[b] : netlist->fanout[a] > netlist->fanout[b];
+		});
+		break;
+	}
+	default:
+		break;
+	}
+	for (size_t i = 0; i < gates.size(); i++)
+	{
+		literals.push_back(gates[i]);
+		literals.push_back(gates[i] | VALUE);
 	}
-	//else return a new X value
-	val = x_number;
-	x_number = x_number + 2;
-	return val;
 }
 
-unsigned int LogicSim::evalNAND(int gateN)
+/*
+A literal's closure grew if some list reachable from it changed after the
+literal was last learned. Walking the reverse implication edges from each
+changed literal, newest change first, gives every literal the time of the
+latest change it can reach on the first visit, so each literal is visited once.
+*/
+void LogicSim::findStaleLiterals(const std::vector<int> &learnedAt, const std::vector<int> &changedAt, std::vector<char> &stale) const
 {
-	unsigned int ANDVal = evalAND(gateN);
-	if (ANDVal == 1)
+	uint32_t numLiterals = 2 * numgates;
+	std::vector<uint32_t> start(numLiterals + 1, 0);
+	std::vector<uint32_t> predecessors;
+	std::vector<uint32_t> sources;
+	std::vector<int> latest(numLiterals, 0);
+	std::vector<uint32_t> stack;
+
+	//reverse edges in compressed rows, target literal -> literals implying it
+	for (uint32_t p = 2; p < numLiterals; p++)
 	{
-		return 0;
+		const StoredImplicationList &list = getDirectList(literalFromIndex(p));
+		for (auto it = list.begin(); it != list.end(); ++it)
+		{
+			start[literalIndex(*it) + 1]++;
+		}
 	}
-	else if (ANDVal == 0)
+	for (uint32_t i = 0; i < numLiterals; i++)
 	{
-		return 1;
+		start[i + 1] += start[i];
 	}
-	else if (ANDVal & 0x1) //odd number X
+	predecessors.resize(start[numLiterals]);
+	std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+	for (uint32_t p = 2; p < numLiterals; p++)
 	{
-		return ANDVal - 1;
+		const StoredImplicationList &list = getDirectList(literalFromIndex(p));
+		for (auto it = list.begin(); it != list.end(); ++it)
+		{
+			predecessors[fill[literalIndex(*it)]++] = p;
+		}
 	}
-	else
+
+	for (uint32_t i = 2; i < numLiterals; i++)
 	{
-		//even number X
-		return ANDVal + 1;
+		if (changedAt[i] > 0)
+		{
+			sources.push_back(i);
+		}
 	}
-}
-
-unsigned int LogicSim::evalOR(int gateN)
-{
-	//read fanin values into the gatevalues vector
-	int i, j;
-	bool allEqual = true;
-	uint32_t val = GateValues[inlist[gateN][0]];
-
-	evalValues.clear();
-	for (i = 0; i < fanin[gateN]; i++)
+	std::sort(sources.begin(), sources.end(), [&changedAt](uint32_t a, uint32_t b) { return changedAt[a] > changedAt[b]; });
+	for (size_t s = 0; s < sources.size(); s++)
 	{
-		evalValues.push_back(GateValues[inlist[gateN][i]]);
-		//check for controlling value (1)
-		if (GateValues[inlist[gateN][i]] == 1)
+		if (latest[sources[s]] != 0)
 		{
-			return 1;
+			continue;
 		}
-		//check for same x inputs on all
-		if (val != GateValues[inlist[gateN][i]])
+		latest[sources[s]] = changedAt[sources[s]];
+		stack.push_back(sources[s]);
+		while (!stack.empty())
 		{
-			allEqual = false;
+			uint32_t literal = stack.back();
+			stack.pop_back();
+			for (uint32_t i = start[literal]; i < start[literal + 1]; i++)
+			{
+				if (latest[predecessors[i]] == 0)
+				{
+					latest[predecessors[i]] = changedAt[sources[s]];
+					stack.push_back(predecessors[i]);
+				}
+			}
 		}
-		val = inlist[gateN][i];
 	}
-	//if same input on all return that
-	if (allEqual)
+	for (uint32_t i = 0; i < numLiterals; i++)
+	{
+		stale[i] = latest[i] > learnedAt[i];
+	}
+}
+
+bool LogicSim::parseLearningOrder(const std::string &name, LearningOrder &order)
+{
+	if (name == "gate")
+		order = OrderGate;
+	else if (name == "level")
+		order = OrderLevel;
+	else if (name == "reverse")
+		order = OrderReverseTopo;
+	else if (name == "cone")
+		order = OrderFanoutCone;
+	else if (name == "priority")
+		order = OrderPriority;
+	else
+		return false;
+	return true;
+}
+
+const char * LogicSim::learningOrderName(LearningOrder order)
+{
+	switch (order)
 	{
-		return val;
+	case OrderLevel:
+		return "level";
+	case OrderReverseTopo:
+		return "reverse";
+	case OrderFanoutCone:
+		return "cone";
+	case OrderPriority:
+		return "priority";
+	default:
+		return "gate";
 	}
-	//different X input (complements squash to 0)
-	for (i = 0; i < evalValues.size(); i++)
+}
+
+bool LogicSim::indirectImplicationSim(uint32_t imp, SimContext *context, std::vector<uint32_t> *changedLists, const RandomSignatures *signatures)
+{
+	bool done = false;
+	bool listChanged = false;
+	bool simulated = false;
+	int simulations = 0;
+	size_t index;
+	int gateN;
+	int successor;
+	int sucLevel;
+	ImplicationList currentList;
+	while (!done)
 	{
-		if (evalValues[i] & 0x1) //if odd
+		//if there was a bad implication value (conflicting) clear the list for the current imp
+		if (!buildImplicationList(imp, currentList))
+		{
+			fixLiteral(imp, changedLists);
+			return true;
+		}
+		//whatever a simulation could find holds in the random patterns, and is in the closure already
+		if (signatures != NULL && simulations == 0 && signatures->covered(imp, currentList))
+		{
+			numSignatureSkips++;
+			break;
+		}
+		//the last simulation already holds every value in the closure, so
+		//simulating the closure again can not find anything new
+		if (simulated)
 		{
-			for (j = 0; j < evalValues.size(); j++)
+			done = true;
+			for (auto it = currentList.begin(); it != currentList.end() && done; ++it)
+			{
+				unsigned int value = ternary != NULL ? ternary->value(*it & GATE) : context->GateValues[*it & GATE];
+				done = value == (*it & VALUE) >> 31;
+			}
+			if (done)
 			{
-				if (evalValues[j] == (evalValues[i] - 1))
+				break;
+			}
+		}
+		//the edges found so far are sound, the literal just learns no more
+		if (learning.iterationCap > 0 && simulations >= learning.iterationCap)
+		{
+			coverage.capped++;
+			break;
+		}
+		simulations++;
+		numSimulations++;
+		if (ternary != NULL)
+		{
+			//the same simulation with plain 0/1/X values
+			ternary->reset();
+			for (auto it = currentList.begin(); it != currentList.end(); ++it)
+			{
+				ternary->assign(*it & GATE, (*it & VALUE) >> 31);
+			}
+			ternary->simulate();
+		}
+		else
+		{
+			//reset the circuit to its default state (simulated with all X inputs)
+			resetCircuit(context);
+			//for the given node, add all implications successors to the event wheel
+			for (auto it = currentList.begin(); it != currentList.end(); ++it)
+			{
+				gateN = *it & GATE;
+				context->GateValues[gateN] = (*it & VALUE) >> 31;
+				for (int i = 0; i < netlist->fanout[gateN]; i++)
 				{
-					return 1;
+					successor = netlist->fnlist[gateN][i];
+					sucLevel = netlist->levelNum[successor];
+					if (context->sched[successor] == 0)
+					{
+						context->insertEvent(sucLevel, successor);
+						context->sched[successor] = 1;
+					}
 				}
 			}
+			//run simulation
+			context->goodsim(false);
 		}
-		else //if even
+		simulated = true;
+		const std::vector<uint32_t> &changes = ternary != NULL ? ternary->changes : context->changes;
+		if (changes.size() > 0)
 		{
-			for (j = 0; j < evalValues.size(); j++)
+			numIndirectImplications = numIndirectImplications + changes.size();
+			done = false;
+			//add the changes found from simulation, with their contrapositives
+			for (index = 0; index < changes.size(); index++)
 			{
-				if (evalValues[j] == (evalValues[i] + 1))
+				if (addImplication(imp, changes[index], changedLists))
 				{
-					return 1;
+					listChanged = true;
 				}
 			}
 		}
+		else
+		{
+			//done with this node if no new implications are found
+			done = true;
+		}
+	}
+	return listChanged;
+}
+
+/*
+Unit propagation from the closure of imp finds what a simulation of it
+finds, and also what the simulation only reaches through contrapositives,
+such as an AND at 0 whose other inputs are 1 implying its last input is 0.
+It repeats until the closure stops growing. Where two unknowns from the
+same source meet a simulation can still find more, as X identities cancel
+there, so simulate stays set only for literals whose changes reach such a
+gate.
+*/
+bool LogicSim::clauseImplications(uint32_t imp, GateClauses &clauses, std::vector<uint32_t> *changedLists, bool &simulate)
+{
+	ImplicationList currentList;
+	std::vector<uint32_t> implied;
+	bool listChanged = false;
+	bool grown = true;
+
+	simulate = true;
+	while (grown)
+	{
+		//a conflict already in the closure is left to the simulation
+		if (!buildImplicationList(imp, currentList))
+		{
+			return listChanged;
+		}
+		if (!clauses.propagate(currentList, implied))
+		{
+			fixLiteral(imp, changedLists);
+			simulate = false;
+			return true;
+		}
+		grown = false;
+		for (size_t index = 0; index < implied.size(); index++)
+		{
+			if (currentList.count(implied[index]) == 0 && addImplication(imp, implied[index], changedLists))
+			{
+				numClauseImplications++;
+				listChanged = grown = true;
+			}
+		}
 	}
-	//else return a new X value
-	val = x_number;
-	x_number = x_number + 2;
-	return val;
+	simulate = clauses.reachesReconvergence();
+	return listChanged;
 }
 
-unsigned int LogicSim::evalNOR(int gateN)
+//a fixed node, the empty list marks the value as one the gate never takes
+void LogicSim::fixLiteral(uint32_t imp, std::vector<uint32_t> *changedLists)
 {
-	unsigned int ORVal = evalOR(gateN);
-	if (ORVal == 1)
+	fixedNodeCounter++;
+	std::lock_guard<std::mutex> guard(listLocks[literalIndex(imp) % LIST_LOCK_STRIPES]);
+	if (imp & VALUE)
 	{
-		return 0;
+		oneList[imp & GATE].clear();
 	}
-	else if (ORVal == 0)
+	else
 	{
-		return 1;
+		zeroList[imp & GATE].clear();
 	}
-	else if (ORVal & 0x1) //odd number X
+	if (changedLists != NULL)
 	{
-		return ORVal - 1;
+		changedLists->push_back(literalIndex(imp));
 	}
-	else
+}
+
+//if a -> b then ~b -> ~a. Both edges go through the striped locks, so
+//learning threads may add edges to the same lists concurrently
+bool LogicSim::addImplication(uint32_t from, uint32_t to, std::vector<uint32_t> *changedLists)
+{
+	bool added = insertEdge(from, to, changedLists);
+	if (insertEdge(to ^ VALUE, from ^ VALUE, changedLists))
 	{
-		//even number X
-		return ORVal + 1;
+		added = true;
 	}
+	return added;
 }
 
-unsigned int LogicSim::evalXOR(int gateN)
+bool LogicSim::insertEdge(uint32_t from, uint32_t to, std::vector<uint32_t> *changedLists)
 {
-	unsigned int val1, val2;
-	//get gate inputs
-	if (fanin[gateN] > 1)
+	uint32_t literal = literalIndex(from);
+	std::lock_guard<std::mutex> guard(listLocks[literal % LIST_LOCK_STRIPES]);
+	StoredImplicationList &list = (from & VALUE) ? oneList[from & GATE] : zeroList[from & GATE];
+	//an empty list belongs to a fixed node, which can never take this value
+	if (list.empty() || list.count(to) != 0)
 	{
-		//2 input
-		val1 = GateValues[inlist[gateN][0]];
-		val2 = GateValues[inlist[gateN][1]];
+		return false;
 	}
-	else
+	//the resident list holds the edges gained since the literal was spilled,
+	//the rest is only read back if the edge may be among them
+	if (spill != NULL && spill->spilled(literal) && spill->mayHold(literal, literalIndex(to)))
 	{
-		//1 input
-		val1 = GateValues[inlist[gateN][0]];
-		val2 = val1;
+		std::vector<uint32_t> spilled;
+		if (spill->readSpilled(literal, spilled) && std::find(spilled.begin(), spilled.end(), literalIndex(to)) != spilled.end())
+		{
+			return false;
+		}
 	}
-	//check for non-x values (1 or 0)
-	if (val1 < 2 && val2 < 2)
+	list.insert(to);
+	if (changedLists != NULL)
 	{
-		return (val1 ^ val2);
+		changedLists->push_back(literal);
 	}
-	//check for same x input
-	if (val1 == val2)
+	return true;
+}
+
+//restores circuit values to defaults, when all inputs are X
+void LogicSim::resetCircuit(SimContext *context)
+{
+	context->restoreValues(OrigGateValues, x_number_reset);
+}
+
+//performs initial simulation with all X inputs. These "default" values 
+//are used to check for implications during the indirect implication stage
+void LogicSim::initialSim()
+{
+	char * vec = new char[numpri];
+	for (int i = 0; i < numpri; i++)
 	{
-		//cout << "Xs on inputs of gate " << gateN << " squashed!" << endl;
-		return 0;
+		vec[i] = 'x';
 	}
-	//different X inputs
-	if (((val1 & 0x1) && val2 == (val1 - 1)) || ((val2 & 0x1) && val1 == (val2 - 1)))
+	applyVector(vec);
+	goodsim(false);
+	for (int i = 0; i < numgates; i++)
 	{
-		//cout << "Xs on inputs of gate " << gateN << " squashed!" << endl;
-		return 1;
+		OrigGateValues[i] = ctx->GateValues[i];
 	}
-	//else return a new X value
-	val1 = x_number;
-	x_number = x_number + 2;
-	return val1;
+	x_number_reset = ctx->x_number;
+	delete[] vec;
 }
 
-unsigned int LogicSim::evalXNOR(int gateN)
+void LogicSim::printGateInfo(int gateNumber)
 {
-	unsigned int XORVal = evalXOR(gateN);
-	if (XORVal == 1)
+	if (gateNumber > numgates)
 	{
-		return 0;
+		cout << "ERROR: Invalid gate number" << endl;
+		return;
 	}
-	else if (XORVal == 0)
+	cout << "Gate Type: ";
+	switch (netlist->gtype[gateNumber])
 	{
-		return 1;
+	case T_and:
+		cout << "AND" << endl;
+		break;
+	case T_nand:
+		cout << "NAND" << endl;
+		break;
+	case T_or:
+		cout << "OR" << endl;
+		break;
+	case T_nor:
+		cout << "NOR" << endl;
+		break;
+	case T_xor:
+		cout << "XOR" << endl;
+		break;
+	case T_xnor:
+		cout << "XNOR" << endl;
+		break;
+	case T_not:
+		cout << "Inverter" << endl;
+		break;
+	case T_buf:
+		cout << "Buffer" << endl;
+		break;
+	case T_dff:
+		cout << "D Flip Flop" << endl;
+		break;
+	case T_output:
+		cout << "Primary Output" << endl;
+		break;
+	case T_input:
+		cout << "Primary Input" << endl;
+		break;
+	default:
+		cout << "ERROR: Invalid Gate Type" << endl;
+		return;
+		break;
 	}
-	else if (XORVal & 0x1) //odd number X
+	cout << "Direct Fan-In:";
+	for (int i = 0; i < netlist->fanin[gateNumber]; i++)
 	{
-		return XORVal - 1;
+		cout << " " << netlist->inlist[gateNumber][i];
 	}
-	else
+	cout << endl << "Direct Fan-Out:";
+	for (int i = 0; i < netlist->fanout[gateNumber]; i++)
 	{
-		//even number X
-		return XORVal + 1;
+		cout << " " << netlist->fnlist[gateNumber][i];
 	}
+	cout << endl;
 }
 
-////////////////////////////////////////////////////////////////////////
-// goodsim() -
-//	Logic simulate. (no faults inserted)
-////////////////////////////////////////////////////////////////////////
-void LogicSim::goodsim(bool verbose)
+void LogicSim::printCircuitInfo()
 {
-    int sucLevel;
-    int gateN, predecessor, successor;
-    int i;
-	unsigned int newVal;
-	numSimulations++;
-
-    currLevel = 0;
-    actLen = actFFLen = 0;
-    while (currLevel < maxlevels)
-    {
-    	gateN = retrieveEvent();
-		if (gateN != -1)// if a valid event
-		{
-			sched[gateN]= 0;
-    		switch (gtype[gateN])
-    		{
-			case T_and:
-				newVal = evalAND(gateN);
-	    		break;
-			case T_nand:
-				newVal = evalNAND(gateN);
-	    		break;
-			case T_or:
-				newVal = evalOR(gateN);
-	    		break;
-			case T_nor:
-				newVal = evalNOR(gateN);
-	    		break;
-			case T_xor:
-				newVal = evalXOR(gateN);
-				break;
-			case T_xnor:
-				newVal = evalXNOR(gateN);
-				break;
-			case T_not:
-				newVal = GateValues[inlist[gateN][0]];
-				if (newVal == 0)
-				{
-					newVal = 1;
-				}
-				else if (newVal == 1)
-				{
-					newVal = 0;
-				}
-				else if (newVal & 0x1) //odd X
-				{
-					newVal = newVal - 1;
-				}
-				else //even X
-				{
-					newVal = newVal + 1;
-				}
-	    		break;
-			case T_buf:
-	    		predecessor = inlist[gateN][0];
-				newVal = GateValues[predecessor];
-				break;
-			case T_dff:
-	    		predecessor = inlist[gateN][0];
-				newVal = GateValues[predecessor];
-				actFFList[actFFLen] = gateN;
-				actFFLen++;
-	    		break;
-			case T_output:
-				predecessor = inlist[gateN][0];
-				newVal = GateValues[predecessor];
-				break;
-			case T_input:
-			case T_tie0:
-			case T_tie1:
-			case T_tieX:
-			case T_tieZ:
-	    		newVal = GateValues[gateN];
-	    		break;
-			  default:
-			cerr << "illegal gate type1 " << gateN << " " << gtype[gateN] << "\n";
-			exit(-1);
-    		}	// switch
-
-			// if gate value changed
-    		if (newVal != GateValues[gateN])
-			{
-				//if value changed to 1 or 0 add to changes list for implications
-				if (newVal == 0)
-				{
-					changes.emplace_back(gateN);
-				}
-				else if (newVal == 1)
-				{
-					changes.emplace_back(gateN | VALUE);
-				}
-
-				GateValues[gateN] = newVal;
-
-				for (i=0; i<fanout[gateN]; i++)
-				{
-					successor = fnlist[gateN][i];
-					sucLevel = levelNum[successor];
-					if (sched[successor] == 0)
-					{
-					  if (sucLevel != 0)
-					insertEvent(sucLevel, successor);
-					  else	// same level, wrap around for next time
-					  {
-					activation[actLen] = successor;
-					actLen++;
-					  }
-					  sched[successor] = 1;
-					}
-				}	// for (i...)
-
-		}	// if (newVal..)
-
-		}	// if (gateN...)
-    }	// while (currLevel...)
-    // now re-insert the activation list for the FF's
-    for (i=0; i < actLen; i++)
-    {
-	insertEvent(0, activation[i]);
-	sched[activation[i]] = 0;
-
-        predecessor = inlist[activation[i]][0];
-        gateN = ffMap[activation[i]];
-        if (GateValues[predecessor] == 1)
-            goodState[gateN] = '1';
-        else if (GateValues[predecessor] == 0)
-            goodState[gateN] = '0';
-        else
-            goodState[gateN] = 'X';
-    }
-	if (verbose)
-	{
-		//Print the PO outputs
-		cout << "output: ";
-		for (i = 0; i < numout; i++)
-		{
-			if (GateValues[outputs[i]] == 1)
-				cout << "1";
-			else if (GateValues[outputs[i]] == 0)
-				cout << "0";
-			else
-				cout << "X";
-		}
-		cout << endl;
+	cout << "\t" << numpri << " PIs.\n";
+	cout << "\t" << netlist->numout << " POs.\n";
+	cout << "\t" << numff << " Dffs.\n";
+	cout << "\t" << netlist->numFaultFreeGates << " total number of gates.\n";
+	cout << "\t" << netlist->maxlevels / 5 << " levels in the circuit.\n";
+	if (reduced != NULL)
+	{
+		cout << "\t" << sweepReport.reducedGates << " gates after sweeping (" << sweepReport.constants << " constant, "
+			<< sweepReport.merged << " merged, " << sweepReport.dead << " dead).\n";
+	}
+	if (numPrunedLiterals > 0)
+	{
+		cout << "\t" << numPrunedLiterals << " literals learned by composition instead of simulation.\n";
+	}
+	if (numClauseLiterals > 0 || numClauseImplications > 0)
+	{
+		cout << "\t" << numClauseImplications << " implications found by clause propagation, " << numClauseLiterals
+			<< " literals learned without simulation.\n";
+	}
+	if (learning.ternary)
+	{
+		cout << "\t" << "Learned with plain 0/1/X simulation.\n";
+	}
+	if (numSignatureSkips > 0)
+	{
+		cout << "\t" << numSignatureSkips << " literals not simulated, ruled out by random pattern signatures.\n";
+	}
+	if (database != NULL)
+	{
+		const PageCache *cache = database->pageCache();
+		cout << "\t" << "Implication lists read from " << databasePath() << " (" << cache->capacity / 1024
+			<< " KB page cache, " << cache->hits << " hits, " << cache->misses << " misses).\n";
 	}
 }
-
-////////////////////////////////////////////////////////////////////////
-// observeOutputs()
-//	This function prints the outputs of the fault-free circuit.
-////////////////////////////////////////////////////////////////////////
-void LogicSim::observeOutputs()
-{
-    int i;
-
-    cout << "\t";
-    for (i=0; i<numout; i++)
-    {
-	if (GateValues[outputs[i]] == 1)
-	    cout << "1";
-	else if (GateValues[outputs[i]] == 0)
-	    cout << "0";
-	else
-	    cout << "X";
-    }
-
-    cout << "\n";
-    for (i=0; i<numff; i++)
-    {
-	if (GateValues[ff_list[i]] == 1)
-	    cout << "1";
-	else if (GateValues[ff_list[i]] == 0)
-	    cout << "0";
-	else
-	    cout << "X";
-    }
-    cout << "\n";
-}
-
@@ -11,138 +11,118 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <ctime>
+#include <atomic>
+#include <chrono>
 #include <map>
+#include <mutex>
 #include <vector>
 
 //user defined includes
 #include "implication_structure.h"
+#include "netlist.h"
+#include "netlist_sweep.h"
+#include "sim_context.h"
 
-#define GATE 0x7FFFFFFF
-#define VALUE 0x80000000
-
-#define HZ 100
-#define RETURN '\n'
-#define EOS '\0'
-#define COMMA ','
-#define SPACE ' '
-#define TAB '\t'
-#define COLON ':'
-#define SEMICOLON ';'
-
-#define SPLITMERGE 'M'
-
-#define T_INPUT 1
-#define T_OUTPUT 2
-#define T_SIGNAL 3
-#define T_MODULE 4
-#define T_COMPONENT 5
-#define T_EXIST 9
-#define T_COMMENT 10
-#define T_END 11
-
-#define TABLESIZE 5000
-#define MAXIO 5000
-#define MAXMODULES 5000
-#define MAXDFF 10560
-
-#define GOOD 1
-#define FAULTY 2
-#define DONTCARE -1
-#define ALLONES 0xffffffff
-
-#define MAXlevels 10000
-#define MAXIOS 5120
-#define MAXFanout 10192
-#define MAXFFS 40048
-#define MAXGATES 100000
-#define MAXevents 100000
-
-#define TRUE 1
-#define FALSE 0
-
-#define EXCITED_1_LEVEL 1
-#define POTENTIAL 2
-#define LOW_DETECT 3
-#define HIGH_DETECT 4
-#define REDUNDANT 5
-
-enum
+class GateClauses;
+class ImplicationReader;
+class ListSpill;
+class RandomSignatures;
+class TernarySim;
+
+//summary of an incremental update after a netlist edit
+struct EcoReport
+{
+	int changedGates;		// gates added, retyped or rewired
+	int affectedGates;		// changed gates plus their fanin and fanout cones
+	int keptLiterals;		// literals whose baseline lists were reused
+	int relearnedLiterals;	// literals learned again by simulation
+};
+
+//order in which literals are learned by logic simulation
+enum LearningOrder
+{
+	OrderGate,			// gate number order
+	OrderLevel,			// ascending level, inputs first
+	OrderReverseTopo,	// descending level, outputs first
+	OrderFanoutCone,	// depth first through fanouts, so each cone is learned together
+	OrderPriority		// largest estimated fanout cone first, for budgeted runs
+};
+
+//default time between learning checkpoints, and between progress reports
+#define CHECKPOINT_SECONDS 300
+#define PROGRESS_SECONDS 10
+
+//every option defaults to plain single pass learning in gate order
+struct LearningOptions
+{
+	LearningOrder order = OrderGate;
+	bool fixedPoint = false;	// repeat until no closure gains an edge, instead of a single pass
+	bool sweep = false;		// learn on a reduced netlist, and propagate constants found while learning
+	bool prune = false;		// simulate only literals of fanout stems and reconvergence points
+	bool clauses = false;	// propagate gate clauses first, simulating only where X values can reconverge
+	std::string checkpointPath;	// learning progress is saved here when set
+	int checkpointSeconds = CHECKPOINT_SECONDS;	// time between checkpoints
+	bool resume = false;		// continue from the checkpoint, if there is one
+	//budgets, 0 for none. Learning stops cleanly at the first literal after
+	//the time or this circuit's tracked memory is used up, and a literal
+	//stops simulating after iterationCap simulations. The lists learned so
+	//far stay sound
+	int timeBudgetMs = 0;
+	size_t memoryBudgetBytes = 0;
+	int iterationCap = 0;
+	//when set, lists over listMemoryBytes of this circuit's implication memory are
+	//spilled to run files in spillDirectory while learning, and afterwards
+	//read from a database there through a page cache
+	std::string spillDirectory;
+	size_t listMemoryBytes = 0;
+	//learn only every numShards-th literal of the sequence, starting at
+	//shardIndex, so that shards can run as separate processes and be merged
+	//afterwards. numShards of 0 or 1 learns every literal
+	int shardIndex = 0;
+	int numShards = 0;
+	//random patterns simulated before learning, 0 for none. A literal is not
+	//simulated when every literal its signature allows is in its closure already
+	int signatureBits = 0;
+	//simulate with plain 0/1/X values instead of X identities: faster, and
+	//loses the implications where an X meets its complement
+	bool ternary = false;
+};
+
+//how much of the learning sequence a run got through
+struct LearningCoverage
 {
-	JUNK,           /* 0 */
-	T_input,        /* 1 */
-	T_output,       /* 2 */
-	T_xor,          /* 3 */
-	T_xnor,         /* 4 */
-	T_dff,          /* 5 */
-	T_and,          /* 6 */
-	T_nand,         /* 7 */
-	T_or,           /* 8 */
-	T_nor,          /* 9 */
-	T_not,          /* 10 */
-	T_buf,          /* 11 */
-	T_tie1,         /* 12 */
-	T_tie0,         /* 13 */
-	T_tieX,         /* 14 */
-	T_tieZ,         /* 15 */
-	T_mux_2,        /* 16 */
-	T_bus,          /* 17 */
-	T_bus_gohigh,   /* 18 */
-	T_bus_golow,    /* 19 */
-	T_tristate,     /* 20 */
-	T_tristateinv,  /* 21 */
-	T_tristate1     /* 22 */
+	int literals;		// literals in the learning sequence
+	int covered;		// literals the first pass reached
+	int capped;			// literals whose simulations hit the iteration cap
+	const char *stopReason;	// "complete", "time budget", "memory budget" or "stopped"
 };
 
+//number of locks guarding the implication lists, lists share locks by literal
+#define LIST_LOCK_STRIPES 64
 
 ////////////////////////////////////////////////////////////////////////
 // LogicSim class
 ////////////////////////////////////////////////////////////////////////
 class LogicSim
 {
-	int x_number; //starts at 4 to avoid conflicts with 0/1
+	//shared read-only topology
+	Netlist *netlist;
+	//after a sweep, the reduced circuit which simulates and learns in place of
+	//this one, and how its gates relate to the original gates
+	std::atomic<LogicSim *> reduced;
+	NetlistSweep *sweepMap;
+	//primary simulation context, used for learning and the REPL
+	SimContext *ctx;
+	//workers for simulating wide levels of ctx in parallel (NULL when serial)
+	ThreadPool *simPool;
+
 	int x_number_reset; //x_number used to reset circuit to default state
-	int numTieNodes;
-	int *TIES;
-	int INIT0;
-
-	// circuit information
-	int numFaultFreeGates;	// number of fault free gates
-	int numout;		// number of POs
-	int maxlevels;	// number of levels in gate level ckt
-	int maxLevelSize;	// maximum number of gates in one given level
-	int levelSize[MAXlevels];	// levelSize for each level
-	int inputs[MAXIOS];
-	int outputs[MAXIOS];
-	int ff_list[MAXFFS];
-	int *ffMap;
-	unsigned char *gtype;// gate type
-	short *fanin;		// number of fanin, fanouts
-	short *fanout;
-	int *levelNum;		// level number of gate
-	unsigned *po;
-	int **inlist;		// fanin list
-	int **fnlist;		// fanout list
-	char *sched;		// scheduled on the wheel yet?
-	unsigned int * GateValues;	//gate values (0, 1 or X number)
 	unsigned int * OrigGateValues;	//original gate values, with all X inputs to circuit
-	int **predOfSuccInput;      // predecessor of successor input-pin list
-	int **succOfPredOutput;     // successor of predecessor output-pin list
-	int **levelEvents;	// event list for each level in the circuit
-	int *levelLen;	// evenlist length
-	int numlevels;	// total number of levels in wheel
-	int currLevel;	// current level
-	int *activation;	// activation list for the current level in circuit
-	int actLen;		// length of the activation list
-	int *actFFList;	// activation list for the FF's
-	int actFFLen;	// length of the actFFList
 
 public:
 	int numgates;	// total number of gates (faulty included)
 	int numpri;		// number of PIs
 	int numff;		// number of FF's
-	unsigned int *RESET_FF1;	// value of reset ffs read from *.initState
-	unsigned int *RESET_FF2;	// value of reset ffs read from *.initState
 
 	//number of indirect implications found
 	int numIndirectImplications;
@@ -152,62 +132,155 @@ public:
 	int fixedNodeCounter;
 
 	double elapsedMsDirect, elapsedMsIndirect;
+	//passes over the literals made by the last learning run
+	int numLearningPasses;
+	//literals learned by composition instead of simulation in the last run
+	int numPrunedLiterals;
+	//literals learned by clause propagation alone, and the edges it found
+	int numClauseLiterals;
+	int numClauseImplications;
+	//literals whose simulation was skipped by the random pattern signatures
+	int numSignatureSkips;
+	//what the last learning run covered, and why it ended
+	LearningCoverage coverage;
+	//what the sweep removed, valid when learned with the sweep option
+	SweepReport sweepReport;
 
-	LogicSim(std::string path);	// constructor with path
+	LogicSim(std::string path, bool verbose = true, bool learn = true);	// constructor with path
+	LogicSim(Netlist *circuit, bool verbose);	// constructor for a derived netlist, takes ownership of it
 	LogicSim();					//default constructor
+	~LogicSim();				//releases the netlist, contexts and implication lists
 
 	//functions added for interfacing with REPL
 	void printGateInfo(int gateNumber);
 	void printCircuitInfo();
-	ImplicationList getImplicationList(uint32_t imp);
+	ImplicationList getImplicationList(uint32_t imp) const;
+	bool buildImplicationList(uint32_t imp, ImplicationList &currentList) const;
+	const StoredImplicationList & getDirectList(uint32_t imp) const;	// learned edges only, no closure
+
+	//functions for running independent simulations on the shared netlist
+	const Netlist * getNetlist() const { return netlist; }
+	SimContext * createContext() const;	// caller owns the returned context
 
-	void setFaninoutMatrix();	// builds the fanin-out map matrix
 	void applyVector(char *);	// apply input vector
-	void setupWheel(int, int);
-	void insertEvent(int, int);
-	int retrieveEvent();
+	int applyVectorDelta(const char *vec);	// apply input vector, scheduling only the inputs that changed
 	void goodsim(bool verbose);		// logic sim (no faults inserted)
-	void setTieEvents();	// inject events from tied node
-	void observeOutputs();	// print the fault-free outputs
-	char *goodState;		// good state (without scan)
+	long simulationEvents() const;	// gates evaluated by the primary context so far
+	std::string outputValues() const;	// PO values of the primary context as a string of 0/1/X
+	//simulate wide levels of the primary context on numThreads workers (1 for serial)
+	void setSimulationThreads(int numThreads);
 
-private:
-	//Gate evaluation functions
-	unsigned int evalAND(int gateN);
-	unsigned int evalNAND(int gateN);
-	unsigned int evalOR(int gateN);
-	unsigned int evalNOR(int gateN);
-	unsigned int evalXOR(int gateN);
-	unsigned int evalXNOR(int gateN);
+	//asks a learning run in progress (on another thread) to stop early
+	void requestStop();
+	//approximate bytes held by the netlist, contexts and implication lists
+	size_t memoryUsage() const;
+	//bytes the memory budget is checked against, counted for this circuit alone
+	size_t trackedMemory() const;
+
+	//learning order and fixed point setting, takes effect at the next generateImplicationLists
+	void setLearningOptions(const LearningOptions &options) { learning = options; }
+	static bool parseLearningOrder(const std::string &name, LearningOrder &order);
+	static const char * learningOrderName(LearningOrder order);
 
+	//controlling function to generate all static implications (run by the constructor unless learn is false)
+	void generateImplicationLists();
+	//learns implications from a baseline circuit and its exported lists, redoing
+	//only the literals near gates which differ with the learning options set
+	//(use instead of generateImplicationLists). Sweep, shards and checkpoints are not supported
+	bool incrementalUpdate(const Netlist *baseline, ImplicationReader &baselineLists, EcoReport &report);
+	//takes every list from a binary export of this circuit instead of learning
+	bool loadImplicationLists(ImplicationReader &lists);
+	//adds the lists of another shard's export to lists already loaded from one
+	bool mergeImplicationLists(ImplicationReader &lists);
+	//after merging, fixes the literals whose closure conflicts. Returns how many
+	int fixConflictingLiterals(int numThreads);
+	//path of the on-disk database the lists are read from, empty if they are in memory
+	std::string databasePath() const;
+
+private:
 	//functions to generate implication lists for each gate
-	void generateImplicationLists();	//controlling function to generate all static implications
 	void genDirectImplications();		//function which populates direct implication list for each function
 	void firstLevelImplications(uint32_t imp);
-	void genIndirectImplications();		//function which finishes implication lists using logic simulation to find indirect implications
-	void indirectImplicationSim(uint32_t imp);		//function which runs simulations to determine indirect implications for a set of nodes
-	void resetCircuit();	//resets gate values to default (input all X)
+	void genIndirectImplications(const std::vector<char> *learnOnly = NULL);		//function which finishes implication lists using logic simulation to find indirect implications, for the literals set in learnOnly if given
+	bool indirectImplicationSim(uint32_t imp, SimContext *context, std::vector<uint32_t> *changedLists = NULL, const RandomSignatures *signatures = NULL);		//function which runs simulations to determine indirect implications for a set of nodes, true if the list changed
+	bool clauseImplications(uint32_t imp, GateClauses &clauses, std::vector<uint32_t> *changedLists, bool &simulate);	//unit propagation over the gate clauses from the closure of imp, true if the list changed
+	void fixLiteral(uint32_t imp, std::vector<uint32_t> *changedLists);	//imp can never hold, empties its list
+	bool addImplication(uint32_t from, uint32_t to, std::vector<uint32_t> *changedLists);	//inserts from -> to and its contrapositive, true if either was new
+	bool insertEdge(uint32_t from, uint32_t to, std::vector<uint32_t> *changedLists);
+	void learningSequence(std::vector<uint32_t> &literals) const;	//all literals, in the configured learning order
+	void pruneSequence(std::vector<uint32_t> &literals);	//drops literals inside fanout-free regions
+	bool equivalentToLearned(uint32_t imp, const std::vector<int> &learnedAt) const;
+	void findStaleLiterals(const std::vector<int> &learnedAt, const std::vector<int> &changedAt, std::vector<char> &stale) const;
+	//state of a learning run, the first part is what a checkpoint saves
+	struct LearningProgress
+	{
+		int pass;				// current pass, from 1
+		size_t position;		// next index into the learning sequence
+		int step;				// literals learned so far, over all passes
+		bool changed;			// a list changed in the current pass
+		std::vector<int> learnedAt;		// step each literal was last learned at
+		std::vector<int> changedAt;		// step each list last changed at
+		std::vector<char> stale;		// literals to learn in the current pass
+		//not saved, used to time checkpoints and estimate the time left
+		std::chrono::steady_clock::time_point started, lastCheckpoint, lastReport;
+		int startSimulations, startStep;
+	};
+	void reportProgress(LearningProgress &progress, size_t sequenceLength);	// prints progress and checkpoints when due
+	bool budgetReached();	// sets the stop reason if the time or memory budget is used up
+	bool writeCheckpoint(const LearningProgress &progress, size_t sequenceLength);	// atomically replaces the checkpoint file
+	bool readCheckpoint(LearningProgress &progress, size_t sequenceLength);	// restores lists, counters and progress
+	void buildLearningSequence(const std::vector<char> *learnOnly, std::vector<uint32_t> &sequence);	// ordered, filtered, pruned and sharded
+	void startLearningHelpers();	// clauses, signatures and ternary simulator, as the options ask
+	void finishLearningHelpers();
+	void startProgress(LearningProgress &progress, size_t sequenceLength);	// from the checkpoint, or a fresh first pass
+	bool learningPass(const std::vector<uint32_t> &sequence, LearningProgress &progress, size_t &spillAt);	// false if a budget ran out
+	void learnLiteral(uint32_t imp, LearningProgress &progress, std::vector<uint32_t> &changedLists);	// one step of a pass
+	void resetCircuit(SimContext *context);	//resets gate values to default (input all X)
 	void initialSim();		//applys all X input vector and stores gate results from simulation.
-	void recursiveListGen(uint32_t imp);
+	void recursiveListGen(uint32_t imp, ImplicationList &currentList, ImplicationList &traversedList, bool &badImpValue) const;
+	void findEcoChanges(const Netlist *baseline, std::vector<char> &affected, EcoReport &report);	// marks changed gates and their cones
+	void setup(Netlist *circuit, bool verbose);	// shared by the constructors
+	void sweepAndLearn();	// reduces the netlist, learns the reduced one and maps the lists back
+	void translateReducedLists();	// rebuilds the lists in original gate ids from the reduced circuit
+	uint32_t originalLiteral(uint32_t reducedImp) const;
+	void propagateConstant(uint32_t imp);	// makes imp part of the reset state of every later simulation
+	void readDirectList(uint32_t imp, std::vector<uint32_t> &targets) const;	// resident, spilled or database edges of imp
+	void spillColdLists(const LearningProgress &progress);	// moves the least recently changed lists to a run
+	void finishSpill();	// merges resident and spilled lists into the database
 
+	//bytes of this circuit's implication lists, other circuits in the
+	//process are counted separately
+	MemoryOwner listMemory;
 	//list of implications for all gates at 0
-	ImplicationList * zeroList;
+	StoredImplicationList * zeroList;
 	//list of implications for all gates at 1
-	ImplicationList * oneList;
-
-	//clocks for measuring performance
-	clock_t startDirect, endDirect, endIndirect;
-
-	//used for generating combined implication lists
-	ImplicationList currentList;
-	ImplicationList traversedList;
-
-	//track if current gate is fixed or not
-	bool badImpValue;
+	StoredImplicationList * oneList;
+	//lists spilled while learning, and the database they end up in (NULL when in memory)
+	ListSpill *spill;
+	ImplicationReader *database;
+	//simulates in place of ctx while learning in ternary mode (NULL otherwise)
+	TernarySim *ternary;
+	//while learning, the gate clauses and random pattern signatures the
+	//options ask for (NULL otherwise), and the simulations checked against
+	//the signatures so far
+	GateClauses *gateClauses;
+	RandomSignatures *randomSignatures;
+	int signatureChecks;
 
-	std::vector<uint32_t> changes;
+	//clocks for measuring performance (wall time, other circuits may be learning concurrently)
+	std::chrono::steady_clock::time_point startDirect, endDirect, endIndirect;
 
-	std::vector<uint32_t> evalValues;
+	//print progress messages while learning
+	bool verboseLearning;
+	LearningOptions learning;
+	//netlist was derived from another circuit, it is never swept again
+	bool derived;
+	//learning time spent before the checkpoint this run resumed from
+	double resumedMs;
+	//striped locks for inserting into the implication lists
+	std::mutex listLocks[LIST_LOCK_STRIPES];
+	//set from another thread to abandon learning early
+	std::atomic<bool> stopRequested;
 };
 
 #endif
\ No newline at end of file
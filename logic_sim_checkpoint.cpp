@@ -0,0 +1,319 @@
+// Filename:	logic_sim_checkpoint.cpp
+// Description:	Checkpoints of a learning run. The lists, counters and the
+//				position in the learning sequence are saved periodically so
+//				that a run which dies can be continued with --resume.
+
+#include "logic_sim.h"
+#include "implication_export.h"
+
+//system includes
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+/*
+Checkpoint format:
+
+	char[8]		magic "GISCKP01"
+	varints		version, number of gates, sequence length, learning options,
+				shard index, number of shards, signature bits, iteration cap,
+				pass, position, step, changed, implications, simulations,
+				fixed gates, pruned literals, clause literals, clause
+				implications, signature skips, capped literals, learning ms,
+				reset X number
+	varints		reset gate values, one per gate
+	varints		learnedAt, changedAt, stale, one each per literal
+	lists		one per literal (2*gate + value), as in the binary export
+	char[8]		magic again, so a short file is never taken for a whole one
+*/
+#define CHECKPOINT_MAGIC "GISCKP01"
+#define CHECKPOINT_VERSION 3
+//bytes encoded before they are written out
+#define CHECKPOINT_WRITE_BYTES (1 << 20)
+
+//header fields in file order. The fields up to CheckpointPass must match
+//the run being resumed
+enum CheckpointField
+{
+	CheckpointVersion,
+	CheckpointGates,
+	CheckpointSequence,
+	CheckpointOptions,
+	CheckpointShardIndex,
+	CheckpointShards,
+	CheckpointSignatureBits,
+	CheckpointIterationCap,
+	CheckpointPass,
+	CheckpointPosition,
+	CheckpointStep,
+	CheckpointChanged,
+	CheckpointImplications,
+	CheckpointSimulations,
+	CheckpointFixedGates,
+	CheckpointPrunedLiterals,
+	CheckpointClauseLiterals,
+	CheckpointClauseImplications,
+	CheckpointSignatureSkips,
+	CheckpointCappedLiterals,
+	CheckpointMs,
+	CheckpointResetX,
+	CheckpointFields		// number of fields
+};
+
+//the settings which decide the learning sequence and what a pass does
+static uint64_t optionBits(const LearningOptions &options)
+{
+	return (uint64_t) options.order | (options.fixedPoint ? 0x10 : 0) | (options.prune ? 0x20 : 0) | (options.sweep ? 0x40 : 0)
+		| (options.clauses ? 0x80 : 0) | (options.ternary ? 0x100 : 0);
+}
+
+//writes out what is buffered once it reaches atLeast bytes, false on an I/O error
+static bool writePiece(FILE *out, string &buffer, size_t atLeast)
+{
+	if (buffer.size() < atLeast)
+	{
+		return true;
+	}
+	bool written = fwrite(buffer.data(), 1, buffer.size(), out) == buffer.size();
+	buffer.clear();
+	return written;
+}
+
+//the header fields which identify the circuit and the learning run
+static void runFields(uint64_t *header, int numgates, size_t sequenceLength, const LearningOptions &options)
+{
+	header[CheckpointVersion] = CHECKPOINT_VERSION;
+	header[CheckpointGates] = numgates;
+	header[CheckpointSequence] = sequenceLength;
+	header[CheckpointOptions] = optionBits(options);
+	//shards of the same length have different sequences
+	header[CheckpointShardIndex] = options.numShards > 1 ? options.shardIndex : 0;
+	header[CheckpointShards] = options.numShards > 1 ? options.numShards : 0;
+	header[CheckpointSignatureBits] = options.signatureBits;
+	header[CheckpointIterationCap] = options.iterationCap;
+}
+
+//where learning got to, with the time left estimated from the simulations
+//per second so far and the simulations each learned literal took
+void LogicSim::reportProgress(LearningProgress &progress, size_t sequenceLength)
+{
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+	if (!learning.checkpointPath.empty() && now - progress.lastCheckpoint >= chrono::seconds(learning.checkpointSeconds))
+	{
+		writeCheckpoint(progress, sequenceLength);
+		progress.lastCheckpoint = now;
+	}
+	if (!verboseLearning || now - progress.lastReport < chrono::seconds(PROGRESS_SECONDS))
+	{
+		return;
+	}
+	progress.lastReport = now;
+	double seconds = chrono::duration<double>(now - progress.started).count();
+	double simulations = numSimulations - progress.startSimulations;
+	int learned = progress.step - progress.startStep;
+	double rate = seconds > 0 ? simulations / seconds : 0;
+	cout << "Pass " << progress.pass << ": " << progress.position << " of " << sequenceLength << " literals, "
+		<< (long) rate << " simulations/s";
+	if (learned > 0 && rate > 0)
+	{
+		double left = (sequenceLength - progress.position) * simulations / learned / rate;
+		cout << ", about " << (long) left << " s left" << (learning.fixedPoint ? " in this pass" : "");
+	}
+	cout << "\n";
+}
+
+/*
+The checkpoint is written to a temporary file next to it, flushed to disk
+and renamed over the old one, so a crash at any point leaves either the old
+or the new checkpoint complete. It is encoded in pieces of about
+CHECKPOINT_WRITE_BYTES which are written as they fill, so a checkpoint of a
+large circuit does not need a second copy of the lists in memory.
+*/
+bool LogicSim::writeCheckpoint(const LearningProgress &progress, size_t sequenceLength)
+{
+	string buffer(CHECKPOINT_MAGIC);
+	vector<uint32_t> literals;
+	int i;
+
+	string temporary = learning.checkpointPath + ".tmp";
+	FILE *out = fopen(temporary.c_str(), "wb");
+	bool written = out != NULL;
+
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - endDirect).count() + resumedMs;
+	uint64_t header[CheckpointFields];
+	runFields(header, numgates, sequenceLength, learning);
+	header[CheckpointPass] = progress.pass;
+	header[CheckpointPosition] = progress.position;
+	header[CheckpointStep] = progress.step;
+	header[CheckpointChanged] = progress.changed;
+	header[CheckpointImplications] = numIndirectImplications;
+	header[CheckpointSimulations] = numSimulations;
+	header[CheckpointFixedGates] = fixedNodeCounter;
+	header[CheckpointPrunedLiterals] = numPrunedLiterals;
+	header[CheckpointClauseLiterals] = numClauseLiterals;
+	header[CheckpointClauseImplications] = numClauseImplications;
+	header[CheckpointSignatureSkips] = numSignatureSkips;
+	header[CheckpointCappedLiterals] = coverage.capped;
+	header[CheckpointMs] = (uint64_t) ms;
+	header[CheckpointResetX] = x_number_reset;
+	for (int h = 0; h < CheckpointFields; h++)
+	{
+		appendVarint(buffer, header[h]);
+	}
+	for (i = 0; i < numgates && written; i++)
+	{
+		appendVarint(buffer, OrigGateValues[i]);
+		written = writePiece(out, buffer, CHECKPOINT_WRITE_BYTES);
+	}
+	for (i = 0; i < 2 * numgates && written; i++)
+	{
+		appendVarint(buffer, progress.learnedAt[i]);
+		written = writePiece(out, buffer, CHECKPOINT_WRITE_BYTES);
+	}
+	for (i = 0; i < 2 * numgates && written; i++)
+	{
+		appendVarint(buffer, progress.changedAt[i]);
+		written = writePiece(out, buffer, CHECKPOINT_WRITE_BYTES);
+	}
+	for (i = 0; i < 2 * numgates && written; i++)
+	{
+		appendVarint(buffer, progress.stale[i]);
+		written = writePiece(out, buffer, CHECKPOINT_WRITE_BYTES);
+	}
+	for (uint32_t literal = 0; literal < 2 * (uint32_t) numgates && written; literal++)
+	{
+		const StoredImplicationList &list = getDirectList(literalFromIndex(literal));
+		literals.clear();
+		for (auto it = list.begin(); it != list.end(); ++it)
+		{
+			literals.push_back(literalIndex(*it));
+		}
+		encodeLiteralList(buffer, literals);
+		written = writePiece(out, buffer, CHECKPOINT_WRITE_BYTES);
+	}
+	buffer += CHECKPOINT_MAGIC;
+
+	written = written && writePiece(out, buffer, 0) && fflush(out) == 0 && fsync(fileno(out)) == 0;
+	if (out != NULL && fclose(out) != 0)
+	{
+		written = false;
+	}
+	if (!written || rename(temporary.c_str(), learning.checkpointPath.c_str()) != 0)
+	{
+		cerr << "WARNING: Could not write checkpoint " << learning.checkpointPath << "\n";
+		remove(temporary.c_str());
+		return false;
+	}
+	//the rename itself is only durable once the directory is synced
+	size_t slash = learning.checkpointPath.find_last_of('/');
+	string directory = slash == string::npos ? "." : learning.checkpointPath.substr(0, slash + 1);
+	int fd = open(directory.c_str(), O_RDONLY);
+	if (fd >= 0)
+	{
+		fsync(fd);
+		close(fd);
+	}
+	return true;
+}
+
+//a missing checkpoint starts learning from the beginning, one written for
+//another circuit or with other learning options is an error
+bool LogicSim::readCheckpoint(LearningProgress &progress, size_t sequenceLength)
+{
+	ifstream in(learning.checkpointPath.c_str(), ios::in | ios::binary);
+	if (!in)
+	{
+		if (verboseLearning)
+			cout << "No checkpoint at " << learning.checkpointPath << ", learning from the start\n";
+		return false;
+	}
+	string buffer((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+	size_t magicSize = sizeof(CHECKPOINT_MAGIC) - 1;
+	if (buffer.size() < 2 * magicSize || buffer.compare(0, magicSize, CHECKPOINT_MAGIC) != 0
+		|| buffer.compare(buffer.size() - magicSize, magicSize, CHECKPOINT_MAGIC) != 0)
+	{
+		cerr << "ERROR: " << learning.checkpointPath << " is not a complete checkpoint\n";
+		exit(-1);
+	}
+	const unsigned char *pos = (const unsigned char *) buffer.data() + magicSize;
+	const unsigned char *end = (const unsigned char *) buffer.data() + buffer.size() - magicSize;
+	uint64_t header[CheckpointFields];
+	uint64_t expected[CheckpointFields];
+	bool ok = true;
+	for (int h = 0; h < CheckpointFields; h++)
+	{
+		ok = ok && readVarint(pos, end, header[h]);
+	}
+	runFields(expected, numgates, sequenceLength, learning);
+	for (int h = 0; h < CheckpointPass; h++)
+	{
+		ok = ok && header[h] == expected[h];
+	}
+	if (!ok)
+	{
+		cerr << "ERROR: Checkpoint " << learning.checkpointPath << " was written for another circuit, shard or other learning options\n";
+		exit(-1);
+	}
+	progress.pass = header[CheckpointPass];
+	progress.position = header[CheckpointPosition];
+	progress.step = header[CheckpointStep];
+	progress.changed = header[CheckpointChanged] != 0;
+	numIndirectImplications = header[CheckpointImplications];
+	numSimulations = header[CheckpointSimulations];
+	fixedNodeCounter = header[CheckpointFixedGates];
+	numPrunedLiterals = header[CheckpointPrunedLiterals];
+	numClauseLiterals = header[CheckpointClauseLiterals];
+	numClauseImplications = header[CheckpointClauseImplications];
+	numSignatureSkips = header[CheckpointSignatureSkips];
+	coverage.capped = header[CheckpointCappedLiterals];
+	resumedMs = header[CheckpointMs];
+	x_number_reset = header[CheckpointResetX];
+
+	uint64_t value;
+	int i;
+	for (i = 0; i < numgates && ok; i++)
+	{
+		ok = readVarint(pos, end, value);
+		OrigGateValues[i] = value;
+	}
+	progress.learnedAt.assign(2 * numgates, 0);
+	progress.changedAt.assign(2 * numgates, 0);
+	progress.stale.assign(2 * numgates, 0);
+	for (i = 0; i < 2 * numgates && ok; i++)
+	{
+		ok = readVarint(pos, end, value);
+		progress.learnedAt[i] = value;
+	}
+	for (i = 0; i < 2 * numgates && ok; i++)
+	{
+		ok = readVarint(pos, end, value);
+		progress.changedAt[i] = value;
+	}
+	for (i = 0; i < 2 * numgates && ok; i++)
+	{
+		ok = readVarint(pos, end, value);
+		progress.stale[i] = value;
+	}
+	vector<uint32_t> literals;
+	for (uint32_t literal = 0; literal < 2 * (uint32_t) numgates && ok; literal++)
+	{
+		uint32_t imp = literalFromIndex(literal);
+		StoredImplicationList &list = imp & VALUE ? oneList[imp & GATE] : zeroList[imp & GATE];
+		ok = decodeLiteralList(pos, end, literals);
+		list.clear();
+		for (size_t k = 0; k < literals.size(); k++)
+		{
+			list.insert(literalFromIndex(literals[k]));
+		}
+	}
+	if (!ok || pos != end)
+	{
+		cerr << "ERROR: Checkpoint " << learning.checkpointPath << " is damaged\n";
+		exit(-1);
+	}
+	if (verboseLearning)
+		cout << "Resuming learning from " << learning.checkpointPath << " at pass " << progress.pass << ", literal "
+			<< progress.position << " of " << sequenceLength << "\n";
+	return true;
+}
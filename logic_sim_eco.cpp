@@ -0,0 +1,296 @@
+// Filename:	logic_sim_eco.cpp
+// Description:	Incremental implication learning after a small netlist edit
+//				(ECO). Implications far from the edited gates are taken from
+//				the baseline circuit's exported lists, and only literals near
+//				the edit are learned again by logic simulation. An unchanged
+//				circuit can take all of its lists from an export.
+
+#include "logic_sim.h"
+#include "implication_export.h"
+#include "perf_counters.h"
+
+using namespace std;
+
+/*
+Gates are matched by gate number, so the edited .lev must keep the numbering
+of the gates it did not touch. A gate is changed if it is new, or its type or
+fanin list differs from the baseline. Every implication derived through a
+changed gate lies in its fanin or fanout cone, so those cones are learned
+again from scratch. A baseline list is only reused if nothing it was learned
+from can have gone through the cones: its literal is outside them and
+reachable, and every literal it implies is outside them and has a reused
+list, as does the complement of each (whose list holds the contrapositive).
+Every other literal starts again from its direct implications, since an
+edge it kept could have been derived through the edit.
+*/
+bool LogicSim::incrementalUpdate(const Netlist *baseline, ImplicationReader &baselineLists, EcoReport &report)
+{
+	vector<char> affected;
+	vector<char> relearn(2 * numgates, 1);
+	vector<uint32_t> start(2 * numgates + 1, 0);
+	vector<uint32_t> predecessors;
+	vector<uint32_t> stack;
+	vector<vector<uint32_t> > lists(2 * numgates);
+	int gate, value;
+
+	if ((int) baselineLists.numgates != baseline->numgates)
+	{
+		cerr << "ERROR: Implication lists are for " << baselineLists.numgates << " gates, baseline circuit has "
+			<< baseline->numgates << endl;
+		return false;
+	}
+
+	//the baseline is matched by gate number, which a sweep changes, and a
+	//checkpoint or shard would not record which lists were reused
+	if (learning.sweep || learning.numShards > 1 || !learning.checkpointPath.empty())
+	{
+		cerr << "ERROR: An incremental update can not sweep, learn a shard or checkpoint" << endl;
+		return false;
+	}
+
+	startDirect = chrono::steady_clock::now();
+	report.keptLiterals = 0;
+	report.relearnedLiterals = 0;
+	findEcoChanges(baseline, affected, report);
+
+	//read the baseline lists outside the affected cones, any edge into the
+	//cones (or unreachable literal) disqualifies the list
+	for (gate = 1; gate < numgates; gate++)
+	{
+		if (affected[gate])
+		{
+			continue;
+		}
+		for (value = 0; value < 2; value++)
+		{
+			uint32_t literal = 2 * gate + value;
+			if (!baselineLists.readList(literal, lists[literal]))
+			{
+				cerr << "ERROR: Could not read baseline implications for gate " << gate << endl;
+				return false;
+			}
+			relearn[literal] = lists[literal].empty();
+			for (size_t i = 0; i < lists[literal].size(); i++)
+			{
+				uint32_t target = lists[literal][i] >> 1;
+				if ((int) target >= numgates || affected[target])
+				{
+					relearn[literal] = 1;
+				}
+			}
+		}
+	}
+
+	//reverse edges in compressed rows, literal -> literals whose list holds it
+	for (uint32_t literal = 2; literal < 2 * (uint32_t) numgates; literal++)
+	{
+		if (!relearn[literal])
+		{
+			for (size_t i = 0; i < lists[literal].size(); i++)
+			{
+				start[lists[literal][i] + 1]++;
+			}
+		}
+	}
+	for (size_t i = 0; i + 1 < start.size(); i++)
+	{
+		start[i + 1] += start[i];
+	}
+	predecessors.resize(start.back());
+	vector<uint32_t> fill(start.begin(), start.end() - 1);
+	for (uint32_t literal = 2; literal < 2 * (uint32_t) numgates; literal++)
+	{
+		if (!relearn[literal])
+		{
+			for (size_t i = 0; i < lists[literal].size(); i++)
+			{
+				predecessors[fill[lists[literal][i]]++] = literal;
+			}
+		}
+	}
+
+	//a literal is learned again if its list holds a relearned literal, or
+	//the complement of one
+	for (uint32_t literal = 2; literal < 2 * (uint32_t) numgates; literal++)
+	{
+		if (relearn[literal])
+		{
+			stack.push_back(literal);
+		}
+	}
+	while (!stack.empty())
+	{
+		uint32_t literal = stack.back();
+		stack.pop_back();
+		for (uint32_t target = literal & ~1U; target <= (literal | 1); target++)
+		{
+			for (uint32_t i = start[target]; i < start[target + 1]; i++)
+			{
+				if (!relearn[predecessors[i]])
+				{
+					relearn[predecessors[i]] = 1;
+					stack.push_back(predecessors[i]);
+				}
+			}
+		}
+	}
+
+	//reuse the lists that are left, and rebuild direct implications for the rest
+	for (gate = 1; gate < numgates; gate++)
+	{
+		for (value = 0; value < 2; value++)
+		{
+			uint32_t literal = 2 * gate + value;
+			if (relearn[literal])
+			{
+				continue;
+			}
+			StoredImplicationList &list = value ? oneList[gate] : zeroList[gate];
+			for (size_t i = 0; i < lists[literal].size(); i++)
+			{
+				list.insert(literalFromIndex(lists[literal][i]));
+			}
+			vector<uint32_t>().swap(lists[literal]);
+			report.keptLiterals++;
+		}
+	}
+	for (gate = 1; gate < numgates; gate++)
+	{
+		for (value = 0; value < 2; value++)
+		{
+			uint32_t imp = value ? (gate | VALUE) : gate;
+			if (relearn[2 * gate + value])
+			{
+				if (value)
+					oneList[gate].insert(imp);
+				else
+					zeroList[gate].insert(imp);
+				firstLevelImplications(imp);
+				report.relearnedLiterals++;
+			}
+		}
+	}
+	if (verboseLearning)
+		cout << "Reused " << report.keptLiterals << " baseline implication lists\n";
+	endDirect = chrono::steady_clock::now();
+	elapsedMsDirect = chrono::duration_cast<chrono::milliseconds>(endDirect - startDirect).count();
+
+	//learn the invalidated literals with the configured learning options
+	{
+		PerfScope scope(PerfIndirect);
+		genIndirectImplications(&relearn);
+	}
+	if (verboseLearning)
+		cout << "Finished relearning " << report.relearnedLiterals << " literals\n";
+	endIndirect = chrono::steady_clock::now();
+	elapsedMsIndirect = chrono::duration_cast<chrono::milliseconds>(endIndirect - endDirect).count();
+	return true;
+}
+
+//an unreachable literal is stored as an empty list, as learning leaves it
+bool LogicSim::loadImplicationLists(ImplicationReader &lists)
+{
+	vector<uint32_t> literals;
+
+	if ((int) lists.numgates != numgates)
+	{
+		cerr << "ERROR: Implication lists are for " << lists.numgates << " gates, circuit has " << numgates << endl;
+		return false;
+	}
+	startDirect = chrono::steady_clock::now();
+	fixedNodeCounter = 0;
+	for (uint32_t literal = 2; literal < 2 * (uint32_t) numgates; literal++)
+	{
+		uint32_t imp = literalFromIndex(literal);
+		StoredImplicationList &list = imp & VALUE ? oneList[imp & GATE] : zeroList[imp & GATE];
+		if (!lists.readList(literal, literals))
+		{
+			cerr << "ERROR: Could not read implications for gate " << (imp & GATE) << endl;
+			return false;
+		}
+		list.clear();
+		for (size_t i = 0; i < literals.size(); i++)
+		{
+			list.insert(literalFromIndex(literals[i]));
+		}
+		if (literals.empty())
+		{
+			fixedNodeCounter++;
+		}
+	}
+	endDirect = endIndirect = chrono::steady_clock::now();
+	elapsedMsDirect = chrono::duration_cast<chrono::milliseconds>(endDirect - startDirect).count();
+	elapsedMsIndirect = 0;
+	return true;
+}
+
+//marks every gate which differs from the baseline, then grows the marks
+//over the fanin and fanout cones of those gates
+void LogicSim::findEcoChanges(const Netlist *baseline, vector<char> &affected, EcoReport &report)
+{
+	vector<int> stack;
+	vector<char> inFanout(numgates, 0);
+	vector<char> inFanin(numgates, 0);
+	int gate, i;
+
+	report.changedGates = 0;
+	report.affectedGates = 0;
+	for (gate = 1; gate < numgates; gate++)
+	{
+		bool changed = gate >= baseline->numgates || netlist->gtype[gate] != baseline->gtype[gate]
+			|| netlist->fanin[gate] != baseline->fanin[gate];
+		for (i = 0; !changed && i < netlist->fanin[gate]; i++)
+		{
+			changed = netlist->inlist[gate][i] != baseline->inlist[gate][i];
+		}
+		if (changed)
+		{
+			report.changedGates++;
+			inFanout[gate] = inFanin[gate] = 1;
+			stack.push_back(gate);
+		}
+	}
+
+	//fanout cones
+	vector<int> seeds = stack;
+	while (!stack.empty())
+	{
+		gate = stack.back();
+		stack.pop_back();
+		for (i = 0; i < netlist->fanout[gate]; i++)
+		{
+			int successor = netlist->fnlist[gate][i];
+			if (!inFanout[successor])
+			{
+				inFanout[successor] = 1;
+				stack.push_back(successor);
+			}
+		}
+	}
+	//fanin cones
+	stack = seeds;
+	while (!stack.empty())
+	{
+		gate = stack.back();
+		stack.pop_back();
+		for (i = 0; i < netlist->fanin[gate]; i++)
+		{
+			int predecessor = netlist->inlist[gate][i];
+			if (!inFanin[predecessor])
+			{
+				inFanin[predecessor] = 1;
+				stack.push_back(predecessor);
+			}
+		}
+	}
+
+	affected.assign(numgates, 0);
+	for (gate = 1; gate < numgates; gate++)
+	{
+		if (inFanout[gate] || inFanin[gate])
+		{
+			affected[gate] = 1;
+			report.affectedGates++;
+		}
+	}
+}
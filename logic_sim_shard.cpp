@@ -0,0 +1,86 @@
+// Filename:	logic_sim_shard.cpp
+// Description:	Merging the lists of a sharded learning run. Each shard
+//				learns a strided subset of the learning sequence in its own
+//				process and exports its lists, which are combined here.
+
+#include "logic_sim.h"
+#include "implication_export.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+
+using namespace std;
+
+//a literal which any shard found unreachable stays unreachable, every other
+//list is the union of the shards' edges
+bool LogicSim::mergeImplicationLists(ImplicationReader &lists)
+{
+	vector<uint32_t> literals;
+
+	if ((int) lists.numgates != numgates)
+	{
+		cerr << "ERROR: Implication lists are for " << lists.numgates << " gates, circuit has " << numgates << endl;
+		return false;
+	}
+	for (uint32_t literal = 2; literal < 2 * (uint32_t) numgates; literal++)
+	{
+		uint32_t imp = literalFromIndex(literal);
+		StoredImplicationList &list = imp & VALUE ? oneList[imp & GATE] : zeroList[imp & GATE];
+		if (!lists.readList(literal, literals))
+		{
+			cerr << "ERROR: Could not read implications for gate " << (imp & GATE) << endl;
+			return false;
+		}
+		if (list.empty())
+		{
+			continue;
+		}
+		if (literals.empty())
+		{
+			list.clear();
+			fixedNodeCounter++;
+			continue;
+		}
+		for (size_t i = 0; i < literals.size(); i++)
+		{
+			list.insert(literalFromIndex(literals[i]));
+		}
+	}
+	return true;
+}
+
+/*
+A shard's simulations only started from its own learned edges, so a closure
+over the merged lists can combine edges of several shards into a conflict
+that no shard saw. Those literals can not be reached. They are fixed after
+the whole pass, since fixing one empties its list and would change the
+closures of the literals checked after it.
+*/
+int LogicSim::fixConflictingLiterals(int numThreads)
+{
+	vector<char> conflict(2 * numgates, 0);
+	int fixed = 0;
+	{
+		ThreadPool pool(max(1, numThreads));
+		pool.parallelFor(2 * numgates - 2, 256, [&](int begin, int end, int) {
+			ImplicationList closure;
+			for (int i = begin; i < end; i++)
+			{
+				uint32_t imp = literalFromIndex(i + 2);
+				if (!getDirectList(imp).empty() && !buildImplicationList(imp, closure))
+				{
+					conflict[i + 2] = 1;
+				}
+			}
+		});
+	}
+	for (uint32_t literal = 2; literal < 2 * (uint32_t) numgates; literal++)
+	{
+		if (conflict[literal])
+		{
+			fixLiteral(literalFromIndex(literal), NULL);
+			fixed++;
+		}
+	}
+	return fixed;
+}
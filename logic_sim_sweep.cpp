@@ -0,0 +1,259 @@
+// Filename:	logic_sim_sweep.cpp
+// Description:	Learning on a swept netlist. Constant, equivalent and dead
+//				gates are removed before learning, the smaller circuit is
+//				learned, and its lists are mapped back to the original gate
+//				ids so that queries are unaffected.
+
+#include "logic_sim.h"
+#include "ternary_sim.h"
+
+using namespace std;
+
+/*
+Constants come from the all X simulation (ties and whatever they force) and
+from conflicting direct closures. Two gates g and h are equivalent when g=1
+implies h=w and g=0 implies h=~w, h being the complement of g for w=0. The
+lowest level such h becomes g's representative. The structural pass in the
+sweep adds gates of one type with identical inputs.
+*/
+void LogicSim::sweepAndLearn()
+{
+	ImplicationList closureOne, closureZero;
+
+	startDirect = chrono::steady_clock::now();
+	genDirectImplications();
+	initialSim();
+	sweepMap = new NetlistSweep(netlist);
+	for (int i = 1; i < numgates; i++)
+	{
+		if (OrigGateValues[i] == 0 || OrigGateValues[i] == 1)
+		{
+			sweepMap->setConstant(i, OrigGateValues[i]);
+			continue;
+		}
+		if (!buildImplicationList(i | VALUE, closureOne))
+		{
+			sweepMap->setConstant(i, 0);
+			continue;
+		}
+		if (!buildImplicationList(i, closureZero))
+		{
+			sweepMap->setConstant(i, 1);
+			continue;
+		}
+		int rep = i;
+		bool inv = false;
+		for (auto it = closureOne.begin(); it != closureOne.end(); ++it)
+		{
+			int gate = *it & GATE;
+			if (gate == i || closureZero.count(*it ^ VALUE) == 0)
+			{
+				continue;
+			}
+			if (netlist->levelNum[gate] < netlist->levelNum[rep] || (netlist->levelNum[gate] == netlist->levelNum[rep] && gate < rep))
+			{
+				rep = gate;
+				inv = (*it & VALUE) == 0;
+			}
+		}
+		if (rep != i)
+		{
+			sweepMap->setEquivalent(i, rep, inv);
+		}
+	}
+
+	LogicSim *small = new LogicSim(sweepMap->build(sweepReport), verboseLearning);
+	LearningOptions options = learning;
+	//the sweep counts against the time budget
+	if (options.timeBudgetMs > 0)
+	{
+		long spent = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - startDirect).count();
+		options.timeBudgetMs = max(1L, options.timeBudgetMs - spent);
+	}
+	small->setLearningOptions(options);
+	endDirect = chrono::steady_clock::now();
+	if (verboseLearning)
+	{
+		cout << "Swept " << sweepReport.originalGates << " gates to " << sweepReport.reducedGates << " (" << sweepReport.constants
+			<< " constant, " << sweepReport.merged << " merged, " << sweepReport.dead << " dead, " << sweepReport.inverters
+			<< " inverters added)\n";
+	}
+	//a stop requested before the reduced circuit was published is passed on here
+	reduced = small;
+	if (stopRequested)
+	{
+		small->requestStop();
+	}
+	small->generateImplicationLists();
+
+	translateReducedLists();
+	numIndirectImplications = small->numIndirectImplications;
+	numSimulations = small->numSimulations;
+	fixedNodeCounter = small->fixedNodeCounter;
+	numLearningPasses = small->numLearningPasses;
+	numPrunedLiterals = small->numPrunedLiterals;
+	numClauseLiterals = small->numClauseLiterals;
+	numClauseImplications = small->numClauseImplications;
+	numSignatureSkips = small->numSignatureSkips;
+	coverage = small->coverage;
+	endIndirect = chrono::steady_clock::now();
+	elapsedMsDirect = chrono::duration_cast<chrono::milliseconds>(endDirect - startDirect).count() + small->elapsedMsDirect;
+	elapsedMsIndirect = chrono::duration_cast<chrono::milliseconds>(endIndirect - endDirect).count() - small->elapsedMsDirect;
+}
+
+//the original literal for a literal of the reduced circuit, an added
+//inverter stands for the complement of its input. Shared ties stand for
+//no gate in particular and give gate 0
+uint32_t LogicSim::originalLiteral(uint32_t reducedImp) const
+{
+	int gate = reducedImp & GATE;
+	uint32_t value = reducedImp & VALUE;
+	int original = sweepMap->originalGate[gate];
+	if (original == SWEEP_TIE)
+	{
+		return 0;
+	}
+	if (original == SWEEP_INVERTER)
+	{
+		original = sweepMap->originalGate[reduced.load()->netlist->inlist[gate][0]];
+		value ^= VALUE;
+	}
+	return original | value;
+}
+
+/*
+Kept gates take the reduced lists, mapped back. A merged gate implies its
+representative and the representative implies it, so closures of either
+reach both. Constants imply only themselves. Dead gates were not learned
+and keep their direct implications. Lists of literals which can not occur
+are cleared last, as learning would have left them.
+*/
+void LogicSim::translateReducedLists()
+{
+	LogicSim *small = reduced;
+	int i;
+
+	for (i = 0; i < numgates; i++)
+	{
+		zeroList[i].clear();
+		oneList[i].clear();
+	}
+	for (i = 1; i < numgates; i++)
+	{
+		if (sweepMap->fate[i] == SweepDead)
+		{
+			zeroList[i].insert(i);
+			oneList[i].insert(i | VALUE);
+			firstLevelImplications(i);
+			firstLevelImplications(i | VALUE);
+		}
+	}
+	for (i = 1; i < numgates; i++)
+	{
+		for (int bit = 0; bit < 2; bit++)
+		{
+			uint32_t v = bit ? VALUE : 0;
+			StoredImplicationList &list = v ? oneList[i] : zeroList[i];
+			switch (sweepMap->fate[i])
+			{
+			case SweepKept:
+			{
+				const StoredImplicationList &learned = small->getDirectList(sweepMap->reducedGate[i] | v);
+				for (auto it = learned.begin(); it != learned.end(); ++it)
+				{
+					uint32_t imp = originalLiteral(*it);
+					if ((imp & GATE) != 0)
+					{
+						list.insert(imp);
+					}
+				}
+				break;
+			}
+			case SweepMerged:
+			{
+				uint32_t repImp = sweepMap->representative[i] | (sweepMap->inverted[i] ? v ^ VALUE : v);
+				list.insert(i | v);
+				list.insert(repImp);
+				(repImp & VALUE ? oneList[repImp & GATE] : zeroList[repImp & GATE]).insert(i | v);
+				break;
+			}
+			case SweepConstant:
+				if ((v != 0) == (bool) sweepMap->constant[i])
+				{
+					list.insert(i | v);
+				}
+				break;
+			default:
+				break;
+			}
+		}
+	}
+	//literals which can not occur
+	for (i = 1; i < numgates; i++)
+	{
+		for (int bit = 0; bit < 2; bit++)
+		{
+			uint32_t v = bit ? VALUE : 0;
+			if ((sweepMap->fate[i] == SweepKept && small->getDirectList(sweepMap->reducedGate[i] | v).empty())
+				|| (sweepMap->fate[i] == SweepConstant && (v != 0) != (bool) sweepMap->constant[i]))
+			{
+				(v ? oneList[i] : zeroList[i]).clear();
+			}
+		}
+	}
+	for (i = 1; i < numgates; i++)
+	{
+		for (int bit = 0; bit < 2; bit++)
+		{
+			uint32_t v = bit ? VALUE : 0;
+			if (sweepMap->fate[i] == SweepMerged)
+			{
+				uint32_t repImp = sweepMap->representative[i] | (sweepMap->inverted[i] ? v ^ VALUE : v);
+				if (getDirectList(repImp).empty())
+				{
+					(v ? oneList[i] : zeroList[i]).clear();
+				}
+			}
+		}
+	}
+	//the reduced circuit is only used for simulation from here on
+	for (i = 0; i < small->numgates; i++)
+	{
+		StoredImplicationList(small->zeroList[i].get_allocator()).swap(small->zeroList[i]);
+		StoredImplicationList(small->oneList[i].get_allocator()).swap(small->oneList[i]);
+	}
+}
+
+//adds imp to the all X reset state, so that later simulations start from it
+//and no longer report the gates it forces as implications
+void LogicSim::propagateConstant(uint32_t imp)
+{
+	int gate = imp & GATE;
+	unsigned value = (imp & VALUE) >> 31;
+	if (OrigGateValues[gate] == value)
+	{
+		return;
+	}
+	resetCircuit(ctx);
+	ctx->GateValues[gate] = value;
+	for (int i = 0; i < netlist->fanout[gate]; i++)
+	{
+		int successor = netlist->fnlist[gate][i];
+		if (ctx->sched[successor] == 0)
+		{
+			ctx->insertEvent(netlist->levelNum[successor], successor);
+			ctx->sched[successor] = 1;
+		}
+	}
+	numSimulations++;
+	ctx->goodsim(false);
+	for (int i = 0; i < numgates; i++)
+	{
+		OrigGateValues[i] = ctx->GateValues[i];
+	}
+	x_number_reset = ctx->x_number;
+	if (ternary != NULL)
+	{
+		ternary->setResetValues(OrigGateValues);
+	}
+}
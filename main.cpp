@@ -4,23 +4,221 @@
 // Description:	Main entry point for the gate implication simulator
 
 #include "circuit_repl.h"
+#include "implication_export.h"
+#include "query_server.h"
+#include "random_signatures.h"
+
+#include <thread>
 
 using namespace std;
 
+void printUsage()
+{
+	cerr << "Usage: GateImplicationSim [options] <circuit path>" << endl;
+	cerr << "Options:" << endl;
+	cerr << "  --server <socket>   serve queries on a Unix domain socket instead of starting the REPL" << endl;
+	cerr << "  --threads <n>       number of server worker threads (default: hardware threads)" << endl;
+	cerr << "  --sim-threads <n>   simulate wide levels of a vector on n threads (default: 1)" << endl;
+	cerr << "  --order <order>     learning order: gate (default), level, reverse, cone or priority" << endl;
+	cerr << "  --fixed-point       repeat learning until no implication list changes" << endl;
+	cerr << "  --sweep             learn on a copy without constant, equivalent or dead gates" << endl;
+	cerr << "  --prune             simulate only fanout stems and reconvergence points" << endl;
+	cerr << "  --clauses           propagate gate clauses first, simulating only where X values can reconverge" << endl;
+	cerr << "  --ternary           learn with plain 0/1/X simulation instead of X identities, faster" << endl;
+	cerr << "  --signatures [bits]  skip simulations that random pattern signatures show can find nothing (default: " << SIGNATURE_BITS << " patterns)" << endl;
+	cerr << "  --checkpoint <file> save learning progress to file every few minutes" << endl;
+	cerr << "  --checkpoint-interval <s>  seconds between checkpoints (default: " << CHECKPOINT_SECONDS << ")" << endl;
+	cerr << "  --resume <file>     continue learning from a checkpoint, and keep saving to it" << endl;
+	cerr << "  --time-budget <s>   stop learning after s seconds, keeping what was learned" << endl;
+	cerr << "  --memory-budget <MB>  stop learning once tracked memory reaches MB" << endl;
+	cerr << "  --max-iterations <n>  simulate each literal at most n times" << endl;
+	cerr << "  --spill <dir> <MB>  keep at most MB of implication lists in memory, spilling the rest to dir" << endl;
+	cerr << "  --shard <i/N> <file>  learn shard i (from 0) of N, write its lists to file and exit" << endl;
+	cerr << "  --eco <base> <db>   learn incrementally from baseline circuit <base> and its exported binary lists <db>" << endl;
+}
+
 int main(int argc, char *argv[])
 {
-	if ((argc != 2))
+	string circuitPath;
+	string socketPath;
+	string ecoCircuit, ecoLists;
+	string shardPath;
+	LearningOptions learning;
+	int numThreads = thread::hardware_concurrency();
+	int simThreads = 1;
+
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		if (arg == "--server" && i + 1 < argc)
+		{
+			socketPath = argv[++i];
+		}
+		else if (arg == "--eco" && i + 2 < argc)
+		{
+			ecoCircuit = argv[++i];
+			ecoLists = argv[++i];
+		}
+		else if (arg == "--order" && i + 1 < argc && LogicSim::parseLearningOrder(argv[i + 1], learning.order))
+		{
+			i++;
+		}
+		else if (arg == "--fixed-point")
+		{
+			learning.fixedPoint = true;
+		}
+		else if (arg == "--sweep")
+		{
+			learning.sweep = true;
+		}
+		else if ((arg == "--checkpoint" || arg == "--resume") && i + 1 < argc)
+		{
+			learning.checkpointPath = argv[++i];
+			learning.resume = learning.resume || arg == "--resume";
+		}
+		else if (arg == "--checkpoint-interval" && i + 1 < argc)
+		{
+			learning.checkpointSeconds = atoi(argv[++i]);
+		}
+		else if (arg == "--time-budget" && i + 1 < argc)
+		{
+			learning.timeBudgetMs = (int) (atof(argv[++i]) * 1000);
+		}
+		else if (arg == "--memory-budget" && i + 1 < argc)
+		{
+			learning.memoryBudgetBytes = (size_t) (atof(argv[++i]) * 1024 * 1024);
+		}
+		else if (arg == "--shard" && i + 2 < argc && sscanf(argv[i + 1], "%d/%d", &learning.shardIndex, &learning.numShards) == 2
+			&& learning.shardIndex >= 0 && learning.shardIndex < learning.numShards && learning.numShards <= 0xFFFF)
+		{
+			i++;
+			shardPath = argv[++i];
+		}
+		else if (arg == "--spill" && i + 2 < argc)
+		{
+			learning.spillDirectory = argv[++i];
+			learning.listMemoryBytes = (size_t) (atof(argv[++i]) * 1024 * 1024);
+		}
+		else if (arg == "--max-iterations" && i + 1 < argc)
+		{
+			learning.iterationCap = atoi(argv[++i]);
+		}
+		else if (arg == "--prune")
+		{
+			learning.prune = true;
+		}
+		else if (arg == "--clauses")
+		{
+			learning.clauses = true;
+		}
+		else if (arg == "--ternary")
+		{
+			learning.ternary = true;
+		}
+		else if (arg == "--signatures")
+		{
+			learning.signatureBits = SIGNATURE_BITS;
+			if (i + 1 < argc && isdigit(argv[i + 1][0]))
+			{
+				learning.signatureBits = atoi(argv[++i]);
+			}
+		}
+		else if (arg == "--sim-threads" && i + 1 < argc)
+		{
+			simThreads = atoi(argv[++i]);
+		}
+		else if (arg == "--threads" && i + 1 < argc)
+		{
+			numThreads = atoi(argv[++i]);
+		}
+		else if (arg[0] != '-' && circuitPath.empty())
+		{
+			circuitPath = arg;
+		}
+		else
+		{
+			printUsage();
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (circuitPath.empty())
 	{
 		cerr << "ERROR: Please Specify a circuit path as a command line argument to the program" << endl;
+		printUsage();
+		exit(EXIT_FAILURE);
+	}
+
+	if (!ecoCircuit.empty() && (!socketPath.empty() || !shardPath.empty()))
+	{
+		cerr << "ERROR: --eco can not be combined with --server or --shard" << endl;
 		exit(EXIT_FAILURE);
 	}
 
+	if (!socketPath.empty())
+	{
+		//load and learn once, then answer queries until killed
+		LogicSim sim(circuitPath, true, false);
+		sim.setLearningOptions(learning);
+		sim.generateImplicationLists();
+		QueryServer server(&sim, socketPath, numThreads);
+		server.run();
+		exit(EXIT_SUCCESS);
+	}
+
+	if (!shardPath.empty())
+	{
+		//a shard is a batch job, its lists are merged with the other shards' later
+		LogicSim sim(circuitPath, true, false);
+		sim.setLearningOptions(learning);
+		sim.generateImplicationLists();
+		ImplicationExporter exporter(&sim, numThreads);
+		exporter.setShard(learning.shardIndex, learning.numShards);
+		if (!exporter.exportLists(shardPath, ExportBinary, false))
+		{
+			cerr << "ERROR: Could not write shard lists to " << shardPath << endl;
+			exit(EXIT_FAILURE);
+		}
+		cout << "Wrote shard " << learning.shardIndex << " of " << learning.numShards << " to " << shardPath << endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	if (!ecoCircuit.empty())
+	{
+		//reuse the baseline's implications away from the edited gates
+		ImplicationReader baselineLists;
+		EcoReport report;
+		if (!Netlist::circuitExists(ecoCircuit) || !baselineLists.open(ecoLists))
+		{
+			cerr << "ERROR: Could not open baseline circuit " << ecoCircuit << " or implication lists " << ecoLists << endl;
+			exit(EXIT_FAILURE);
+		}
+		Netlist baseline(ecoCircuit);
+		LogicSim *sim = new LogicSim(circuitPath, true, false);
+		sim->setLearningOptions(learning);
+		if (!sim->incrementalUpdate(&baseline, baselineLists, report))
+		{
+			delete sim;
+			exit(EXIT_FAILURE);
+		}
+		sim->setSimulationThreads(simThreads);
+		cout << "ECO update: " << report.changedGates << " changed gates, " << report.affectedGates << " gates in their cones, "
+			<< report.keptLiterals << " literals reused, " << report.relearnedLiterals << " relearned in "
+			<< sim->elapsedMsDirect + sim->elapsedMsIndirect << " ms" << endl;
+		CircuitREPL repl(circuitPath, sim);
+		repl.startREPL();
+		exit(EXIT_SUCCESS);
+	}
+
 	//create a control REPL
-	CircuitREPL repl(argv[1]);
+	LogicSim *sim = new LogicSim(circuitPath, true, false);
+	sim->setLearningOptions(learning);
+	sim->generateImplicationLists();
+	sim->setSimulationThreads(simThreads);
+	CircuitREPL repl(circuitPath, sim);
 
 	//start the REPL
 	repl.startREPL();
 
 	//return
 	exit(EXIT_SUCCESS);
-}
\ No newline at end of file
+}
@@ -0,0 +1,180 @@
+// Filename:	memory_accounting.cpp
+// Description:	Process wide memory counters by subsystem
+
+#include "memory_accounting.h"
+
+//STL includes
+#include <algorithm>
+#include <atomic>
+
+//system includes
+#include <sys/resource.h>
+
+//a thread adds up what it allocates and releases, and only publishes the sum
+//to the shared counters once it reaches this many bytes either way, so
+//allocating list nodes does not contend on the counters
+#define MEMORY_BATCH_BYTES 16384
+
+//current and peak bytes of one subsystem, on a cache line of their own.
+//Current is signed: a thread may publish a release before another thread
+//has published the allocation
+struct alignas(64) MemoryCounter
+{
+	std::atomic<long long> current;
+	std::atomic<long long> peak;
+};
+
+static MemoryCounter counters[MemSubsystems];
+static MemoryCounter total;
+
+//bytes of each subsystem this thread has not published yet
+struct PendingBytes
+{
+	long long bytes[MemSubsystems];
+
+	PendingBytes();
+	~PendingBytes();	// publishes what is left when the thread exits
+};
+
+static thread_local PendingBytes pending;
+
+//raises peak to at least value
+static inline void raisePeak(std::atomic<long long> &peak, long long value)
+{
+	long long seen = peak.load(std::memory_order_relaxed);
+	while (value > seen && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+static void publish(MemorySubsystem subsystem, long long bytes)
+{
+	raisePeak(counters[subsystem].peak, counters[subsystem].current.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+	raisePeak(total.peak, total.current.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+PendingBytes::PendingBytes()
+{
+	for (int i = 0; i < MemSubsystems; i++)
+	{
+		bytes[i] = 0;
+	}
+}
+
+PendingBytes::~PendingBytes()
+{
+	for (int i = 0; i < MemSubsystems; i++)
+	{
+		if (bytes[i] != 0)
+		{
+			publish((MemorySubsystem) i, bytes[i]);
+		}
+	}
+}
+
+void memoryAllocated(MemorySubsystem subsystem, size_t bytes)
+{
+	long long &unpublished = pending.bytes[subsystem];
+	unpublished += bytes;
+	if (unpublished >= MEMORY_BATCH_BYTES)
+	{
+		publish(subsystem, unpublished);
+		unpublished = 0;
+	}
+}
+
+void memoryReleased(MemorySubsystem subsystem, size_t bytes)
+{
+	long long &unpublished = pending.bytes[subsystem];
+	unpublished -= bytes;
+	if (unpublished <= -MEMORY_BATCH_BYTES)
+	{
+		publish(subsystem, unpublished);
+		unpublished = 0;
+	}
+}
+
+size_t memoryCurrent(MemorySubsystem subsystem)
+{
+	return (size_t) std::max(counters[subsystem].current.load(std::memory_order_relaxed), 0LL);
+}
+
+size_t memoryPeak(MemorySubsystem subsystem)
+{
+	return (size_t) counters[subsystem].peak.load(std::memory_order_relaxed);
+}
+
+size_t memoryPeakTotal()
+{
+	return (size_t) total.peak.load(std::memory_order_relaxed);
+}
+
+const char * memorySubsystemName(MemorySubsystem subsystem)
+{
+	switch (subsystem)
+	{
+	case MemTopology:
+		return "topology";
+	case MemImplications:
+		return "implications";
+	case MemEventWheel:
+		return "event wheel";
+	case MemSimState:
+		return "simulation state";
+	default:
+		return "unknown";
+	}
+}
+
+size_t processPeakResident()
+{
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+	//kilobytes on Linux
+	return (size_t) usage.ru_maxrss * 1024;
+}
+
+////////////////////////////////////////////////////////////////////////
+// MemoryOwner class
+////////////////////////////////////////////////////////////////////////
+
+//threads are given stripes in the order they first count something
+static std::atomic<unsigned int> nextStripe;
+
+static inline unsigned int threadStripe()
+{
+	static thread_local unsigned int stripe = nextStripe.fetch_add(1, std::memory_order_relaxed) % MEMORY_OWNER_STRIPES;
+	return stripe;
+}
+
+MemoryOwner::MemoryOwner()
+{
+	for (int i = 0; i < MEMORY_OWNER_STRIPES; i++)
+	{
+		stripes[i].bytes = 0;
+	}
+}
+
+void MemoryOwner::allocated(size_t bytes)
+{
+	stripes[threadStripe()].bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void MemoryOwner::released(size_t bytes)
+{
+	stripes[threadStripe()].bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+//a release may be counted on another stripe than the allocation, only the sum is meaningful
+size_t MemoryOwner::current() const
+{
+	long long bytes = 0;
+	for (int i = 0; i < MEMORY_OWNER_STRIPES; i++)
+	{
+		bytes += stripes[i].bytes.load(std::memory_order_relaxed);
+	}
+	return (size_t) std::max(bytes, 0LL);
+}
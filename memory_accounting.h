@@ -0,0 +1,114 @@
+// Filename:	memory_accounting.h
+// Description:	Header file for process wide memory counters. Bytes are
+//				counted per subsystem as they are allocated and released,
+//				with the peak kept for each. STL containers are counted
+//				through CountingAllocator, other arrays by explicit calls.
+//				Each thread batches its changes, so the counters may lag
+//				behind by a few kilobytes per thread.
+
+#ifndef MEMORY_ACCOUNTING
+#define MEMORY_ACCOUNTING
+
+//STL includes
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+enum MemorySubsystem
+{
+	MemTopology,		// netlist arena
+	MemImplications,	// implication list nodes, buckets and list arrays
+	MemEventWheel,		// per level event lists and activation lists
+	MemSimState,		// gate values, schedule flags, saved states
+	MemSubsystems		// number of subsystems
+};
+
+void memoryAllocated(MemorySubsystem subsystem, size_t bytes);
+void memoryReleased(MemorySubsystem subsystem, size_t bytes);
+size_t memoryCurrent(MemorySubsystem subsystem);
+size_t memoryPeak(MemorySubsystem subsystem);
+//peak of the sum of all subsystems
+size_t memoryPeakTotal();
+const char * memorySubsystemName(MemorySubsystem subsystem);
+//peak resident set size of the process, as reported by the kernel
+size_t processPeakResident();
+
+//number of counters a MemoryOwner spreads its threads over
+#define MEMORY_OWNER_STRIPES 16
+
+////////////////////////////////////////////////////////////////////////
+// MemoryOwner class
+//	Bytes held by one owner, such as a circuit, on top of the process
+//	wide subsystem counters. Each thread counts on one of several
+//	counters on separate cache lines, so threads of the same owner do not
+//	contend, and reading the total sums them.
+////////////////////////////////////////////////////////////////////////
+class MemoryOwner
+{
+public:
+	MemoryOwner();
+	void allocated(size_t bytes);
+	void released(size_t bytes);
+	size_t current() const;
+
+private:
+	struct alignas(64) Stripe
+	{
+		std::atomic<long long> bytes;
+	};
+	Stripe stripes[MEMORY_OWNER_STRIPES];
+
+	MemoryOwner(const MemoryOwner &);
+	MemoryOwner & operator=(const MemoryOwner &);
+};
+
+////////////////////////////////////////////////////////////////////////
+// CountingAllocator class
+//	std::allocator which reports every allocation to one subsystem, and
+//	to an owner if it was given one. The owner moves with the container's
+//	contents on swaps and move assignments
+////////////////////////////////////////////////////////////////////////
+template <typename T, MemorySubsystem S>
+class CountingAllocator : public std::allocator<T>
+{
+public:
+	typedef T value_type;
+	typedef std::true_type propagate_on_container_move_assignment;
+	typedef std::true_type propagate_on_container_swap;
+	typedef std::false_type is_always_equal;
+	template <typename U>
+	struct rebind
+	{
+		typedef CountingAllocator<U, S> other;
+	};
+
+	CountingAllocator() : owner(NULL) {}
+	explicit CountingAllocator(MemoryOwner *memoryOwner) : owner(memoryOwner) {}
+	template <typename U>
+	CountingAllocator(const CountingAllocator<U, S> &other) : owner(other.owner) {}
+
+	T *allocate(size_t count)
+	{
+		memoryAllocated(S, count * sizeof(T));
+		if (owner != NULL)
+			owner->allocated(count * sizeof(T));
+		return std::allocator<T>::allocate(count);
+	}
+	void deallocate(T *p, size_t count)
+	{
+		memoryReleased(S, count * sizeof(T));
+		if (owner != NULL)
+			owner->released(count * sizeof(T));
+		std::allocator<T>::deallocate(p, count);
+	}
+
+	MemoryOwner *owner;
+};
+
+template <typename T, typename U, MemorySubsystem S>
+inline bool operator==(const CountingAllocator<T, S> &a, const CountingAllocator<U, S> &b) { return a.owner == b.owner; }
+template <typename T, typename U, MemorySubsystem S>
+inline bool operator!=(const CountingAllocator<T, S> &a, const CountingAllocator<U, S> &b) { return a.owner != b.owner; }
+
+#endif
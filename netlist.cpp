@@ -0,0 +1,366 @@
+// Filename:	netlist.cpp
+// Description:	Reads a *.lev gate level circuit into the read-only netlist
+//				structure shared by all simulation contexts
+
+///////////////////////////////////////////////////////////////////////
+//   Logic Simulator, written by Michael Hsiao
+//   Began in 1992, revisions and additions of functions till 2013
+///////////////////////////////////////////////////////////////////////
+
+#include "netlist.h"
+#include "lev_reader.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////
+// Netlist class
+////////////////////////////////////////////////////////////////////////
+
+// constructor: reads in the *.lev file for the gate-level ckt
+//	The file is tokenized once into flat staging vectors (see LevReader) so
+//	that the exact size of every topology array is known before anything is
+//	allocated. All of the arrays then come from a single arena, freed by
+//	the destructor. *.lev.gz and *.lev.zst files are read as well.
+Netlist::Netlist(string cktName)
+{
+	INIT0 = 0;				//don't initialize FF's
+	RESET_FF1 = NULL;
+	RESET_FF2 = NULL;
+
+    string fName;
+    int i;
+    LevReader reader;
+
+    // first pass: tokenize the circuit into the staging vectors
+    fName = LevReader::findFile(cktName);
+    if (fName.empty() || !reader.read(fName))
+    {
+	if (fName.empty())
+	    cerr << "Can't open .lev file\n";
+	exit(-1);
+    }
+
+    build(reader.count, reader.records, reader.lists);
+
+    if (INIT0)	// if start from a initial state
+    {
+	string state;
+	RESET_FF1 = arena->alloc<unsigned int>(numff+2);
+	RESET_FF2 = arena->alloc<unsigned int>(numff+2);
+
+	if (!readInitialState(cktName, state))
+	{	cerr << "Can't open " << cktName << ".initState\n";
+		exit(-1);}
+
+	for (i=0; i<numff; i++)
+	{
+	    if (state[i] == '0')
+	    {
+		RESET_FF1[i] = 0;
+		RESET_FF2[i] = 0;
+	    }
+	    else if (state[i] == '1')
+	    {
+		RESET_FF1[i] = ALLONES;
+		RESET_FF2[i] = ALLONES;
+	    }
+	    else 
+	    {
+		RESET_FF1[i] = 0;
+		RESET_FF2[i] = ALLONES;
+	    }
+	}
+    }
+}
+
+// constructor: builds a netlist from records in the staging layout used
+//	by the file reader (5 ints per gate, lists holding each gate's fanin
+//	then fanout ids), for circuits derived from another netlist
+Netlist::Netlist(int count, const vector<int> &records, const vector<int> &lists)
+{
+	INIT0 = 0;
+	RESET_FF1 = NULL;
+	RESET_FF2 = NULL;
+	build(count, records, lists);
+}
+
+// allocates the arena and fills in the topology from the staging vectors
+void Netlist::build(int count, const vector<int> &records, const vector<int> &lists)
+{
+    int i, j, netnum;
+    int levelSize[MAXlevels];
+    size_t totalFanin, totalFanout, bytes;
+
+    numpri = numgates = numout = maxlevels = numff = 0;
+    maxLevelSize = 32;
+    for (i=0; i<MAXlevels; i++)
+	levelSize[i] = 0;
+    totalFanin = totalFanout = 0;
+    for (size_t r=0; r<records.size(); r+=5)
+    {
+	levelSize[records[r+2]]++;
+	if (records[r+2] >= maxlevels)
+	    maxlevels = records[r+2] + 5;
+	totalFanin += records[r+3];
+	totalFanout += records[r+4];
+    }
+
+    // size the arena for every array the netlist owns
+    bytes = 2 * Arena::arenaBytes<unsigned char>(count+64) + 2 * Arena::arenaBytes<short>(count+64)
+	+ Arena::arenaBytes<int>(count+64) + Arena::arenaBytes<unsigned>(count+64)
+	+ 4 * Arena::arenaBytes<int *>(count+64) + Arena::arenaBytes<int>(512) + Arena::arenaBytes<int>(count+1)
+	+ 4 * Arena::arenaBytes<int>(1) * (count+64) + 2 * (totalFanin + totalFanout) * sizeof(int)
+	+ 32 * (Arena::arenaBytes<int>(2) + 3 * Arena::arenaBytes<int>(MAXFanout))
+	+ 2 * Arena::arenaBytes<unsigned int>(MAXFFS+2);
+    arena = new Arena(bytes);
+
+    // allocate space for gates
+    gtype = arena->alloc<unsigned char>(count+64);
+    evalClass = arena->alloc<unsigned char>(count+64);
+    fanin = arena->alloc<short>(count+64);
+    fanout = arena->alloc<short>(count+64);
+    levelNum = arena->alloc<int>(count+64);
+    po = arena->alloc<unsigned>(count+64);
+    inlist = arena->alloc<int *>(count+64);
+    fnlist = arena->alloc<int *>(count+64);
+    TIES = arena->alloc<int>(512);	//initialize array for ties
+
+    // second pass: build the topology from the staging vectors
+    numTieNodes = 0;
+    const int *list = lists.data();
+    for (size_t r=0; r<records.size(); r+=5)
+    {
+	netnum = records[r];
+	numgates++;
+	gtype[netnum] = (unsigned char) records[r+1];
+	levelNum[netnum] = records[r+2];
+	fanin[netnum] = (short) records[r+3];
+	fanout[netnum] = (short) records[r+4];
+
+	if (gtype[netnum] == T_input)
+	{
+	    inputs[numpri] = netnum;
+	    numpri++;
+	}
+	if (gtype[netnum] == T_dff)
+	{
+	    if (numff >= (MAXFFS-1))
+	    {
+		cerr << "The circuit has more than " << MAXFFS -1 << " FFs\n";
+		exit(-1);
+	    }
+	    ff_list[numff] = netnum;
+	    numff++;
+	}
+
+	inlist[netnum] = arena->alloc<int>(records[r+3]);
+	for (j=0; j<records[r+3]; j++)
+	    inlist[netnum][j] = *list++;
+
+	if (gtype[netnum] == T_output)
+	{
+	    po[netnum] = TRUE;
+	    outputs[numout] = netnum;
+	    numout++;
+	}
+	else
+	    po[netnum] = 0;
+
+	fnlist[netnum] = arena->alloc<int>(records[r+4]);
+	for (j=0; j<records[r+4]; j++)
+	    fnlist[netnum][j] = *list++;
+
+	if (gtype[netnum] == T_tie1 || gtype[netnum] == T_tie0)
+        {
+	    if (numTieNodes > 511)
+	    {
+		cerr << "Can't handle more than 512 tied nodes\n";
+		exit(-1);
+	    }
+	    TIES[numTieNodes] = netnum;
+	    numTieNodes++;
+        }
+    }	// for (r...)
+
+    numgates++;
+    numFaultFreeGates = numgates;
+
+    // now compute the maximum width of the level
+    for (i=0; i<maxlevels; i++)
+    {
+	if (levelSize[i] > maxLevelSize)
+	    maxLevelSize = levelSize[i] + 1;
+    }
+
+    // allocate space for the faulty gates
+    for (i = numgates; i < numgates+64; i+=2)
+    {
+        inlist[i] = arena->alloc<int>(2);
+        fnlist[i] = arena->alloc<int>(MAXFanout);
+        po[i] = 0;
+        fanin[i] = 2;
+        inlist[i][0] = i+1;
+    }
+
+    // pick the evaluator of each gate, ids without a gate are never simulated
+    for (i = 0; i < count+64; i++)
+	evalClass[i] = EvalGeneric;
+    for (size_t r=0; r<records.size(); r+=5)
+	evalClass[records[r]] = (unsigned char) classifyGate(gtype[records[r]], fanin[records[r]]);
+
+    ffMap = arena->alloc<int>(numgates);
+    // get the ffMap
+    for (i=0; i<numff; i++)
+	ffMap[ff_list[i]] = i;
+
+    setFaninoutMatrix();
+}
+
+// evaluator for a gate of type with fanin inputs
+int Netlist::classifyGate(int type, int fanin)
+{
+    int width = fanin - 2;	// offset of the 2 input class
+
+    switch (type)
+    {
+	case T_input:
+	case T_tie0:
+	case T_tie1:
+	case T_tieX:
+	case T_tieZ:
+	    return EvalHold;
+	case T_buf:
+	case T_dff:
+	case T_output:
+	    return EvalCopy;
+	case T_not:
+	    return EvalNot;
+	case T_xor:
+	    return fanin == 2 ? EvalXor2 : EvalGeneric;
+	case T_xnor:
+	    return fanin == 2 ? EvalXnor2 : EvalGeneric;
+	default:
+	    break;
+    }
+    if (width < 0 || width > 2)
+	return EvalGeneric;
+    switch (type)
+    {
+	case T_and:
+	    return EvalAnd2 + width;
+	case T_nand:
+	    return EvalNand2 + width;
+	case T_or:
+	    return EvalOr2 + width;
+	case T_nor:
+	    return EvalNor2 + width;
+	default:
+	    return EvalGeneric;
+    }
+}
+
+// reads the reset state from cktName.initState, one 0, 1 or X per FF in
+//	ff_list order (anything else, or a short file, leaves the FF at X)
+bool Netlist::readInitialState(string cktName, string &state) const
+{
+    ifstream yyin;
+    char c;
+    int i;
+
+    yyin.open((cktName + ".initState").c_str(), ios::in);
+    if (!yyin)
+	return false;
+
+    state.assign(numff, 'X');
+    for (i=0; i<numff && (yyin >> c); i++)
+    {
+	if (c == '0' || c == '1')
+	    state[i] = c;
+    }
+    yyin.close();
+    return true;
+}
+
+bool Netlist::circuitExists(string cktName)
+{
+    return !LevReader::findFile(cktName).empty();
+}
+
+//destructor, every array is released with the arena
+Netlist::~Netlist()
+{
+	delete arena;
+}
+
+////////////////////////////////////////////////////////////////////////
+// setFaninoutMatrix()
+//	This function builds the matrix of succOfPredOutput and 
+// predOfSuccInput.
+////////////////////////////////////////////////////////////////////////
+void Netlist::setFaninoutMatrix()
+{
+    int i, j, k;
+    int predecessor, successor;
+    int checked[MAXFanout];
+    int checkID;	// needed for gates with fanouts to SAME gate
+    int prevSucc, found;
+
+    predOfSuccInput = arena->alloc<int *>(numgates+64);
+    succOfPredOutput = arena->alloc<int *>(numgates+64);
+    for (i=0; i<MAXFanout; i++)
+	checked[i] = 0;
+    checkID = 1;
+
+    prevSucc = -1;
+    for (i=1; i<numgates; i++)
+    {
+	predOfSuccInput[i] = arena->alloc<int>(fanout[i]);
+	succOfPredOutput[i] = arena->alloc<int>(fanin[i]);
+
+	for (j=0; j<fanout[i]; j++)
+	{
+	    if (prevSucc != fnlist[i][j])
+		checkID++;
+	    prevSucc = fnlist[i][j];
+
+	    successor = fnlist[i][j];
+	    k=found=0;
+	    while ((k<fanin[successor]) && (!found))
+	    {
+		if ((inlist[successor][k] == i) && (checked[k] != checkID))
+		{
+		    predOfSuccInput[i][j] = k;
+		    checked[k] = checkID;
+		    found = 1;
+		}
+		k++;
+	    }
+	}
+
+	for (j=0; j<fanin[i]; j++)
+	{
+	    if (prevSucc != inlist[i][j])
+		checkID++;
+	    prevSucc = inlist[i][j];
+
+	    predecessor = inlist[i][j];
+	    k=found=0;
+	    while ((k<fanout[predecessor]) && (!found))
+	    {
+		if ((fnlist[predecessor][k] == i) && (checked[k] != checkID))
+		{
+		    succOfPredOutput[i][j] = k;
+		    checked[k] = checkID;
+		    found=1;
+		}
+		k++;
+	    }
+	}
+    }
+
+    for (i=numgates; i<numgates+64; i+=2)
+    {
+	predOfSuccInput[i] = arena->alloc<int>(MAXFanout);
+	succOfPredOutput[i] = arena->alloc<int>(MAXFanout);
+    }
+}
@@ -0,0 +1,173 @@
+// Filename:	netlist.h
+// Description:	Header file for the immutable gate level netlist. The netlist
+//				holds the circuit topology only, and is shared read-only by
+//				every simulation context created for the circuit.
+
+#ifndef NETLIST
+#define NETLIST
+
+//STL includes
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//user defined includes
+#include "arena.h"
+
+#define GATE 0x7FFFFFFF
+#define VALUE 0x80000000
+
+#define HZ 100
+#define RETURN '\n'
+#define EOS '\0'
+#define COMMA ','
+#define SPACE ' '
+#define TAB '\t'
+#define COLON ':'
+#define SEMICOLON ';'
+
+#define SPLITMERGE 'M'
+
+#define T_INPUT 1
+#define T_OUTPUT 2
+#define T_SIGNAL 3
+#define T_MODULE 4
+#define T_COMPONENT 5
+#define T_EXIST 9
+#define T_COMMENT 10
+#define T_END 11
+
+#define TABLESIZE 5000
+#define MAXIO 5000
+#define MAXMODULES 5000
+#define MAXDFF 10560
+
+#define GOOD 1
+#define FAULTY 2
+#define DONTCARE -1
+#define ALLONES 0xffffffff
+
+#define MAXlevels 10000
+#define MAXIOS 5120
+#define MAXFanout 10192
+#define MAXFFS 40048
+#define MAXGATES 100000
+#define MAXevents 100000
+
+#define TRUE 1
+#define FALSE 0
+
+#define EXCITED_1_LEVEL 1
+#define POTENTIAL 2
+#define LOW_DETECT 3
+#define HIGH_DETECT 4
+#define REDUNDANT 5
+
+enum
+{
+	JUNK,           /* 0 */
+	T_input,        /* 1 */
+	T_output,       /* 2 */
+	T_xor,          /* 3 */
+	T_xnor,         /* 4 */
+	T_dff,          /* 5 */
+	T_and,          /* 6 */
+	T_nand,         /* 7 */
+	T_or,           /* 8 */
+	T_nor,          /* 9 */
+	T_not,          /* 10 */
+	T_buf,          /* 11 */
+	T_tie1,         /* 12 */
+	T_tie0,         /* 13 */
+	T_tieX,         /* 14 */
+	T_tieZ,         /* 15 */
+	T_mux_2,        /* 16 */
+	T_bus,          /* 17 */
+	T_bus_gohigh,   /* 18 */
+	T_bus_golow,    /* 19 */
+	T_tristate,     /* 20 */
+	T_tristateinv,  /* 21 */
+	T_tristate1     /* 22 */
+};
+
+//evaluator chosen for each gate from its type and fanin count when the
+//netlist is built, so simulation dispatches once per gate (see
+//SimContext::evaluate). Gates of other types or widths are EvalGeneric
+enum EvalClass
+{
+	EvalGeneric,
+	EvalHold,		// inputs and ties keep their value
+	EvalCopy,		// buffers, FFs and outputs
+	EvalNot,
+	EvalAnd2, EvalAnd3, EvalAnd4,
+	EvalNand2, EvalNand3, EvalNand4,
+	EvalOr2, EvalOr3, EvalOr4,
+	EvalNor2, EvalNor3, EvalNor4,
+	EvalXor2, EvalXnor2
+};
+
+////////////////////////////////////////////////////////////////////////
+// Netlist class
+//	Read-only circuit topology. Nothing in here is modified once the
+//	constructor returns, so any number of SimContexts (one per thread)
+//	may reference the same Netlist concurrently.
+////////////////////////////////////////////////////////////////////////
+class Netlist
+{
+public:
+	Netlist(std::string cktName);	// constructor, reads in the *.lev file
+	Netlist(int count, const std::vector<int> &records, const std::vector<int> &lists);	// constructor from staging records
+	~Netlist();
+
+	//true if a circuit file for cktName can be opened
+	static bool circuitExists(std::string cktName);
+	//reads cktName.initState into state, one 0, 1 or X per FF, false if there is none
+	bool readInitialState(std::string cktName, std::string &state) const;
+
+	//bytes reserved for the topology arrays
+	size_t memoryBytes() const { return arena->capacity(); }
+
+	int numTieNodes;
+	int *TIES;
+	int INIT0;
+
+	// circuit information
+	int numgates;	// total number of gates (faulty included)
+	int numpri;		// number of PIs
+	int numff;		// number of FF's
+	int numFaultFreeGates;	// number of fault free gates
+	int numout;		// number of POs
+	int maxlevels;	// number of levels in gate level ckt
+	int maxLevelSize;	// maximum number of gates in one given level
+	int inputs[MAXIOS];
+	int outputs[MAXIOS];
+	int ff_list[MAXFFS];
+	int *ffMap;
+	unsigned char *gtype;// gate type
+	unsigned char *evalClass;	// EvalClass of each gate
+	short *fanin;		// number of fanin, fanouts
+	short *fanout;
+	int *levelNum;		// level number of gate
+	unsigned *po;
+	int **inlist;		// fanin list
+	int **fnlist;		// fanout list
+	int **predOfSuccInput;      // predecessor of successor input-pin list
+	int **succOfPredOutput;     // successor of predecessor output-pin list
+	unsigned int *RESET_FF1;	// value of reset ffs read from *.initState
+	unsigned int *RESET_FF2;	// value of reset ffs read from *.initState
+
+private:
+	void build(int count, const std::vector<int> &records, const std::vector<int> &lists);	// fills the arena from staging records
+	void setFaninoutMatrix();	// builds the fanin-out map matrix
+	static int classifyGate(int type, int fanin);	// EvalClass for a gate
+
+	//the netlist owns its arena, so it cannot be copied
+	Netlist(const Netlist &);
+	Netlist & operator=(const Netlist &);
+
+	Arena *arena;	// backing store for every array above
+};
+
+#endif
@@ -0,0 +1,380 @@
+// Filename:	netlist_sweep.cpp
+// Description:	Netlist reduction pass. Builds a smaller netlist with the
+//				same inputs and outputs from the constants and equivalences
+//				proven for the original one.
+
+#include "netlist_sweep.h"
+
+//STL includes
+#include <algorithm>
+#include <map>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////
+// NetlistSweep class
+////////////////////////////////////////////////////////////////////////
+
+NetlistSweep::NetlistSweep(const Netlist *circuit)
+{
+	ckt = circuit;
+	fate.assign(ckt->numgates, SweepKept);
+	reducedGate.assign(ckt->numgates, -1);
+	representative.resize(ckt->numgates);
+	inverted.assign(ckt->numgates, 0);
+	constant.assign(ckt->numgates, 0);
+	for (int i = 0; i < ckt->numgates; i++)
+	{
+		representative[i] = i;
+	}
+}
+
+//only plain combinational gates are removed, inputs, outputs and flip
+//flops always stay in place
+bool NetlistSweep::mergeable(int gate) const
+{
+	switch (ckt->gtype[gate])
+	{
+	case T_and:
+	case T_nand:
+	case T_or:
+	case T_nor:
+	case T_xor:
+	case T_xnor:
+	case T_not:
+	case T_buf:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void NetlistSweep::setConstant(int gate, int value)
+{
+	if (gate > 0 && gate < ckt->numgates && mergeable(gate) && fate[gate] == SweepKept)
+	{
+		fate[gate] = SweepConstant;
+		constant[gate] = value;
+	}
+}
+
+//representatives are never at a higher level than the gates they replace,
+//so rewiring a gate's fanouts to its representative can not form a loop
+bool NetlistSweep::setEquivalent(int gate, int rep, bool inv)
+{
+	if (gate <= 0 || gate >= ckt->numgates || rep <= 0 || rep >= ckt->numgates || gate == rep
+		|| !mergeable(gate) || fate[gate] != SweepKept || ckt->gtype[rep] == T_output)
+	{
+		return false;
+	}
+	if (ckt->levelNum[rep] > ckt->levelNum[gate] || (ckt->levelNum[rep] == ckt->levelNum[gate] && rep > gate))
+	{
+		return false;
+	}
+	fate[gate] = SweepMerged;
+	representative[gate] = rep;
+	inverted[gate] = inv;
+	return true;
+}
+
+void NetlistSweep::resolve(int gate, int &rep, bool &inv)
+{
+	rep = gate;
+	inv = false;
+	while (fate[rep] == SweepMerged)
+	{
+		inv = inv != (bool) inverted[rep];
+		rep = representative[rep];
+	}
+}
+
+//two gates of the same type reading the same signals are equivalent. Gates
+//are visited by level, so their inputs are already merged
+void NetlistSweep::hashStructure()
+{
+	vector<int> order;
+	map<vector<int>, int> seen;
+	vector<int> key;
+	int rep;
+	bool inv;
+
+	for (int i = 1; i < ckt->numgates; i++)
+	{
+		if (fate[i] == SweepKept && mergeable(i))
+		{
+			order.push_back(i);
+		}
+	}
+	stable_sort(order.begin(), order.end(), [this](int a, int b) { return ckt->levelNum[a] < ckt->levelNum[b]; });
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		int gate = order[i];
+		key.assign(1, ckt->gtype[gate]);
+		for (int j = 0; j < ckt->fanin[gate]; j++)
+		{
+			resolve(ckt->inlist[gate][j], rep, inv);
+			key.push_back(2 * rep + inv);
+		}
+		sort(key.begin() + 1, key.end());
+		auto found = seen.find(key);
+		if (found == seen.end())
+		{
+			seen[key] = gate;
+		}
+		else
+		{
+			setEquivalent(gate, found->second, false);
+		}
+	}
+}
+
+/*
+Merged gates are resolved to a kept or constant gate first. Liveness is then
+marked backwards from the outputs through the resolved inputs; a complemented
+input needs an inverter on its representative, which is an existing inverter
+on that gate where there is one, and constant inputs read one shared tie per
+value. Inputs are always kept. The survivors are numbered in original order,
+followed by the added ties and inverters, and levelized.
+*/
+Netlist * NetlistSweep::build(SweepReport &report)
+{
+	int numgates = ckt->numgates;
+	vector<char> live(numgates, 0);
+	vector<char> needInverter(numgates, 0);
+	vector<int> inverterOf(numgates, -1);	// original gate -> reduced id of its complement
+	vector<int> stack;
+	int needTie[2] = {0, 0};
+	int tieGate[2] = {-1, -1};	// reduced ids of the shared ties
+	int rep, i, j;
+	bool inv;
+
+	report.constants = report.merged = report.dead = report.inverters = 0;
+	report.originalGates = numgates - 1;
+
+	hashStructure();
+	for (i = 1; i < numgates; i++)
+	{
+		if (fate[i] == SweepMerged)
+		{
+			resolve(i, rep, inv);
+			if (fate[rep] == SweepConstant)
+			{
+				fate[i] = SweepConstant;
+				constant[i] = constant[rep] != inv;
+			}
+			else
+			{
+				representative[i] = rep;
+				inverted[i] = inv;
+			}
+		}
+	}
+
+	//mark everything the outputs depend on
+	for (i = 1; i < numgates; i++)
+	{
+		if (ckt->gtype[i] == T_output || ckt->gtype[i] == T_input)
+		{
+			live[i] = 1;
+			stack.push_back(i);
+		}
+	}
+	while (!stack.empty())
+	{
+		int gate = stack.back();
+		stack.pop_back();
+		for (j = 0; j < ckt->fanin[gate]; j++)
+		{
+			int input = ckt->inlist[gate][j];
+			inv = false;
+			if (fate[input] == SweepConstant)
+			{
+				needTie[constant[input]] = 1;
+				continue;
+			}
+			if (fate[input] == SweepMerged)
+			{
+				inv = inverted[input];
+				input = representative[input];
+			}
+			if (inv)
+			{
+				needInverter[input] = 1;
+			}
+			if (!live[input])
+			{
+				live[input] = 1;
+				stack.push_back(input);
+			}
+		}
+	}
+	//reuse an existing inverter for complemented inputs where possible
+	for (i = 1; i < numgates; i++)
+	{
+		if (!needInverter[i])
+		{
+			continue;
+		}
+		for (j = 0; j < ckt->fanout[i]; j++)
+		{
+			int successor = ckt->fnlist[i][j];
+			if (ckt->gtype[successor] == T_not && fate[successor] == SweepKept)
+			{
+				inverterOf[i] = successor;
+				live[successor] = 1;
+				break;
+			}
+		}
+	}
+
+	//number the survivors, then the added ties and inverters
+	originalGate.assign(1, -1);
+	for (i = 1; i < numgates; i++)
+	{
+		if (live[i] && fate[i] == SweepKept)
+		{
+			reducedGate[i] = originalGate.size();
+			originalGate.push_back(i);
+		}
+		else if (fate[i] == SweepKept)
+		{
+			fate[i] = SweepDead;
+		}
+		if (fate[i] == SweepConstant)
+			report.constants++;
+		else if (fate[i] == SweepMerged)
+			report.merged++;
+		else if (fate[i] == SweepDead)
+			report.dead++;
+	}
+	int count = originalGate.size();
+	for (i = 0; i < 2; i++)
+	{
+		if (needTie[i])
+		{
+			tieGate[i] = originalGate.size();
+			originalGate.push_back(SWEEP_TIE);
+		}
+	}
+	int firstInverter = originalGate.size();
+	vector<int> newInverterInput;	// original gate complemented by each added inverter
+	for (i = 1; i < numgates; i++)
+	{
+		if (!needInverter[i])
+		{
+			continue;
+		}
+		if (inverterOf[i] >= 0)
+		{
+			inverterOf[i] = reducedGate[inverterOf[i]];
+		}
+		else
+		{
+			inverterOf[i] = originalGate.size();
+			originalGate.push_back(SWEEP_INVERTER);
+			newInverterInput.push_back(i);
+			report.inverters++;
+		}
+	}
+	int total = originalGate.size();
+
+	//fanin lists of the reduced gates
+	vector<vector<int> > faninOf(total);
+	vector<int> type(total);
+	for (int r = 1; r < count; r++)
+	{
+		int gate = originalGate[r];
+		type[r] = ckt->gtype[gate];
+		for (j = 0; j < ckt->fanin[gate]; j++)
+		{
+			int input = ckt->inlist[gate][j];
+			if (fate[input] == SweepConstant)
+			{
+				faninOf[r].push_back(tieGate[constant[input]]);
+			}
+			else if (fate[input] == SweepMerged)
+			{
+				faninOf[r].push_back(inverted[input] ? inverterOf[representative[input]] : reducedGate[representative[input]]);
+			}
+			else
+			{
+				faninOf[r].push_back(reducedGate[input]);
+			}
+		}
+	}
+	for (i = 0; i < 2; i++)
+	{
+		if (tieGate[i] >= 0)
+		{
+			type[tieGate[i]] = i ? T_tie1 : T_tie0;
+		}
+	}
+	for (size_t k = 0; k < newInverterInput.size(); k++)
+	{
+		type[firstInverter + k] = T_not;
+		faninOf[firstInverter + k].push_back(reducedGate[newInverterInput[k]]);
+	}
+
+	//levelize, inputs, ties and flip flops start at level 0
+	vector<int> level(total, -1);
+	for (int r = 1; r < total; r++)
+	{
+		stack.push_back(r);
+		while (!stack.empty())
+		{
+			int gate = stack.back();
+			if (level[gate] >= 0)
+			{
+				stack.pop_back();
+				continue;
+			}
+			int maxLevel = -1;
+			bool ready = true;
+			if (type[gate] != T_dff)
+			{
+				for (size_t k = 0; k < faninOf[gate].size(); k++)
+				{
+					int input = faninOf[gate][k];
+					if (level[input] < 0)
+					{
+						ready = false;
+						stack.push_back(input);
+					}
+					else
+					{
+						maxLevel = max(maxLevel, level[input]);
+					}
+				}
+			}
+			if (ready)
+			{
+				level[gate] = maxLevel + 1;
+				stack.pop_back();
+			}
+		}
+	}
+
+	//records in the layout of the file reader
+	vector<vector<int> > fanoutList(total);
+	for (int r = 1; r < total; r++)
+	{
+		for (size_t k = 0; k < faninOf[r].size(); k++)
+		{
+			fanoutList[faninOf[r][k]].push_back(r);
+		}
+	}
+	vector<int> records;
+	vector<int> lists;
+	for (int r = 1; r < total; r++)
+	{
+		records.push_back(r);
+		records.push_back(type[r]);
+		records.push_back(level[r]);
+		records.push_back(faninOf[r].size());
+		records.push_back(fanoutList[r].size());
+		lists.insert(lists.end(), faninOf[r].begin(), faninOf[r].end());
+		lists.insert(lists.end(), fanoutList[r].begin(), fanoutList[r].end());
+	}
+	report.reducedGates = total - 1;
+	return new Netlist(total, records, lists);
+}
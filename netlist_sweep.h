@@ -0,0 +1,74 @@
+// Filename:	netlist_sweep.h
+// Description:	Header file for the netlist reduction pass. Constant gates
+//				become ties, equivalent and complementary gates are merged,
+//				logic which reaches no output is removed and the remaining
+//				gates are renumbered, keeping a map back to the original ids.
+
+#ifndef NETLIST_SWEEP
+#define NETLIST_SWEEP
+
+//STL includes
+#include <vector>
+
+//user defined includes
+#include "netlist.h"
+
+//original ids of gates added by the sweep
+#define SWEEP_INVERTER -1	// complement of its input
+#define SWEEP_TIE -2		// shared constant
+
+//what became of an original gate in the reduced netlist
+enum SweepFate
+{
+	SweepKept,		// present in the reduced netlist
+	SweepConstant,	// replaced by a tie
+	SweepMerged,	// replaced by its representative (or the complement of it)
+	SweepDead		// reaches no output, removed
+};
+
+struct SweepReport
+{
+	int originalGates;
+	int reducedGates;
+	int constants;		// gates turned into ties
+	int merged;			// gates replaced by an equivalent or complementary gate
+	int dead;			// gates removed because no output depends on them
+	int inverters;		// inverters added for complementary merges
+};
+
+////////////////////////////////////////////////////////////////////////
+// NetlistSweep class
+//	Collects constants and equivalences for a netlist, then builds the
+//	reduced netlist. Inputs and outputs keep their order, so vectors and
+//	output values are the same for both netlists.
+////////////////////////////////////////////////////////////////////////
+class NetlistSweep
+{
+public:
+	NetlistSweep(const Netlist *circuit);
+
+	//gate always takes value
+	void setConstant(int gate, int value);
+	//gate always equals rep (or its complement), rep must be at a lower or equal level
+	bool setEquivalent(int gate, int rep, bool inverted);
+	//builds the reduced netlist (caller owns it) and fills in the maps below
+	Netlist * build(SweepReport &report);
+
+	//per original gate
+	std::vector<unsigned char> fate;
+	std::vector<int> reducedGate;		// kept gates which reach an output: id in the reduced netlist
+	std::vector<int> representative;	// merged gates: the original gate they follow
+	std::vector<char> inverted;			// merged gates: complement of the representative
+	std::vector<unsigned char> constant;		// constant gates: their value
+	//per reduced gate, the original id (or SWEEP_INVERTER, SWEEP_TIE for added gates)
+	std::vector<int> originalGate;
+
+private:
+	void resolve(int gate, int &rep, bool &inv);	// follows merges to a kept or constant gate
+	void hashStructure();	// merges gates of one type with identical inputs
+	bool mergeable(int gate) const;
+
+	const Netlist *ckt;
+};
+
+#endif
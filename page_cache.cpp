@@ -0,0 +1,57 @@
+// Filename:	page_cache.cpp
+// Description:	Bounded least recently used cache of file pages
+
+#include "page_cache.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////
+// PageCache class
+////////////////////////////////////////////////////////////////////////
+
+PageCache::PageCache(size_t capacityBytes)
+{
+	capacity = capacityBytes;
+	hits = misses = 0;
+	used = 0;
+}
+
+PageCache::~PageCache()
+{
+	memoryReleased(MemImplications, used);
+}
+
+//the least recently used pages are dropped until the new one fits, the
+//newest page is kept even when it alone is over the capacity
+shared_ptr<const string> PageCache::get(uint64_t key, const function<bool(string &)> &load)
+{
+	lock_guard<mutex> guard(lock);
+	auto found = pages.find(key);
+	if (found != pages.end())
+	{
+		hits++;
+		order.splice(order.begin(), order, found->second.position);
+		return found->second.page;
+	}
+	misses++;
+	shared_ptr<string> page = make_shared<string>();
+	if (!load(*page))
+	{
+		return NULL;
+	}
+	while (!order.empty() && used + page->size() > capacity)
+	{
+		auto oldest = pages.find(order.back());
+		used -= oldest->second.page->size();
+		memoryReleased(MemImplications, oldest->second.page->size());
+		pages.erase(oldest);
+		order.pop_back();
+	}
+	order.push_front(key);
+	Entry &entry = pages[key];
+	entry.page = page;
+	entry.position = order.begin();
+	used += page->size();
+	memoryAllocated(MemImplications, page->size());
+	return page;
+}
@@ -0,0 +1,56 @@
+// Filename:	page_cache.h
+// Description:	Header file for a bounded, least recently used cache of file
+//				pages, shared by the readers of on-disk implication lists.
+
+#ifndef PAGE_CACHE
+#define PAGE_CACHE
+
+//STL includes
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+//user defined includes
+#include "memory_accounting.h"
+
+//bytes per page of an on-disk implication database
+#define PAGE_BYTES 65536
+
+////////////////////////////////////////////////////////////////////////
+// PageCache class
+//	Pages are keyed by the caller (file and page number) and loaded by a
+//	function it passes in, under the cache lock, so loads from one file
+//	never run concurrently. Page bytes count as implication memory. A
+//	page handed out stays valid while the caller holds it, even once it
+//	has been evicted.
+////////////////////////////////////////////////////////////////////////
+class PageCache
+{
+public:
+	PageCache(size_t capacityBytes);
+	~PageCache();
+
+	//the page for key, from the cache or loaded by load. NULL if load fails
+	std::shared_ptr<const std::string> get(uint64_t key, const std::function<bool(std::string &)> &load);
+
+	size_t capacity;
+	long hits, misses;
+
+private:
+	struct Entry
+	{
+		std::shared_ptr<const std::string> page;
+		std::list<uint64_t>::iterator position;	// place in the use order
+	};
+
+	std::mutex lock;
+	std::unordered_map<uint64_t, Entry> pages;
+	std::list<uint64_t> order;	// most recently used first
+	size_t used;
+};
+
+#endif
@@ -0,0 +1,271 @@
+// Filename:	perf_counters.cpp
+// Description:	Per phase performance counters read through perf_event_open
+
+#include "perf_counters.h"
+
+//STL includes
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+//system includes
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static std::atomic<uint64_t> phaseCounts[PerfPhases][PerfEvents];
+static std::atomic<uint64_t> phaseNs[PerfPhases];
+static std::atomic<long> phaseScopes[PerfPhases];
+static std::atomic<bool> eventSupported[PerfEvents];
+static std::mutex reasonLock;
+static std::string unavailableReason;
+
+//the events of one thread, opened as a group led by the task clock so that
+//all of them run over the same intervals and are read in one call
+struct ThreadCounters
+{
+	int fds[PerfEvents];
+	int slot[PerfEvents];	// position in a group read, -1 if not counted
+	int members;
+	int depth;				// scopes open on the thread
+
+	ThreadCounters();
+	~ThreadCounters();
+	bool read(uint64_t *values);
+};
+
+#ifdef __linux__
+static int openEvent(PerfEvent event, int leader)
+{
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = event == PerfTaskClock ? PERF_TYPE_SOFTWARE : PERF_TYPE_HARDWARE;
+	switch (event)
+	{
+	case PerfTaskClock:
+		attr.config = PERF_COUNT_SW_TASK_CLOCK;
+		break;
+	case PerfCycles:
+		attr.config = PERF_COUNT_HW_CPU_CYCLES;
+		break;
+	case PerfInstructions:
+		attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+		break;
+	case PerfCacheMisses:
+		attr.config = PERF_COUNT_HW_CACHE_MISSES;
+		break;
+	default:
+		attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+		break;
+	}
+	//user space only, which perf_event_paranoid up to 2 allows for the own process
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP;
+	return (int) syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+}
+#endif
+
+ThreadCounters::ThreadCounters()
+{
+	members = 0;
+	depth = 0;
+	for (int i = 0; i < PerfEvents; i++)
+	{
+		fds[i] = slot[i] = -1;
+	}
+#ifdef __linux__
+	for (int i = 0; i < PerfEvents; i++)
+	{
+		if (i > 0 && fds[PerfTaskClock] < 0)
+		{
+			break;
+		}
+		fds[i] = openEvent((PerfEvent) i, i == 0 ? -1 : fds[PerfTaskClock]);
+		if (fds[i] >= 0)
+		{
+			slot[i] = members++;
+			eventSupported[i] = true;
+			continue;
+		}
+		if (i == PerfCycles)
+		{
+			std::lock_guard<std::mutex> lock(reasonLock);
+			if (unavailableReason.empty())
+			{
+				unavailableReason = strerror(errno);
+				if (errno == EACCES || errno == EPERM)
+					unavailableReason += " (see /proc/sys/kernel/perf_event_paranoid)";
+				else if (errno == ENOENT || errno == EOPNOTSUPP)
+					unavailableReason += " (no hardware counters, e.g. in a virtual machine)";
+			}
+		}
+	}
+	if (fds[PerfTaskClock] < 0)
+	{
+		std::lock_guard<std::mutex> lock(reasonLock);
+		if (unavailableReason.empty())
+			unavailableReason = std::string("perf_event_open failed: ") + strerror(errno);
+	}
+#else
+	std::lock_guard<std::mutex> lock(reasonLock);
+	if (unavailableReason.empty())
+		unavailableReason = "perf_event_open is only available on Linux";
+#endif
+}
+
+ThreadCounters::~ThreadCounters()
+{
+#ifdef __linux__
+	for (int i = PerfEvents - 1; i >= 0; i--)
+	{
+		if (fds[i] >= 0)
+		{
+			close(fds[i]);
+		}
+	}
+#endif
+}
+
+bool ThreadCounters::read(uint64_t *values)
+{
+	uint64_t buffer[PerfEvents + 1];
+
+	for (int i = 0; i < PerfEvents; i++)
+	{
+		values[i] = 0;
+	}
+#ifdef __linux__
+	if (members == 0 || ::read(fds[PerfTaskClock], buffer, sizeof(buffer)) < (ssize_t) ((members + 1) * sizeof(uint64_t)))
+	{
+		return false;
+	}
+	for (int i = 0; i < PerfEvents; i++)
+	{
+		if (slot[i] >= 0)
+		{
+			values[i] = buffer[slot[i] + 1];
+		}
+	}
+	return true;
+#else
+	(void) buffer;
+	return false;
+#endif
+}
+
+static ThreadCounters & threadCounters()
+{
+	static thread_local ThreadCounters counters;
+	return counters;
+}
+
+bool perfCountersAvailable()
+{
+	return eventSupported[PerfCycles];
+}
+
+const char * perfUnavailableReason()
+{
+	std::lock_guard<std::mutex> lock(reasonLock);
+	//set once and never changed, so the pointer stays valid
+	return unavailableReason.c_str();
+}
+
+bool perfEventSupported(PerfEvent event)
+{
+	return eventSupported[event];
+}
+
+PerfTotals perfTotals(PerfPhase phase)
+{
+	PerfTotals totals;
+	for (int i = 0; i < PerfEvents; i++)
+	{
+		totals.counts[i] = phaseCounts[phase][i].load(std::memory_order_relaxed);
+	}
+	totals.ms = phaseNs[phase].load(std::memory_order_relaxed) / 1e6;
+	totals.scopes = phaseScopes[phase].load(std::memory_order_relaxed);
+	return totals;
+}
+
+const char * perfPhaseName(PerfPhase phase)
+{
+	switch (phase)
+	{
+	case PerfLoad:
+		return "load";
+	case PerfDirect:
+		return "direct";
+	case PerfIndirect:
+		return "indirect";
+	case PerfQuery:
+		return "query";
+	case PerfSimulation:
+		return "simulation";
+	default:
+		return "unknown";
+	}
+}
+
+const char * perfEventName(PerfEvent event)
+{
+	switch (event)
+	{
+	case PerfTaskClock:
+		return "taskClockNs";
+	case PerfCycles:
+		return "cycles";
+	case PerfInstructions:
+		return "instructions";
+	case PerfCacheMisses:
+		return "cacheMisses";
+	case PerfBranchMisses:
+		return "branchMisses";
+	default:
+		return "unknown";
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// PerfScope class
+////////////////////////////////////////////////////////////////////////
+
+PerfScope::PerfScope(PerfPhase phase)
+{
+	ThreadCounters &counters = threadCounters();
+	this->phase = phase;
+	outer = counters.depth++ == 0;
+	if (outer)
+	{
+		startTime = std::chrono::steady_clock::now();
+		counters.read(start);
+	}
+}
+
+PerfScope::~PerfScope()
+{
+	ThreadCounters &counters = threadCounters();
+	uint64_t end[PerfEvents];
+
+	counters.depth--;
+	if (!outer)
+	{
+		return;
+	}
+	if (counters.read(end))
+	{
+		for (int i = 0; i < PerfEvents; i++)
+		{
+			phaseCounts[phase][i].fetch_add(end[i] - start[i], std::memory_order_relaxed);
+		}
+	}
+	phaseNs[phase].fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count(),
+		std::memory_order_relaxed);
+	phaseScopes[phase].fetch_add(1, std::memory_order_relaxed);
+}
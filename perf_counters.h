@@ -0,0 +1,73 @@
+// Filename:	perf_counters.h
+// Description:	Header file for process wide hardware performance counters.
+//				Cycles, instructions, cache misses and branch misses are
+//				read through perf_event_open at the start and end of each
+//				major phase and added up per phase, so a slow phase can be
+//				judged by IPC and miss rates without running perf.
+
+#ifndef PERF_COUNTERS
+#define PERF_COUNTERS
+
+//STL includes
+#include <chrono>
+#include <cstdint>
+
+enum PerfPhase
+{
+	PerfLoad,			// reading the netlist
+	PerfDirect,			// direct implications
+	PerfIndirect,		// learning by simulation
+	PerfQuery,			// closure queries
+	PerfSimulation,		// vector and sequence simulation batches
+	PerfPhases			// number of phases
+};
+
+enum PerfEvent
+{
+	PerfTaskClock,		// CPU time in ns, a software counter
+	PerfCycles,
+	PerfInstructions,
+	PerfCacheMisses,	// last level cache
+	PerfBranchMisses,
+	PerfEvents			// number of events
+};
+
+struct PerfTotals
+{
+	uint64_t counts[PerfEvents];
+	double ms;		// wall time, summed over the threads in the phase
+	long scopes;	// times the phase was entered
+};
+
+//true if the hardware counters could be opened on some thread
+bool perfCountersAvailable();
+//why they could not be, empty while no thread has tried
+const char * perfUnavailableReason();
+//true if the event could be opened, its counts are 0 otherwise
+bool perfEventSupported(PerfEvent event);
+PerfTotals perfTotals(PerfPhase phase);
+const char * perfPhaseName(PerfPhase phase);
+const char * perfEventName(PerfEvent event);
+
+////////////////////////////////////////////////////////////////////////
+// PerfScope class
+//	Counts the calling thread from construction to destruction towards
+//	one phase. The counters of a thread are opened by its first scope and
+//	stay open until it exits. A scope entered while another is open on
+//	the same thread counts towards the outer one, and work handed to
+//	other threads counts only where they open scopes of their own.
+////////////////////////////////////////////////////////////////////////
+class PerfScope
+{
+public:
+	PerfScope(PerfPhase phase);
+	~PerfScope();
+
+private:
+	PerfPhase phase;
+	bool outer;
+	uint64_t start[PerfEvents];
+	std::chrono::steady_clock::time_point startTime;
+};
+
+#endif
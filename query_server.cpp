@@ -0,0 +1,361 @@
+// Filename:	query_server.cpp
+// Description:	A long running server which answers gate implication queries
+//				over a Unix domain socket, using a pool of worker threads on
+//				top of the shared, read-only implication lists.
+
+#include "query_server.h"
+#include "perf_counters.h"
+
+//system includes
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//constructor, binds the socket and creates a context per worker
+QueryServer::QueryServer(LogicSim *simulator, std::string socketPath, int numThreads)
+	: pool(numThreads)
+{
+	struct sockaddr_un addr;
+
+	sim = simulator;
+	netlist = sim->getNetlist();
+	path = socketPath;
+	for (int i = 0; i < pool.size(); i++)
+	{
+		contexts.push_back(sim->createContext());
+	}
+
+	if (path.length() >= sizeof(addr.sun_path))
+	{
+		std::cerr << "ERROR: Socket path too long: " << path << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listenFd < 0)
+	{
+		std::cerr << "ERROR: Could not create socket: " << strerror(errno) << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+	unlink(path.c_str());
+	if (bind(listenFd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(listenFd, 128) < 0)
+	{
+		std::cerr << "ERROR: Could not listen on " << path << ": " << strerror(errno) << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	if (pipe(wakePipe) < 0)
+	{
+		std::cerr << "ERROR: Could not create wake pipe: " << strerror(errno) << std::endl;
+		exit(EXIT_FAILURE);
+	}
+}
+
+QueryServer::~QueryServer()
+{
+	for (auto it = connections.begin(); it != connections.end(); ++it)
+	{
+		close(it->first);
+		delete it->second;
+	}
+	close(listenFd);
+	close(wakePipe[0]);
+	close(wakePipe[1]);
+	unlink(path.c_str());
+	for (size_t i = 0; i < contexts.size(); i++)
+	{
+		delete contexts[i];
+	}
+}
+
+/*
+The poll loop only ever reads. When a connection has one or more complete
+request lines buffered, it is handed to the pool and removed from the poll
+set until the worker has written every response, which keeps responses in
+request order without any per-request bookkeeping.
+*/
+void QueryServer::run()
+{
+	std::vector<struct pollfd> fds;
+	std::vector<Connection *> polled;
+	char buffer[65536];
+
+	std::cout << "Serving " << contexts.size() << " worker threads on " << path << std::endl;
+	while (true)
+	{
+		fds.clear();
+		polled.clear();
+		fds.push_back({ listenFd, POLLIN, 0 });
+		fds.push_back({ wakePipe[0], POLLIN, 0 });
+		for (auto it = connections.begin(); it != connections.end(); ++it)
+		{
+			if (!it->second->busy)
+			{
+				fds.push_back({ it->first, POLLIN, 0 });
+				polled.push_back(it->second);
+			}
+		}
+		if (poll(fds.data(), fds.size(), -1) < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			std::cerr << "ERROR: poll failed: " << strerror(errno) << std::endl;
+			return;
+		}
+
+		//connections handed back by the workers
+		if (fds[1].revents & POLLIN)
+		{
+			std::vector<Connection *> done;
+			read(wakePipe[0], buffer, sizeof(buffer));
+			{
+				std::lock_guard<std::mutex> guard(finishedLock);
+				done.swap(finished);
+			}
+			for (size_t i = 0; i < done.size(); i++)
+			{
+				done[i]->busy = false;
+				if (done[i]->closing)
+				{
+					closeConnection(done[i]);
+				}
+			}
+		}
+
+		//new clients
+		if (fds[0].revents & POLLIN)
+		{
+			int clientFd = accept(listenFd, NULL, NULL);
+			if (clientFd >= 0)
+			{
+				Connection *conn = new Connection;
+				conn->fd = clientFd;
+				conn->busy = false;
+				conn->closing = false;
+				connections[clientFd] = conn;
+			}
+		}
+
+		//requests from existing clients
+		for (size_t i = 0; i < polled.size(); i++)
+		{
+			Connection *conn = polled[i];
+			if (!(fds[i + 2].revents & (POLLIN | POLLHUP | POLLERR)))
+			{
+				continue;
+			}
+			ssize_t count = read(conn->fd, buffer, sizeof(buffer));
+			if (count <= 0)
+			{
+				//hang up, but still answer anything already complete
+				conn->closing = true;
+			}
+			else
+			{
+				conn->input.append(buffer, count);
+			}
+			if (conn->input.find('\n') != std::string::npos)
+			{
+				conn->busy = true;
+				pool.submit([this, conn](int worker) { serveConnection(conn, worker); });
+			}
+			else if (conn->closing)
+			{
+				closeConnection(conn);
+			}
+		}
+	}
+}
+
+void QueryServer::serveConnection(Connection *conn, int worker)
+{
+	std::string output;
+	size_t start = 0;
+	size_t end;
+	//answer every complete line, leave a trailing partial line buffered
+	while ((end = conn->input.find('\n', start)) != std::string::npos)
+	{
+		std::string line = conn->input.substr(start, end - start);
+		start = end + 1;
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+		if (line == "quit")
+		{
+			conn->closing = true;
+			break;
+		}
+		output += handleRequest(line, worker);
+		output += '\n';
+	}
+	conn->input.erase(0, start);
+
+	//blocking write of all responses for this batch
+	size_t written = 0;
+	while (written < output.length())
+	{
+		ssize_t count = send(conn->fd, output.data() + written, output.length() - written, MSG_NOSIGNAL);
+		if (count <= 0)
+		{
+			if (count < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			conn->closing = true;
+			break;
+		}
+		written += count;
+	}
+	connectionDone(conn);
+}
+
+void QueryServer::connectionDone(Connection *conn)
+{
+	char wake = 1;
+	{
+		std::lock_guard<std::mutex> guard(finishedLock);
+		finished.push_back(conn);
+	}
+	write(wakePipe[1], &wake, 1);
+}
+
+void QueryServer::closeConnection(Connection *conn)
+{
+	connections.erase(conn->fd);
+	close(conn->fd);
+	delete conn;
+}
+
+std::string QueryServer::handleRequest(const std::string &line, int worker)
+{
+	size_t commandIndex = line.find(' ');
+	std::string command = line.substr(0, commandIndex);
+	std::string args;
+	if (commandIndex != std::string::npos)
+	{
+		args = line.substr(commandIndex + 1);
+	}
+
+	if (command == "imp")
+		return handleImplication(args);
+	if (command == "gate")
+		return handleGate(args);
+	if (command == "sim")
+		return handleSim(args, worker);
+	if (command == "stats")
+		return handleStats();
+	if (command == "ckt")
+	{
+		return "OK " + std::to_string(netlist->numFaultFreeGates) + " " + std::to_string(netlist->numpri) + " "
+			+ std::to_string(netlist->numout) + " " + std::to_string(netlist->numff);
+	}
+	return "ERR unknown command";
+}
+
+std::string QueryServer::handleImplication(const std::string &args)
+{
+	ImplicationList selectedList;
+	int gateNum;
+	int impVal;
+	std::string response;
+	try
+	{
+		size_t spaceIndex;
+		gateNum = std::stoi(args, &spaceIndex);
+		impVal = std::stoi(args.substr(spaceIndex));
+	}
+	catch (std::exception &ex)
+	{
+		return "ERR invalid command format";
+	}
+	if (gateNum >= sim->numgates || gateNum < 1)
+	{
+		return "ERR invalid gate number";
+	}
+	if (impVal != 0 && impVal != 1)
+	{
+		return "ERR invalid implication value";
+	}
+	{
+		PerfScope scope(PerfQuery);
+		sim->buildImplicationList(impVal ? (gateNum | VALUE) : gateNum, selectedList);
+	}
+	response = "OK " + std::to_string(selectedList.size());
+	for (auto it = selectedList.begin(); it != selectedList.end(); ++it)
+	{
+		response += ' ';
+		response += std::to_string(2 * (*it & GATE) + ((*it & VALUE) >> 31));
+	}
+	return response;
+}
+
+std::string QueryServer::handleGate(const std::string &args)
+{
+	int gateNum;
+	std::string response;
+	try
+	{
+		gateNum = std::stoi(args);
+	}
+	catch (std::exception &ex)
+	{
+		return "ERR invalid command format";
+	}
+	if (gateNum >= sim->numgates || gateNum < 1)
+	{
+		return "ERR invalid gate number";
+	}
+	response = "OK " + std::to_string(netlist->gtype[gateNum]) + " " + std::to_string(netlist->fanin[gateNum]);
+	for (int i = 0; i < netlist->fanin[gateNum]; i++)
+	{
+		response += " " + std::to_string(netlist->inlist[gateNum][i]);
+	}
+	response += " " + std::to_string(netlist->fanout[gateNum]);
+	for (int i = 0; i < netlist->fanout[gateNum]; i++)
+	{
+		response += " " + std::to_string(netlist->fnlist[gateNum][i]);
+	}
+	return response;
+}
+
+std::string QueryServer::handleSim(const std::string &args, int worker)
+{
+	std::vector<char> vector;
+	for (size_t i = 0; i < args.length(); i++)
+	{
+		if (args[i] == '0' || args[i] == '1' || args[i] == 'x' || args[i] == 'X')
+		{
+			vector.push_back(args[i]);
+		}
+		else if (args[i] != ' ')
+		{
+			return "ERR bad input value";
+		}
+	}
+	if ((int) vector.size() < sim->numpri)
+	{
+		return "ERR too few values";
+	}
+	if ((int) vector.size() > sim->numpri)
+	{
+		return "ERR too many values";
+	}
+	PerfScope scope(PerfSimulation);
+	contexts[worker]->applyVector(vector.data());
+	contexts[worker]->goodsim(false);
+	return "OK " + contexts[worker]->outputValues();
+}
+
+std::string QueryServer::handleStats()
+{
+	return "OK " + std::to_string(sim->numIndirectImplications) + " " + std::to_string(sim->fixedNodeCounter) + " "
+		+ std::to_string(sim->numSimulations) + " " + std::to_string((long) sim->elapsedMsDirect) + " "
+		+ std::to_string((long) sim->elapsedMsIndirect);
+}
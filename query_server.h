@@ -0,0 +1,76 @@
+// Filename:	query_server.h
+// Description:	Header file for the local query server. The server keeps one
+//				learned circuit in memory and answers implication, gate,
+//				simulation and statistics requests over a Unix domain socket.
+
+#ifndef QUERY_SERVER
+#define QUERY_SERVER
+
+//user defined includes
+#include "logic_sim.h"
+#include "thread_pool.h"
+
+//STL includes
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+Protocol: one request per line, one response line per request, answered in
+the order received. Clients may pipeline any number of requests.
+
+	imp <gate> <value>	-> OK <n> <lit> ... (lit = 2*gate + value, n = 0 if unreachable)
+	gate <gate>			-> OK <type> <nfanin> <in> ... <nfanout> <out> ...
+	sim <vector>		-> OK <PO values>
+	stats				-> OK <implications> <fixed> <simulations> <direct ms> <indirect ms>
+	ckt					-> OK <gates> <PIs> <POs> <FFs>
+	quit				-> closes the connection
+
+Malformed requests get ERR <reason>.
+*/
+class QueryServer
+{
+public:
+	QueryServer(LogicSim *simulator, std::string socketPath, int numThreads);
+	~QueryServer();
+	//accepts and serves clients until the process is stopped
+	void run();
+
+private:
+	struct Connection
+	{
+		int fd;
+		std::string input;	// bytes received but not yet handled
+		bool busy;			// a worker currently owns the connection
+		bool closing;		// client asked to quit or hung up
+	};
+
+	//handles every complete line buffered on a connection (runs on a worker)
+	void serveConnection(Connection *conn, int worker);
+	//returns the response line for a single request
+	std::string handleRequest(const std::string &line, int worker);
+	std::string handleImplication(const std::string &args);
+	std::string handleGate(const std::string &args);
+	std::string handleSim(const std::string &args, int worker);
+	std::string handleStats();
+	//wakes the poll loop after a worker finishes with a connection
+	void connectionDone(Connection *conn);
+	void closeConnection(Connection *conn);
+
+	LogicSim *sim;
+	const Netlist *netlist;
+	std::string path;
+	int listenFd;
+	int wakePipe[2];
+
+	ThreadPool pool;
+	//one simulation context per worker thread
+	std::vector<SimContext *> contexts;
+
+	std::map<int, Connection *> connections;
+	std::vector<Connection *> finished;
+	std::mutex finishedLock;
+};
+
+#endif
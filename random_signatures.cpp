@@ -0,0 +1,250 @@
+// Filename:	random_signatures.cpp
+// Description:	Bit parallel random pattern simulation, and an index of the
+//				literals which hold in each pattern
+
+#include "random_signatures.h"
+
+//STL includes
+#include <algorithm>
+#include <random>
+
+using namespace std;
+
+#define WORD_ONES (~(uint64_t) 0)
+
+////////////////////////////////////////////////////////////////////////
+// RandomSignatures class
+////////////////////////////////////////////////////////////////////////
+
+RandomSignatures::RandomSignatures(const Netlist *netlist, int bits)
+{
+	vector<int> order;
+	mt19937_64 random(1);
+	int gateN, w;
+
+	ckt = netlist;
+	numWords = (max(1, min(bits, MAX_SIGNATURE_BITS)) + 63) / 64;
+	isUsable = ckt->numff == 0;
+	numEquivalentGates = numEquivalenceClasses = 0;
+	values.assign((size_t) ckt->numgates * numWords, 0);
+	literalWords = (2 * ckt->numgates + 63) / 64;
+
+	for (gateN = 1; gateN < ckt->numgates; gateN++)
+	{
+		order.push_back(gateN);
+	}
+	stable_sort(order.begin(), order.end(), [this](int a, int b) { return ckt->levelNum[a] < ckt->levelNum[b]; });
+	for (size_t k = 0; k < order.size() && isUsable; k++)
+	{
+		gateN = order[k];
+		uint64_t *out = &values[(size_t) gateN * numWords];
+		int count = ckt->fanin[gateN];
+		for (w = 0; w < numWords; w++)
+		{
+			uint64_t value;
+			switch (ckt->gtype[gateN])
+			{
+			case JUNK:
+			case T_tie0:
+				value = 0;
+				break;
+			case T_tie1:
+				value = WORD_ONES;
+				break;
+			case T_input:
+			case T_tieX:
+			case T_tieZ:
+				value = random();
+				break;
+			case T_and:
+			case T_nand:
+				value = WORD_ONES;
+				for (int i = 0; i < count; i++)
+				{
+					value &= values[(size_t) ckt->inlist[gateN][i] * numWords + w];
+				}
+				break;
+			case T_or:
+			case T_nor:
+				value = 0;
+				for (int i = 0; i < count; i++)
+				{
+					value |= values[(size_t) ckt->inlist[gateN][i] * numWords + w];
+				}
+				break;
+			case T_xor:
+			case T_xnor:
+				value = 0;
+				for (int i = 0; i < count; i++)
+				{
+					value ^= values[(size_t) ckt->inlist[gateN][i] * numWords + w];
+				}
+				break;
+			case T_not:
+			case T_buf:
+			case T_output:
+				value = values[(size_t) ckt->inlist[gateN][0] * numWords + w];
+				break;
+			default:
+				isUsable = false;
+				value = 0;
+				break;
+			}
+			switch (ckt->gtype[gateN])
+			{
+			case T_nand:
+			case T_nor:
+			case T_xnor:
+			case T_not:
+				value = ~value;
+				break;
+			default:
+				break;
+			}
+			out[w] = value;
+		}
+	}
+	stateBytes = values.size() * sizeof(uint64_t);
+	memoryAllocated(MemSimState, stateBytes);
+}
+
+RandomSignatures::~RandomSignatures()
+{
+	memoryReleased(MemSimState, stateBytes + rows.size() * sizeof(uint64_t));
+}
+
+uint64_t RandomSignatures::literalWord(uint32_t literal, int word) const
+{
+	uint64_t value = values[(size_t) (literal >> 1) * numWords + word];
+	return (literal & 1) ? value : ~value;
+}
+
+bool RandomSignatures::contains(uint32_t inner, uint32_t outer) const
+{
+	for (int w = 0; w < numWords; w++)
+	{
+		if (literalWord(inner, w) & ~literalWord(outer, w))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//gates are grouped by signature, complemented so that the first pattern is
+//0, which puts a gate and its inverse in the same group
+void RandomSignatures::index(const unsigned int *resetValues)
+{
+	vector<int> gates;
+	int gateN;
+
+	memoryReleased(MemSimState, rows.size() * sizeof(uint64_t));
+	rows.assign((size_t) numWords * 64 * literalWords, 0);
+	memoryAllocated(MemSimState, rows.size() * sizeof(uint64_t));
+	for (gateN = 1; gateN < ckt->numgates; gateN++)
+	{
+		if (ckt->gtype[gateN] == JUNK || resetValues[gateN] == 0 || resetValues[gateN] == 1)
+		{
+			continue;
+		}
+		gates.push_back(gateN);
+		for (uint32_t literal = 2 * gateN; literal <= 2 * (uint32_t) gateN + 1; literal++)
+		{
+			for (int w = 0; w < numWords; w++)
+			{
+				uint64_t bits = literalWord(literal, w);
+				while (bits != 0)
+				{
+					int pattern = w * 64 + __builtin_ctzll(bits);
+					bits &= bits - 1;
+					rows[(size_t) pattern * literalWords + literal / 64] |= (uint64_t) 1 << (literal % 64);
+				}
+			}
+		}
+	}
+
+	auto canonical = [this](int gate, int w) {
+		return values[(size_t) gate * numWords] & 1 ? ~values[(size_t) gate * numWords + w] : values[(size_t) gate * numWords + w];
+	};
+	sort(gates.begin(), gates.end(), [&](int a, int b) {
+		for (int w = 0; w < numWords; w++)
+		{
+			if (canonical(a, w) != canonical(b, w))
+			{
+				return canonical(a, w) < canonical(b, w);
+			}
+		}
+		return a < b;
+	});
+	numEquivalentGates = numEquivalenceClasses = 0;
+	for (size_t first = 0, last; first < gates.size(); first = last)
+	{
+		for (last = first + 1; last < gates.size(); last++)
+		{
+			int w = 0;
+			while (w < numWords && canonical(gates[first], w) == canonical(gates[last], w))
+			{
+				w++;
+			}
+			if (w < numWords)
+			{
+				break;
+			}
+		}
+		if (last - first > 1)
+		{
+			numEquivalenceClasses++;
+			numEquivalentGates += last - first;
+		}
+	}
+}
+
+/*
+A few rows of the patterns where imp holds narrow the candidates to the
+literals holding in all of them, and each candidate not yet in the closure
+is checked against the whole signature. A literal which held in no pattern
+may be unreachable, which only the simulation can show.
+*/
+bool RandomSignatures::covered(uint32_t imp, const ImplicationList &closure) const
+{
+	uint32_t literal = literalIndex(imp);
+	vector<uint64_t> candidates;
+	int probes = 0;
+
+	for (int w = 0; w < numWords && probes < SIGNATURE_PROBES; w++)
+	{
+		uint64_t bits = literalWord(literal, w);
+		while (bits != 0 && probes < SIGNATURE_PROBES)
+		{
+			const uint64_t *row = &rows[(size_t) (w * 64 + __builtin_ctzll(bits)) * literalWords];
+			bits &= bits - 1;
+			if (probes++ == 0)
+			{
+				candidates.assign(row, row + literalWords);
+				continue;
+			}
+			for (int k = 0; k < literalWords; k++)
+			{
+				candidates[k] &= row[k];
+			}
+		}
+	}
+	if (probes == 0)
+	{
+		return false;
+	}
+	for (int k = 0; k < literalWords; k++)
+	{
+		uint64_t bits = candidates[k];
+		while (bits != 0)
+		{
+			uint32_t other = k * 64 + __builtin_ctzll(bits);
+			bits &= bits - 1;
+			if (other != literal && closure.count(literalFromIndex(other)) == 0 && contains(literal, other))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,76 @@
+// Filename:	random_signatures.h
+// Description:	Header file for random pattern signatures. Every gate is
+//				simulated on a few hundred random input patterns at once,
+//				64 per machine word, and a literal's signature is the set of
+//				patterns in which it holds.
+
+#ifndef RANDOM_SIGNATURES
+#define RANDOM_SIGNATURES
+
+//STL includes
+#include <cstdint>
+#include <vector>
+
+//user defined includes
+#include "implication_structure.h"
+#include "memory_accounting.h"
+#include "netlist.h"
+
+//default and largest number of random patterns
+#define SIGNATURE_BITS 256
+#define MAX_SIGNATURE_BITS 1024
+//pattern rows intersected to narrow the candidates before checking each one
+#define SIGNATURE_PROBES 16
+//literals checked before the signatures are dropped for skipping under 1% of them
+#define SIGNATURE_TRIAL 1024
+
+////////////////////////////////////////////////////////////////////////
+// RandomSignatures class
+//	a -> b can only hold if b holds in every pattern a holds in, so the
+//	patterns where a holds and b does not rule the pair out. Each literal
+//	is indexed by pattern (one bitset of literals per pattern), so the
+//	literals whose signature contains a given one are found by intersecting
+//	a few pattern rows and checking what is left.
+//
+//	Any binary assignment to the inputs and X ties is a witness for the
+//	three valued simulation used in learning, so this holds for every
+//	edge it learns. FFs make the learning simulation carry values around
+//	loops, which a single random pattern can not follow, so sequential
+//	circuits are not usable.
+////////////////////////////////////////////////////////////////////////
+class RandomSignatures
+{
+public:
+	//simulates bits random patterns (rounded up to whole words) from a fixed seed
+	RandomSignatures(const Netlist *netlist, int bits);
+	~RandomSignatures();
+
+	//false if the circuit has FFs or gates this simulation does not model
+	bool usable() const { return isUsable; }
+	//builds the literal index, leaving out gates which are already 0 or 1 in
+	//resetValues: learning never reports them as implications
+	void index(const unsigned int *resetValues);
+	//true if every indexed literal whose signature contains imp's is in
+	//closure, so that simulating imp can not find a new implication
+	bool covered(uint32_t imp, const ImplicationList &closure) const;
+
+	int numWords;			// words per signature
+	//gates whose signature equals another gate's or its complement, and the
+	//classes they fall in: candidate equivalences
+	int numEquivalentGates;
+	int numEquivalenceClasses;
+
+private:
+	const uint64_t * signature(int gate) const { return &values[(size_t) gate * numWords]; }
+	bool contains(uint32_t inner, uint32_t outer) const;	// literal signatures, 2*gate + value
+	uint64_t literalWord(uint32_t literal, int word) const;
+
+	const Netlist *ckt;	// shared topology (not owned)
+	bool isUsable;
+	std::vector<uint64_t> values;	// numWords per gate, bit p is the gate's value in pattern p
+	int literalWords;				// words per row of the index
+	std::vector<uint64_t> rows;		// per pattern, the indexed literals which hold in it
+	size_t stateBytes;
+};
+
+#endif
@@ -0,0 +1,282 @@
+// Filename:	sequential_sim.cpp
+// Description:	Cycle based sequential simulation of 64 sequences at once
+
+#include "sequential_sim.h"
+
+//STL includes
+#include <iostream>
+
+using namespace std;
+
+#define WORD_ONES (~(uint64_t) 0)
+
+////////////////////////////////////////////////////////////////////////
+// SequentialSim class
+////////////////////////////////////////////////////////////////////////
+
+//constructor, orders the combinational gates by level and starts every
+//sequence from the all X state
+SequentialSim::SequentialSim(const Netlist *netlist)
+{
+	int gateN;
+
+	ckt = netlist;
+	//counting sort of the combinational gates by level
+	vector<int> levelStart(ckt->maxlevels + 1, 0);
+	for (gateN = 1; gateN < ckt->numgates; gateN++)
+	{
+		switch (ckt->gtype[gateN])
+		{
+		case JUNK:
+		case T_input:
+		case T_dff:
+		case T_tie0:
+		case T_tie1:
+		case T_tieX:
+		case T_tieZ:
+			break;
+		case T_and:
+		case T_nand:
+		case T_or:
+		case T_nor:
+		case T_xor:
+		case T_xnor:
+		case T_not:
+		case T_buf:
+		case T_output:
+			levelStart[ckt->levelNum[gateN] + 1]++;
+			break;
+		default:
+			cerr << "illegal gate type for sequential simulation " << gateN << " " << (int) ckt->gtype[gateN] << "\n";
+			exit(-1);
+		}
+	}
+	for (int level = 0; level < ckt->maxlevels; level++)
+	{
+		levelStart[level + 1] += levelStart[level];
+	}
+	order.resize(levelStart[ckt->maxlevels]);
+	for (gateN = 1; gateN < ckt->numgates; gateN++)
+	{
+		switch (ckt->gtype[gateN])
+		{
+		case T_and:
+		case T_nand:
+		case T_or:
+		case T_nor:
+		case T_xor:
+		case T_xnor:
+		case T_not:
+		case T_buf:
+		case T_output:
+			order[levelStart[ckt->levelNum[gateN]]++].gate = gateN;
+			break;
+		default:
+			break;
+		}
+	}
+	//the fanins are copied in evaluation order, so a cycle reads them front to back
+	for (size_t k = 0; k < order.size(); k++)
+	{
+		Step &step = order[k];
+		step.type = ckt->gtype[step.gate];
+		step.first = fanins.size();
+		step.count = ckt->fanin[step.gate];
+		fanins.insert(fanins.end(), ckt->inlist[step.gate], ckt->inlist[step.gate] + step.count);
+	}
+
+	values.resize(ckt->numgates);
+	initial.resize(ckt->numff);
+	next.resize(ckt->numff);
+	setInitialState("");
+	stateBytes = (values.size() + initial.size() + next.size()) * sizeof(Word) + order.size() * sizeof(Step)
+		+ fanins.size() * sizeof(int);
+	memoryAllocated(MemSimState, stateBytes);
+	reset();
+}
+
+SequentialSim::~SequentialSim()
+{
+	memoryReleased(MemSimState, stateBytes);
+}
+
+void SequentialSim::setInitialState(const string &state)
+{
+	for (int i = 0; i < ckt->numff; i++)
+	{
+		char c = i < (int) state.size() ? state[i] : 'X';
+		initial[i].low = c == '1' ? WORD_ONES : 0;
+		initial[i].high = c == '0' ? 0 : WORD_ONES;
+	}
+}
+
+void SequentialSim::reset()
+{
+	int i;
+
+	for (i = 0; i < ckt->numgates; i++)
+	{
+		values[i].low = 0;
+		values[i].high = WORD_ONES;
+	}
+	for (i = 0; i < ckt->numTieNodes; i++)
+	{
+		uint64_t value = ckt->gtype[ckt->TIES[i]] == T_tie1 ? WORD_ONES : 0;
+		values[ckt->TIES[i]].low = values[ckt->TIES[i]].high = value;
+	}
+	for (i = 0; i < ckt->numff; i++)
+	{
+		values[ckt->ff_list[i]] = initial[i];
+	}
+}
+
+bool SequentialSim::setInputs(int sequence, const char *vec)
+{
+	uint64_t bit = (uint64_t) 1 << sequence;
+
+	for (int i = 0; i < ckt->numpri; i++)
+	{
+		Word &value = values[ckt->inputs[i]];
+		switch (vec[i])
+		{
+		case '0':
+			value.low &= ~bit;
+			value.high &= ~bit;
+			break;
+		case '1':
+			value.low |= bit;
+			value.high |= bit;
+			break;
+		case 'x':
+		case 'X':
+			value.low &= ~bit;
+			value.high |= bit;
+			break;
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+
+//An X on either input of an XOR makes the output X, so the output is a
+//known 1 only where both inputs are known and differ, and a possible 1
+//everywhere except where both inputs are known and equal
+inline void SequentialSim::evaluate(const Step &step)
+{
+	const int *in = &fanins[step.first];
+	uint64_t l, h, t;
+	int i;
+
+	switch (step.type)
+	{
+	case T_and:
+	case T_nand:
+		l = h = WORD_ONES;
+		for (i = 0; i < step.count; i++)
+		{
+			l &= values[in[i]].low;
+			h &= values[in[i]].high;
+		}
+		break;
+	case T_or:
+	case T_nor:
+		l = h = 0;
+		for (i = 0; i < step.count; i++)
+		{
+			l |= values[in[i]].low;
+			h |= values[in[i]].high;
+		}
+		break;
+	case T_xor:
+	case T_xnor:
+		l = values[in[0]].low;
+		h = values[in[0]].high;
+		for (i = 1; i < step.count; i++)
+		{
+			uint64_t bl = values[in[i]].low, bh = values[in[i]].high;
+			t = (l & ~bh) | (~h & bl);
+			h = (h | bh) & ~(l & bl);
+			l = t;
+		}
+		break;
+	default:	// not, buf and output
+		l = values[in[0]].low;
+		h = values[in[0]].high;
+		break;
+	}
+	switch (step.type)
+	{
+	case T_nand:
+	case T_nor:
+	case T_xnor:
+	case T_not:
+		//inverting swaps the rails, so X stays X
+		t = ~l;
+		l = ~h;
+		h = t;
+		break;
+	default:
+		break;
+	}
+	values[step.gate].low = l;
+	values[step.gate].high = h;
+}
+
+////////////////////////////////////////////////////////////////////////
+// clock() -
+//	One clock cycle: the combinational logic settles with the FFs holding
+//	their current state, then every FF takes the value on its D input.
+//	The next state is gathered before any FF changes, since one FF may
+//	feed another directly.
+////////////////////////////////////////////////////////////////////////
+void SequentialSim::clock()
+{
+	int i;
+
+	for (size_t k = 0; k < order.size(); k++)
+	{
+		evaluate(order[k]);
+	}
+	for (i = 0; i < ckt->numff; i++)
+	{
+		next[i] = values[ckt->inlist[ckt->ff_list[i]][0]];
+	}
+	for (i = 0; i < ckt->numff; i++)
+	{
+		values[ckt->ff_list[i]] = next[i];
+	}
+}
+
+char SequentialSim::valueOf(int gateN, int sequence) const
+{
+	uint64_t bit = (uint64_t) 1 << sequence;
+
+	if (values[gateN].low & bit)
+		return '1';
+	if (values[gateN].high & bit)
+		return 'X';
+	return '0';
+}
+
+string SequentialSim::outputValues(int sequence) const
+{
+	string result;
+
+	for (int i = 0; i < ckt->numout; i++)
+	{
+		result += valueOf(ckt->outputs[i], sequence);
+	}
+	return result;
+}
+
+string SequentialSim::stateValues(int sequence) const
+{
+	string result;
+
+	for (int i = 0; i < ckt->numff; i++)
+	{
+		result += valueOf(ckt->ff_list[i], sequence);
+	}
+	return result;
+}
@@ -0,0 +1,81 @@
+// Filename:	sequential_sim.h
+// Description:	Header file for cycle based sequential simulation. Up to 64
+//				independent input sequences are simulated together, one per
+//				bit of a machine word, with the flop state carried from one
+//				clock cycle to the next.
+
+#ifndef SEQUENTIAL_SIM
+#define SEQUENTIAL_SIM
+
+//STL includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//user defined includes
+#include "memory_accounting.h"
+#include "netlist.h"
+
+//sequences simulated together, one per bit of a word
+#define SEQ_WIDTH 64
+
+////////////////////////////////////////////////////////////////////////
+// SequentialSim class
+//	Each gate value is a pair of words (low, high) holding one three
+//	valued signal per sequence: 0 is (0, 0), 1 is (1, 1) and X is (0, 1),
+//	the same encoding as RESET_FF1 and RESET_FF2 in the netlist. Every
+//	cycle evaluates all of the combinational gates in level order, so the
+//	cost does not depend on activity. Unlike SimContext, X values carry
+//	no identity, so an X and its complement do not cancel.
+////////////////////////////////////////////////////////////////////////
+class SequentialSim
+{
+public:
+	SequentialSim(const Netlist *netlist);	// constructor with shared netlist
+	~SequentialSim();
+
+	//sets the state every sequence starts from, one 0, 1 or X per FF (as
+	//read by Netlist::readInitialState), or all X when state is empty
+	void setInitialState(const std::string &state);
+	//puts every sequence back at the initial state
+	void reset();
+	//sets the inputs of one sequence for the next cycle, numpri characters
+	//0, 1 or X. False if any other character is found
+	bool setInputs(int sequence, const char *vec);
+	//evaluates the combinational logic and clocks every FF
+	void clock();
+	//PO values of one sequence in the last cycle, as a string of 0/1/X
+	std::string outputValues(int sequence) const;
+	//FF values of one sequence after the last clock
+	std::string stateValues(int sequence) const;
+
+private:
+	//one signal per sequence, see the class comment
+	struct Word
+	{
+		uint64_t low;
+		uint64_t high;
+	};
+	//one combinational gate, with its fanins copied next to those of the
+	//gates evaluated before and after it
+	struct Step
+	{
+		int gate;
+		int type;
+		int first;	// index of the first fanin in fanins
+		int count;
+	};
+
+	void evaluate(const Step &step);	// new value of one gate
+	char valueOf(int gateN, int sequence) const;
+
+	const Netlist *ckt;	// shared topology (not owned)
+	std::vector<Step> order;	// combinational gates in ascending level
+	std::vector<int> fanins;
+	std::vector<Word> values;	// value of each gate
+	std::vector<Word> initial;	// initial value of each FF
+	std::vector<Word> next;		// FF values being clocked in
+	size_t stateBytes;
+};
+
+#endif
@@ -0,0 +1,95 @@
+// Filename:	shard_merge.cpp
+// Description:	Merge tool for sharded learning. Combines the lists written
+//				by GateImplicationSim --shard i/N for every shard of a run
+//				into one binary implication database, then runs a closure
+//				pass to fix literals the shards only disprove together.
+
+#include "implication_export.h"
+
+//STL includes
+#include <thread>
+
+using namespace std;
+
+void printUsage()
+{
+	cerr << "Usage: ImplicationShardMerge [--threads <n>] <circuit path> <output database> <shard file>..." << endl;
+}
+
+int main(int argc, char *argv[])
+{
+	vector<string> args;
+	int numThreads = thread::hardware_concurrency();
+
+	for (int i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		if (arg == "--threads" && i + 1 < argc)
+		{
+			numThreads = atoi(argv[++i]);
+		}
+		else
+		{
+			args.push_back(arg);
+		}
+	}
+	if (args.size() < 3)
+	{
+		printUsage();
+		exit(EXIT_FAILURE);
+	}
+	string circuitPath = args[0];
+	string outputPath = args[1];
+	if (!Netlist::circuitExists(circuitPath))
+	{
+		cerr << "ERROR: Could not open circuit " << circuitPath << endl;
+		exit(EXIT_FAILURE);
+	}
+
+	LogicSim sim(circuitPath, false, false);
+	vector<char> seen;
+	uint32_t numShards = 0;
+	for (size_t i = 2; i < args.size(); i++)
+	{
+		ImplicationReader shard;
+		if (!shard.open(args[i]) || !(shard.flags & EXPORT_SHARD) || (shard.flags & EXPORT_CLOSURE))
+		{
+			cerr << "ERROR: " << args[i] << " is not a shard of a learning run" << endl;
+			exit(EXIT_FAILURE);
+		}
+		if (i == 2)
+		{
+			numShards = shard.numShards;
+			seen.assign(numShards, 0);
+		}
+		if (shard.numShards != numShards || shard.shardIndex >= numShards || seen[shard.shardIndex])
+		{
+			cerr << "ERROR: " << args[i] << " is shard " << shard.shardIndex << " of " << shard.numShards
+				<< ", expected one shard of each index out of " << numShards << endl;
+			exit(EXIT_FAILURE);
+		}
+		seen[shard.shardIndex] = 1;
+		bool ok = i == 2 ? sim.loadImplicationLists(shard) : sim.mergeImplicationLists(shard);
+		if (!ok)
+		{
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (args.size() - 2 != numShards)
+	{
+		cerr << "ERROR: Got " << args.size() - 2 << " of " << numShards << " shards" << endl;
+		exit(EXIT_FAILURE);
+	}
+
+	int fixedBefore = sim.fixedNodeCounter;
+	int conflicts = sim.fixConflictingLiterals(numThreads);
+	ImplicationExporter exporter(&sim, numThreads);
+	if (!exporter.exportLists(outputPath, ExportBinary, false))
+	{
+		cerr << "ERROR: Could not write " << outputPath << endl;
+		exit(EXIT_FAILURE);
+	}
+	cout << "Merged " << numShards << " shards into " << outputPath << ": " << fixedBefore << " unreachable literals from the shards, "
+		<< conflicts << " more found by the closure pass" << endl;
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,997 @@
+// Filename:	sim_context.cpp
+// Description:	Per-thread three value logic simulation state over a shared,
+//				read-only netlist
+
+///////////////////////////////////////////////////////////////////////
+//   Logic Simulator, written by Michael Hsiao
+//   Began in 1992, revisions and additions of functions till 2013
+///////////////////////////////////////////////////////////////////////
+
+#include "sim_context.h"
+
+//STL includes
+#include <chrono>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////
+// SimContext class
+////////////////////////////////////////////////////////////////////////
+
+//constructor, allocates the mutable simulation state for one netlist
+SimContext::SimContext(const Netlist *netlist)
+{
+	int i;
+
+	ckt = netlist;
+	x_number = 4;			//distinguishing X starting value
+	pool = NULL;
+	parallel = false;
+	numEvents = 0;
+	keepX = false;
+	inputX.assign(ckt->numpri, 0);
+	ownX.assign(ckt->numgates + 64, 0);
+
+	sched = new char[ckt->numgates + 64];
+	GateValues = new unsigned int[ckt->numgates + 64];
+	for (i = 0; i < ckt->numgates + 64; i++)
+	{
+		sched[i] = 0;
+		// assign all values to unknown (unassigned x)
+		GateValues[i] = ALLONES;
+	}
+	//tied nodes hold their value for the life of the context
+	for (i = 0; i < ckt->numTieNodes; i++)
+	{
+		if (ckt->gtype[ckt->TIES[i]] == T_tie1)
+			GateValues[ckt->TIES[i]] = 1;
+		else
+			GateValues[ckt->TIES[i]] = 0;
+	}
+
+	goodState = new char[ckt->numff];
+	for (i = 0; i < ckt->numff; i++)
+	{
+		goodState[i] = 'X';
+	}
+
+	setupWheel(ckt->maxlevels, ckt->maxLevelSize);
+	stateBytes = (ckt->numgates + 64) * (sizeof(char) + sizeof(unsigned int)) + ckt->numff
+		+ (ckt->numpri + ckt->numgates + 64) * sizeof(unsigned int);
+	wheelBytes = (size_t) ckt->maxlevels * (ckt->maxLevelSize * sizeof(int) + sizeof(int) + sizeof(int *))
+		+ ckt->maxLevelSize * sizeof(int) + (ckt->numff + 1) * sizeof(int);
+	memoryAllocated(MemSimState, stateBytes);
+	memoryAllocated(MemEventWheel, wheelBytes);
+	//gates fed only by ties are evaluated by the first simulation
+	setTieEvents();
+}
+
+//destructor, releases the simulation state (the netlist is not owned)
+SimContext::~SimContext()
+{
+	memoryReleased(MemSimState, stateBytes);
+	memoryReleased(MemEventWheel, wheelBytes);
+	for (int i = 0; i < numlevels; i++)
+	{
+		delete[] levelEvents[i];
+	}
+	delete[] levelEvents;
+	delete[] levelLen;
+	delete[] activation;
+	delete[] actFFList;
+	delete[] goodState;
+	delete[] GateValues;
+	delete[] sched;
+}
+
+//copies a saved set of gate values into the context and clears the
+//list of changes, used to rewind the circuit between learning simulations
+void SimContext::restoreValues(const unsigned int *values, int xNumber)
+{
+	for (int i = 0; i < ckt->numgates; i++)
+	{
+		GateValues[i] = values[i];
+		//X ids from xNumber on will be given out again
+		if (ownX[i] >= (unsigned int) xNumber)
+		{
+			ownX[i] = 0;
+		}
+	}
+	for (int i = 0; i < ckt->numpri; i++)
+	{
+		if (inputX[i] >= (unsigned int) xNumber)
+		{
+			inputX[i] = 0;
+		}
+	}
+	x_number = xNumber;
+	keepX = false;
+	changes.clear();
+	//goodState is only updated for FFs whose D input changes, so it is
+	//brought back in line with the restored values here
+	for (int i = 0; i < ckt->numff; i++)
+	{
+		unsigned int value = GateValues[ckt->inlist[ckt->ff_list[i]][0]];
+		goodState[i] = value == 1 ? '1' : (value == 0 ? '0' : 'X');
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// setTieEvents()
+//	This function set up the events for tied nodes
+////////////////////////////////////////////////////////////////////////
+void SimContext::setTieEvents()
+{
+    int predecessor, successor;
+    int i, j;
+
+    for (i = 0; i < ckt->numTieNodes; i++)
+    {
+	  // different from previous time frame, place in wheel
+	  for (j=0; j<ckt->fanout[ckt->TIES[i]]; j++)
+	  {
+	    successor = ckt->fnlist[ckt->TIES[i]][j];
+	    if (sched[successor] == 0)
+	    {
+	    	insertEvent(ckt->levelNum[successor], successor);
+			sched[successor] = 1;
+	    }
+	  }
+    }	// for (i...)
+
+    // initialize state if necessary
+    if (ckt->INIT0 == 1)
+    {
+cout << "Initialize circuit to values in *.initState!\n";
+	for (i=0; i<ckt->numff; i++)
+	{
+	    GateValues[ckt->ff_list[i]] = ckt->RESET_FF1[i];
+
+	  for (j=0; j<ckt->fanout[ckt->ff_list[i]]; j++)
+	  {
+	    successor = ckt->fnlist[ckt->ff_list[i]][j];
+	    if (sched[successor] == 0)
+	    {
+	    	insertEvent(ckt->levelNum[successor], successor);
+		sched[successor] = 1;
+	    }
+	  }	// for j
+
+	    predecessor = ckt->inlist[ckt->ff_list[i]][0];
+		GateValues[predecessor] = ckt->RESET_FF1[i];
+	  for (j=0; j<ckt->fanout[predecessor]; j++)
+	  {
+	    successor = ckt->fnlist[predecessor][j];
+	    if (sched[successor] == 0)
+	    {
+	    	insertEvent(ckt->levelNum[successor], successor);
+		sched[successor] = 1;
+	    }
+	  }	// for j
+
+	}	// for i
+    }	// if (INIT0)
+}
+
+////////////////////////////////////////////////////////////////////////
+// applyVector()
+//	This function applies the vector to the inputs of the ckt.
+////////////////////////////////////////////////////////////////////////
+void SimContext::applyVector(char *vec)
+{
+    int successor;
+    int i, j;
+
+    keepX = false;
+    for (i = 0; i < ckt->numpri; i++)
+    {
+	  switch (vec[i])
+	  {
+	    case '0':
+		GateValues[ckt->inputs[i]] = 0;
+		break;
+	    case '1':
+		GateValues[ckt->inputs[i]] = 1;
+		break;
+	    case 'x':
+	    case 'X':
+		//assign to current X instance
+		GateValues[ckt->inputs[i]] = inputX[i] = x_number;
+		//increment the x counter
+		x_number = x_number + 2;
+		break;
+	    default:
+		cerr << vec[i] << ": error in the input vector.\n";
+		exit(-1);
+	  }	// switch
+
+	  // different from previous time frame, place in wheel
+	  for (j=0; j<ckt->fanout[ckt->inputs[i]]; j++)
+	  {
+	    successor = ckt->fnlist[ckt->inputs[i]][j];
+	    if (sched[successor] == 0)
+	    {
+	    	insertEvent(ckt->levelNum[successor], successor);
+			sched[successor] = 1;
+	    }
+	  }
+    }	// for (i...)
+}
+
+////////////////////////////////////////////////////////////////////////
+// applyVectorDelta()
+//	Applies a vector relative to the values already on the inputs, so a
+//	stream of similar vectors only simulates the cones of the inputs that
+//	toggle. In a sequential circuit every X is still a new X, on inputs
+//	and gates alike, since it is independent of the X the FFs captured in
+//	earlier cycles.
+////////////////////////////////////////////////////////////////////////
+int SimContext::applyVectorDelta(const char *vec)
+{
+    unsigned int newVal, oldVal;
+    int successor;
+    int i, j;
+    int changed = 0;
+
+    keepX = ckt->numff == 0;
+    for (i = 0; i < ckt->numpri; i++)
+    {
+	  oldVal = GateValues[ckt->inputs[i]];
+	  switch (vec[i])
+	  {
+	    case '0':
+		newVal = 0;
+		break;
+	    case '1':
+		newVal = 1;
+		break;
+	    case 'x':
+	    case 'X':
+		//only an X this context gave to the input is kept, the reset
+		//value ALLONES is shared by every input
+		if (oldVal > 1 && oldVal == inputX[i] && ckt->numff == 0)
+		{
+		    newVal = oldVal;
+		}
+		else
+		{
+		    newVal = inputX[i] = x_number;
+		    x_number = x_number + 2;
+		}
+		break;
+	    default:
+		cerr << vec[i] << ": error in the input vector.\n";
+		exit(-1);
+	  }	// switch
+	  if (newVal == oldVal)
+	  {
+		continue;
+	  }
+	  GateValues[ckt->inputs[i]] = newVal;
+	  changed++;
+
+	  for (j=0; j<ckt->fanout[ckt->inputs[i]]; j++)
+	  {
+	    successor = ckt->fnlist[ckt->inputs[i]][j];
+	    if (sched[successor] == 0)
+	    {
+	    	insertEvent(ckt->levelNum[successor], successor);
+			sched[successor] = 1;
+	    }
+	  }
+    }	// for (i...)
+    return changed;
+}
+
+////////////////////////////////////////////////////////////////////////
+// lowWheel
+////////////////////////////////////////////////////////////////////////
+
+void SimContext::setupWheel(int numLevels, int levelSize)
+{
+    int i;
+
+    numlevels = numLevels;
+    levelLen = new int[numLevels];
+    levelEvents = new int * [numLevels];
+    for (i=0; i < numLevels; i++)
+    {
+	levelEvents[i] = new int[levelSize];
+	levelLen[i] = 0;
+    }
+    activation = new int[levelSize];
+    
+    actFFList = new int[ckt->numff + 1];
+}
+
+////////////////////////////////////////////////////////////////////////
+int SimContext::retrieveEvent()
+{
+    while ((currLevel < ckt->maxlevels) && (levelLen[currLevel] == 0))
+	currLevel++;
+
+    if (currLevel < ckt->maxlevels)
+    {
+    	levelLen[currLevel]--;
+        return(levelEvents[currLevel][levelLen[currLevel]]);
+    }
+    else
+	return(-1);
+}
+
+// Gate Evaluation functions. Each returns the gate output (1, 0, or X id)
+unsigned int SimContext::evalAND(int gateN, std::vector<uint32_t> &values)
+{
+	//read fanin values into the gatevalues vector
+	int i, j;
+	bool allEqual = true;
+	uint32_t val = GateValues[ckt->inlist[gateN][0]];
+
+	values.clear();
+	for (i = 0; i < ckt->fanin[gateN]; i++)
+	{
+		values.push_back(GateValues[ckt->inlist[gateN][i]]);
+		//check for controlling value (0)
+		if (GateValues[ckt->inlist[gateN][i]] == 0)
+		{
+			return 0;
+		}
+		//check for same x inputs on all
+		if (val != GateValues[ckt->inlist[gateN][i]])
+		{
+			allEqual = false;
+		}
+		val = GateValues[ckt->inlist[gateN][i]];
+	}
+	//if same input on all return that
+	if (allEqual)
+	{
+		return val;
+	}
+	//different X input (complements squash to 0)
+	for (i = 0; i < values.size(); i++)
+	{
+		if (values[i] & 0x1) //if odd
+		{
+			for (j = 0; j < values.size(); j++)
+			{
+				if (values[j] == (values[i] - 1))
+				{
+					return 0;
+				}
+			}
+		}
+		else //if even
+		{
+			for (j = 0; j < values.size(); j++)
+			{
+				if (values[j] == (values[i] + 1))
+				{
+					return 0;
+				}
+			}
+		}
+	}
+	//else return a new X value
+	return newX(gateN);
+}
+
+unsigned int SimContext::evalNAND(int gateN, std::vector<uint32_t> &values)
+{
+	unsigned int ANDVal = evalAND(gateN, values);
+	if (ANDVal == 1)
+	{
+		return 0;
+	}
+	else if (ANDVal == 0)
+	{
+		return 1;
+	}
+	else if (ANDVal & 0x1) //odd number X
+	{
+		return ANDVal - 1;
+	}
+	else
+	{
+		//even number X
+		return ANDVal + 1;
+	}
+}
+
+unsigned int SimContext::evalOR(int gateN, std::vector<uint32_t> &values)
+{
+	//read fanin values into the gatevalues vector
+	int i, j;
+	bool allEqual = true;
+	uint32_t val = GateValues[ckt->inlist[gateN][0]];
+
+	values.clear();
+	for (i = 0; i < ckt->fanin[gateN]; i++)
+	{
+		values.push_back(GateValues[ckt->inlist[gateN][i]]);
+		//check for controlling value (1)
+		if (GateValues[ckt->inlist[gateN][i]] == 1)
+		{
+			return 1;
+		}
+		//check for same x inputs on all
+		if (val != GateValues[ckt->inlist[gateN][i]])
+		{
+			allEqual = false;
+		}
+		val = GateValues[ckt->inlist[gateN][i]];
+	}
+	//if same input on all return that
+	if (allEqual)
+	{
+		return val;
+	}
+	//different X input (complements squash to 0)
+	for (i = 0; i < values.size(); i++)
+	{
+		if (values[i] & 0x1) //if odd
+		{
+			for (j = 0; j < values.size(); j++)
+			{
+				if (values[j] == (values[i] - 1))
+				{
+					return 1;
+				}
+			}
+		}
+		else //if even
+		{
+			for (j = 0; j < values.size(); j++)
+			{
+				if (values[j] == (values[i] + 1))
+				{
+					return 1;
+				}
+			}
+		}
+	}
+	//else return a new X value
+	return newX(gateN);
+}
+
+unsigned int SimContext::evalNOR(int gateN, std::vector<uint32_t> &values)
+{
+	unsigned int ORVal = evalOR(gateN, values);
+	if (ORVal == 1)
+	{
+		return 0;
+	}
+	else if (ORVal == 0)
+	{
+		return 1;
+	}
+	else if (ORVal & 0x1) //odd number X
+	{
+		return ORVal - 1;
+	}
+	else
+	{
+		//even number X
+		return ORVal + 1;
+	}
+}
+
+unsigned int SimContext::evalXOR(int gateN)
+{
+	unsigned int val1, val2;
+	//get gate inputs
+	if (ckt->fanin[gateN] > 2)
+	{
+		//wider XOR, the parity when every input is known and an X otherwise
+		val1 = 0;
+		for (int i = 0; i < ckt->fanin[gateN]; i++)
+		{
+			val2 = GateValues[ckt->inlist[gateN][i]];
+			if (val2 > 1)
+			{
+				return newX(gateN);
+			}
+			val1 ^= val2;
+		}
+		return val1;
+	}
+	else if (ckt->fanin[gateN] > 1)
+	{
+		//2 input
+		val1 = GateValues[ckt->inlist[gateN][0]];
+		val2 = GateValues[ckt->inlist[gateN][1]];
+	}
+	else
+	{
+		//1 input
+		val1 = GateValues[ckt->inlist[gateN][0]];
+		val2 = val1;
+	}
+	//check for non-x values (1 or 0)
+	if (val1 < 2 && val2 < 2)
+	{
+		return (val1 ^ val2);
+	}
+	//check for same x input
+	if (val1 == val2)
+	{
+		//cout << "Xs on inputs of gate " << gateN << " squashed!" << endl;
+		return 0;
+	}
+	//different X inputs
+	if (((val1 & 0x1) && val2 == (val1 - 1)) || ((val2 & 0x1) && val1 == (val2 - 1)))
+	{
+		//cout << "Xs on inputs of gate " << gateN << " squashed!" << endl;
+		return 1;
+	}
+	//else return a new X value
+	return newX(gateN);
+}
+
+unsigned int SimContext::evalXNOR(int gateN)
+{
+	unsigned int XORVal = evalXOR(gateN);
+	if (XORVal == 1)
+	{
+		return 0;
+	}
+	else if (XORVal == 0)
+	{
+		return 1;
+	}
+	else if (XORVal & 0x1) //odd number X
+	{
+		return XORVal - 1;
+	}
+	else
+	{
+		//even number X
+		return XORVal + 1;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// evalFixed() -
+//	Evaluator for one gate type and fanin count. The controlling value and
+//	the output inversion are compile time constants and the fanin loops
+//	unroll, so a 2 or 3 input gate is a few compares with no dispatch. The
+//	results are the same as those of evalAND, evalOR and evalXOR:
+//	- a controlling input gives the controlling value
+//	- inputs all equal give that value
+//	- an X and its complement give the controlling value
+//	- anything else is a new X
+//	and the inverting types complement the result (X ^ 1 is its complement).
+////////////////////////////////////////////////////////////////////////
+template <int Type, int N>
+inline unsigned int SimContext::evalFixed(int gateN)
+{
+	constexpr bool isXor = Type == T_xor || Type == T_xnor;
+	constexpr unsigned int control = (Type == T_and || Type == T_nand) ? 0 : 1;
+	constexpr unsigned int invert = (Type == T_nand || Type == T_nor || Type == T_xnor) ? 1 : 0;
+	const int *in = ckt->inlist[gateN];
+	unsigned int v[N];
+	bool controlled = false;
+	bool equal = true;
+	bool complement = false;
+	int i, j;
+
+	for (i = 0; i < N; i++)
+	{
+		v[i] = GateValues[in[i]];
+	}
+	if (isXor)
+	{
+		static_assert(!isXor || N == 2, "XOR evaluators take 2 inputs");
+		if (v[0] < 2 && v[1] < 2)
+			return v[0] ^ v[1] ^ invert;
+		if (v[0] == v[1])
+			return invert;
+		if (v[0] == (v[1] ^ 1))
+			return 1 ^ invert;
+		return newX(gateN) ^ invert;
+	}
+	for (i = 0; i < N; i++)
+	{
+		controlled |= v[i] == control;
+		equal &= v[i] == v[0];
+		for (j = i + 1; j < N; j++)
+		{
+			complement |= v[i] == (v[j] ^ 1);
+		}
+	}
+	if (controlled || (complement && !equal))
+		return control ^ invert;
+	if (equal)
+		return v[0] ^ invert;
+	return newX(gateN) ^ invert;
+}
+
+////////////////////////////////////////////////////////////////////////
+// evaluate() -
+//	Returns the new value of one gate from the values on its inputs,
+//	through the evaluator the netlist picked for it.
+////////////////////////////////////////////////////////////////////////
+unsigned int SimContext::evaluate(int gateN, std::vector<uint32_t> &values)
+{
+	switch (ckt->evalClass[gateN])
+	{
+	case EvalHold:
+		return GateValues[gateN];
+	case EvalCopy:
+		return GateValues[ckt->inlist[gateN][0]];
+	case EvalNot:
+		return GateValues[ckt->inlist[gateN][0]] ^ 1;
+	case EvalAnd2:
+		return evalFixed<T_and, 2>(gateN);
+	case EvalAnd3:
+		return evalFixed<T_and, 3>(gateN);
+	case EvalAnd4:
+		return evalFixed<T_and, 4>(gateN);
+	case EvalNand2:
+		return evalFixed<T_nand, 2>(gateN);
+	case EvalNand3:
+		return evalFixed<T_nand, 3>(gateN);
+	case EvalNand4:
+		return evalFixed<T_nand, 4>(gateN);
+	case EvalOr2:
+		return evalFixed<T_or, 2>(gateN);
+	case EvalOr3:
+		return evalFixed<T_or, 3>(gateN);
+	case EvalOr4:
+		return evalFixed<T_or, 4>(gateN);
+	case EvalNor2:
+		return evalFixed<T_nor, 2>(gateN);
+	case EvalNor3:
+		return evalFixed<T_nor, 3>(gateN);
+	case EvalNor4:
+		return evalFixed<T_nor, 4>(gateN);
+	case EvalXor2:
+		return evalFixed<T_xor, 2>(gateN);
+	case EvalXnor2:
+		return evalFixed<T_xnor, 2>(gateN);
+	default:
+		return evaluateGeneric(gateN, values);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// evaluateGeneric() -
+//	Evaluates a gate of any type and fanin by its type, for gates
+//	without a fixed width evaluator.
+////////////////////////////////////////////////////////////////////////
+unsigned int SimContext::evaluateGeneric(int gateN, std::vector<uint32_t> &values)
+{
+	int predecessor;
+	unsigned int newVal;
+
+	switch (ckt->gtype[gateN])
+	{
+	case T_and:
+		newVal = evalAND(gateN, values);
+		break;
+	case T_nand:
+		newVal = evalNAND(gateN, values);
+		break;
+	case T_or:
+		newVal = evalOR(gateN, values);
+		break;
+	case T_nor:
+		newVal = evalNOR(gateN, values);
+		break;
+	case T_xor:
+		newVal = evalXOR(gateN);
+		break;
+	case T_xnor:
+		newVal = evalXNOR(gateN);
+		break;
+	case T_not:
+		newVal = GateValues[ckt->inlist[gateN][0]];
+		if (newVal == 0)
+		{
+			newVal = 1;
+		}
+		else if (newVal == 1)
+		{
+			newVal = 0;
+		}
+		else if (newVal & 0x1) //odd X
+		{
+			newVal = newVal - 1;
+		}
+		else //even X
+		{
+			newVal = newVal + 1;
+		}
+		break;
+	case T_buf:
+		predecessor = ckt->inlist[gateN][0];
+		newVal = GateValues[predecessor];
+		break;
+	case T_dff:
+		predecessor = ckt->inlist[gateN][0];
+		newVal = GateValues[predecessor];
+		break;
+	case T_output:
+		predecessor = ckt->inlist[gateN][0];
+		newVal = GateValues[predecessor];
+		break;
+	case T_input:
+	case T_tie0:
+	case T_tie1:
+	case T_tieX:
+	case T_tieZ:
+		newVal = GateValues[gateN];
+		break;
+	default:
+		cerr << "illegal gate type1 " << gateN << " " << ckt->gtype[gateN] << "\n";
+		exit(-1);
+	}	// switch
+	return newVal;
+}
+
+////////////////////////////////////////////////////////////////////////
+// evaluationTime() -
+//	Times the gate evaluators alone, without the event wheel: every gate
+//	is evaluated on the values left by the last simulation and nothing is
+//	written back, so each round sees the same inputs.
+////////////////////////////////////////////////////////////////////////
+double SimContext::evaluationTime(bool specialized, int rounds)
+{
+	int saveX = x_number;
+	bool saveKeep = keepX;
+	unsigned int sink = 0;
+	int gateN;
+
+	keepX = false;
+	auto start = chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++)
+	{
+		for (gateN = 1; gateN < ckt->numgates; gateN++)
+		{
+			sink += specialized ? evaluate(gateN, evalValues) : evaluateGeneric(gateN, evalValues);
+		}
+		x_number = saveX;
+	}
+	double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+	keepX = saveKeep;
+	//keeps the evaluations from being optimized away
+	if (sink == 1)
+	{
+		evalValues.clear();
+	}
+	return rounds > 0 && ckt->numgates > 1 ? ns / ((double) rounds * (ckt->numgates - 1)) : 0;
+}
+
+void SimContext::setThreadPool(ThreadPool *workers)
+{
+	pool = workers;
+	levelWorkers.assign(pool != NULL ? pool->size() : 0, LevelWorker());
+}
+
+////////////////////////////////////////////////////////////////////////
+// simulateLevel() -
+//	Evaluates every event of the current level on the pool. A level only
+//	reads lower levels, so the gates are independent. Each worker keeps
+//	its own list of scheduled fanouts and changes; sched flags are claimed
+//	atomically so a fanout is scheduled once. The lists are put on the
+//	wheel after all workers are done.
+////////////////////////////////////////////////////////////////////////
+void SimContext::simulateLevel()
+{
+	int *events = levelEvents[currLevel];
+	int count = levelLen[currLevel];
+
+	levelLen[currLevel] = 0;
+	numEvents += count;
+	sharedX.store(x_number, std::memory_order_relaxed);
+	parallel = true;
+	pool->parallelFor(count, PARALLEL_LEVEL_CUTOFF, [this, events](int begin, int end, int worker)
+	{
+		LevelWorker &local = levelWorkers[worker];
+		for (int k = begin; k < end; k++)
+		{
+			int gateN = events[k];
+			sched[gateN] = 0;
+			unsigned int newVal = evaluate(gateN, local.evalValues);
+			if (newVal == GateValues[gateN])
+			{
+				continue;
+			}
+			if (newVal == 0)
+			{
+				local.changes.push_back(gateN);
+			}
+			else if (newVal == 1)
+			{
+				local.changes.push_back(gateN | VALUE);
+			}
+			GateValues[gateN] = newVal;
+			for (int i = 0; i < ckt->fanout[gateN]; i++)
+			{
+				int successor = ckt->fnlist[gateN][i];
+				if (__atomic_exchange_n(&sched[successor], 1, __ATOMIC_RELAXED) == 0)
+				{
+					local.scheduled.push_back(successor);
+				}
+			}
+		}
+	});
+	parallel = false;
+	x_number = sharedX.load(std::memory_order_relaxed);
+
+	for (size_t w = 0; w < levelWorkers.size(); w++)
+	{
+		LevelWorker &local = levelWorkers[w];
+		changes.insert(changes.end(), local.changes.begin(), local.changes.end());
+		for (size_t k = 0; k < local.scheduled.size(); k++)
+		{
+			int successor = local.scheduled[k];
+			if (ckt->levelNum[successor] != 0)
+			{
+				insertEvent(ckt->levelNum[successor], successor);
+			}
+			else	// same level, wrap around for next time
+			{
+				activation[actLen] = successor;
+				actLen++;
+			}
+		}
+		local.changes.clear();
+		local.scheduled.clear();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// goodsim() -
+//	Logic simulate. (no faults inserted)
+////////////////////////////////////////////////////////////////////////
+void SimContext::goodsim(bool verbose)
+{
+    int sucLevel;
+    int gateN, predecessor, successor;
+    int i;
+	unsigned int newVal;
+
+    currLevel = 0;
+    actLen = actFFLen = 0;
+    while (currLevel < ckt->maxlevels)
+    {
+		//wide levels are split over the pool, level 0 wraps around and stays serial
+		if (pool != NULL && currLevel > 0 && levelLen[currLevel] >= 2 * PARALLEL_LEVEL_CUTOFF)
+		{
+			simulateLevel();
+			continue;
+		}
+    	gateN = retrieveEvent();
+		if (gateN != -1)// if a valid event
+		{
+			numEvents++;
+			sched[gateN]= 0;
+			newVal = evaluate(gateN, evalValues);
+			if (ckt->gtype[gateN] == T_dff)
+			{
+				actFFList[actFFLen] = gateN;
+				actFFLen++;
+			}
+
+			// if gate value changed
+    		if (newVal != GateValues[gateN])
+			{
+				//if value changed to 1 or 0 add to changes list for implications
+				if (newVal == 0)
+				{
+					changes.emplace_back(gateN);
+				}
+				else if (newVal == 1)
+				{
+					changes.emplace_back(gateN | VALUE);
+				}
+
+				GateValues[gateN] = newVal;
+
+				for (i=0; i<ckt->fanout[gateN]; i++)
+				{
+					successor = ckt->fnlist[gateN][i];
+					sucLevel = ckt->levelNum[successor];
+					if (sched[successor] == 0)
+					{
+					  if (sucLevel != 0)
+					insertEvent(sucLevel, successor);
+					  else	// same level, wrap around for next time
+					  {
+					activation[actLen] = successor;
+					actLen++;
+					  }
+					  sched[successor] = 1;
+					}
+				}	// for (i...)
+
+		}	// if (newVal..)
+
+		}	// if (gateN...)
+    }	// while (currLevel...)
+    // now re-insert the activation list for the FF's. Every level 0
+    // successor is a FF whose D input changed, so this keeps goodState (the
+    // state clocked in by the next simulation) up to date
+    for (i=0; i < actLen; i++)
+    {
+	insertEvent(0, activation[i]);
+	sched[activation[i]] = 1;
+
+        predecessor = ckt->inlist[activation[i]][0];
+        gateN = ckt->ffMap[activation[i]];
+        if (GateValues[predecessor] == 1)
+            goodState[gateN] = '1';
+        else if (GateValues[predecessor] == 0)
+            goodState[gateN] = '0';
+        else
+            goodState[gateN] = 'X';
+    }
+	if (verbose)
+	{
+		//Print the PO outputs
+		cout << "output: ";
+		for (i = 0; i < ckt->numout; i++)
+		{
+			if (GateValues[ckt->outputs[i]] == 1)
+				cout << "1";
+			else if (GateValues[ckt->outputs[i]] == 0)
+				cout << "0";
+			else
+				cout << "X";
+		}
+		cout << endl;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// observeOutputs()
+//	This function prints the outputs of the fault-free circuit.
+////////////////////////////////////////////////////////////////////////
+void SimContext::observeOutputs()
+{
+    int i;
+
+    cout << "\t";
+    for (i=0; i<ckt->numout; i++)
+    {
+	if (GateValues[ckt->outputs[i]] == 1)
+	    cout << "1";
+	else if (GateValues[ckt->outputs[i]] == 0)
+	    cout << "0";
+	else
+	    cout << "X";
+    }
+
+    cout << "\n";
+    for (i=0; i<ckt->numff; i++)
+    {
+	if (GateValues[ckt->ff_list[i]] == 1)
+	    cout << "1";
+	else if (GateValues[ckt->ff_list[i]] == 0)
+	    cout << "0";
+	else
+	    cout << "X";
+    }
+    cout << "\n";
+}
+
+////////////////////////////////////////////////////////////////////////
+// outputValues()
+//	Returns the fault-free PO values, one character per output.
+////////////////////////////////////////////////////////////////////////
+string SimContext::outputValues() const
+{
+    string values;
+
+    for (int i=0; i<ckt->numout; i++)
+    {
+	if (GateValues[ckt->outputs[i]] == 1)
+	    values += '1';
+	else if (GateValues[ckt->outputs[i]] == 0)
+	    values += '0';
+	else
+	    values += 'X';
+    }
+    return values;
+}
@@ -0,0 +1,142 @@
+// Filename:	sim_context.h
+// Description:	Header file for a logic simulation context. A context holds
+//				all of the mutable state of one simulation (gate values,
+//				event wheel, X numbering) and references a shared netlist.
+
+#ifndef SIM_CONTEXT
+#define SIM_CONTEXT
+
+//STL includes
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//user defined includes
+#include "memory_accounting.h"
+#include "netlist.h"
+#include "thread_pool.h"
+
+//fewest gates of one level given to a worker, narrower levels are simulated
+//by the calling thread alone
+#define PARALLEL_LEVEL_CUTOFF 512
+
+////////////////////////////////////////////////////////////////////////
+// SimContext class
+//	Contexts are cheap relative to the netlist (a few words per gate), so
+//	each thread that simulates or learns should create its own.
+////////////////////////////////////////////////////////////////////////
+class SimContext
+{
+public:
+	SimContext(const Netlist *netlist);	// constructor with shared netlist
+	~SimContext();
+
+	void applyVector(char *);	// apply input vector
+	//apply an input vector, scheduling only the inputs whose value changed.
+	//In a circuit without FFs an input which stays X keeps its X id, so it
+	//is not an event either. Returns the number of inputs that changed
+	int applyVectorDelta(const char *vec);
+	void setupWheel(int, int);
+	void insertEvent(int, int);
+	int retrieveEvent();
+	void goodsim(bool verbose);		// logic sim (no faults inserted)
+	void setTieEvents();	// inject events from tied node
+	void observeOutputs();	// print the fault-free outputs
+	std::string outputValues() const;	// PO values as a string of 0/1/X
+	void restoreValues(const unsigned int *values, int xNumber);	// rewind gate values
+	//simulate wide levels on the workers of pool (NULL for serial simulation)
+	void setThreadPool(ThreadPool *pool);
+	//ns per gate to evaluate every gate rounds times on the current values,
+	//with the fixed width evaluators or with the generic ones only
+	double evaluationTime(bool specialized, int rounds);
+
+	int x_number; //starts at 4 to avoid conflicts with 0/1
+	char *sched;		// scheduled on the wheel yet?
+	unsigned int * GateValues;	//gate values (0, 1 or X number)
+	char *goodState;		// good state (without scan)
+
+	//gates which changed to a 0 or 1 during the last simulation
+	std::vector<uint32_t> changes;
+	//gates evaluated by goodsim over the life of the context
+	long numEvents;
+
+private:
+	//per worker state for a level simulated in parallel
+	struct LevelWorker
+	{
+		std::vector<int> scheduled;		// fanouts this worker put on the wheel
+		std::vector<uint32_t> changes;
+		std::vector<uint32_t> evalValues;
+	};
+
+	unsigned int evaluate(int gateN, std::vector<uint32_t> &values);	// new value of one gate
+	unsigned int evaluateGeneric(int gateN, std::vector<uint32_t> &values);	// by gate type, any fanin
+	template <int Type, int N> unsigned int evalFixed(int gateN);	// one type with N fanins
+	void simulateLevel();		// evaluates the current level on the pool
+	unsigned int newX(int gateN);	// X id for a new unknown on the output of gateN
+
+	//Gate evaluation functions, values is scratch space for the fanin values
+	unsigned int evalAND(int gateN, std::vector<uint32_t> &values);
+	unsigned int evalNAND(int gateN, std::vector<uint32_t> &values);
+	unsigned int evalOR(int gateN, std::vector<uint32_t> &values);
+	unsigned int evalNOR(int gateN, std::vector<uint32_t> &values);
+	unsigned int evalXOR(int gateN);
+	unsigned int evalXNOR(int gateN);
+
+	const Netlist *ckt;	// shared topology (not owned)
+
+	int **levelEvents;	// event list for each level in the circuit
+	int *levelLen;	// evenlist length
+	int numlevels;	// total number of levels in wheel
+	int currLevel;	// current level
+	int *activation;	// activation list for the current level in circuit
+	int actLen;		// length of the activation list
+	int *actFFList;	// activation list for the FF's
+	int actFFLen;	// length of the actFFList
+
+	std::vector<uint32_t> evalValues;
+	std::vector<unsigned int> inputX;	// last X id given to each input
+	std::vector<unsigned int> ownX;		// last X id given to each gate by newX
+	size_t stateBytes, wheelBytes;	// reported to the memory counters
+
+	ThreadPool *pool;		// not owned
+	std::vector<LevelWorker> levelWorkers;
+	bool parallel;			// X ids come from sharedX while a level is simulated in parallel
+	bool keepX;				// gates keep their own X ids, set by applyVectorDelta without FFs
+	std::atomic<unsigned int> sharedX;
+};
+
+////////////////////////////////////////////////////////////////////////
+inline void SimContext::insertEvent(int levelN, int gateN)
+{
+    levelEvents[levelN][levelLen[levelN]] = gateN;
+    levelLen[levelN]++;
+}
+
+//After applyVectorDelta on a circuit without FFs a gate which still holds
+//the X it was given last time keeps it. That X is only found in the gate's fanout cone, whose
+//values were computed from it, so nothing downstream is simulated again.
+//Other simulations (learning) always get a new X
+inline unsigned int SimContext::newX(int gateN)
+{
+	unsigned int val = ownX[gateN];
+	if (keepX && val != 0 && (GateValues[gateN] & ~1u) == val)
+	{
+		return val;
+	}
+	if (parallel)
+	{
+		val = sharedX.fetch_add(2, std::memory_order_relaxed);
+	}
+	else
+	{
+		val = x_number;
+		x_number = x_number + 2;
+	}
+	ownX[gateN] = val;
+	return val;
+}
+
+#endif
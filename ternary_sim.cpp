@@ -0,0 +1,221 @@
+// Filename:	ternary_sim.cpp
+// Description:	Three valued event driven simulation over two bit packed
+//				gate values
+
+#include "ternary_sim.h"
+
+//STL includes
+#include <iostream>
+
+using namespace std;
+
+//how a gate is evaluated
+#define OP_AND 0
+#define OP_NAND 1
+#define OP_OR 2
+#define OP_NOR 3
+#define OP_XOR 4
+#define OP_XNOR 5
+#define OP_HOLD 6		// inputs and ties keep their value
+#define OP_ILLEGAL 7
+
+//output of the AND/OR type operations indexed by which values the fanins
+//hold: bit 0 set if any fanin is 0, bit 1 if any is 1, bit 2 if any is X.
+//BUF, DFF and OUTPUT are one input ANDs, NOT a one input NAND.
+static const unsigned char ternaryTable[4][8] =
+{
+	{ TERNARY_1, TERNARY_0, TERNARY_1, TERNARY_0, TERNARY_X, TERNARY_0, TERNARY_X, TERNARY_0 },	// AND
+	{ TERNARY_0, TERNARY_1, TERNARY_0, TERNARY_1, TERNARY_X, TERNARY_1, TERNARY_X, TERNARY_1 },	// NAND
+	{ TERNARY_0, TERNARY_0, TERNARY_1, TERNARY_1, TERNARY_X, TERNARY_X, TERNARY_1, TERNARY_1 },	// OR
+	{ TERNARY_1, TERNARY_1, TERNARY_0, TERNARY_0, TERNARY_X, TERNARY_X, TERNARY_0, TERNARY_0 }	// NOR
+};
+
+////////////////////////////////////////////////////////////////////////
+// TernarySim class
+////////////////////////////////////////////////////////////////////////
+
+TernarySim::TernarySim(const Netlist *netlist)
+{
+	int gateN;
+
+	ckt = netlist;
+	numEvents = 0;
+	operation.assign(ckt->numgates, OP_HOLD);
+	for (gateN = 1; gateN < ckt->numgates; gateN++)
+	{
+		switch (ckt->gtype[gateN])
+		{
+		case T_and:
+		case T_buf:
+		case T_dff:
+		case T_output:
+			operation[gateN] = OP_AND;
+			break;
+		case T_nand:
+		case T_not:
+			operation[gateN] = OP_NAND;
+			break;
+		case T_or:
+			operation[gateN] = OP_OR;
+			break;
+		case T_nor:
+			operation[gateN] = OP_NOR;
+			break;
+		case T_xor:
+			operation[gateN] = OP_XOR;
+			break;
+		case T_xnor:
+			operation[gateN] = OP_XNOR;
+			break;
+		case JUNK:
+		case T_input:
+		case T_tie0:
+		case T_tie1:
+		case T_tieX:
+		case T_tieZ:
+			break;
+		default:
+			operation[gateN] = OP_ILLEGAL;
+			break;
+		}
+	}
+	//every gate starts out X
+	values.assign(((size_t) ckt->numgates + 31) / 32, 0xAAAAAAAAAAAAAAAAULL);
+	initial = values;
+	isTouched.assign(ckt->numgates, 0);
+	sched.assign(ckt->numgates, 0);
+	wheel.resize(ckt->maxlevels);
+	stateBytes = 2 * values.size() * sizeof(uint64_t) + operation.size() + isTouched.size() + sched.size();
+	memoryAllocated(MemSimState, stateBytes);
+}
+
+TernarySim::~TernarySim()
+{
+	memoryReleased(MemSimState, stateBytes);
+}
+
+void TernarySim::setResetValues(const unsigned int *resetValues)
+{
+	int gateN;
+
+	for (gateN = 0; gateN < ckt->numgates; gateN++)
+	{
+		unsigned int value = resetValues[gateN] <= 1 ? resetValues[gateN] : TERNARY_X;
+		uint64_t shift = (gateN & 31) * 2;
+		initial[gateN >> 5] = (initial[gateN >> 5] & ~((uint64_t) 3 << shift)) | ((uint64_t) value << shift);
+	}
+	values = initial;
+	for (size_t i = 0; i < touched.size(); i++)
+	{
+		isTouched[touched[i]] = 0;
+	}
+	touched.clear();
+}
+
+void TernarySim::reset()
+{
+	for (size_t i = 0; i < touched.size(); i++)
+	{
+		int gateN = touched[i];
+		values[gateN >> 5] = (values[gateN >> 5] & ~((uint64_t) 3 << ((gateN & 31) * 2))) |
+			(initial[gateN >> 5] & ((uint64_t) 3 << ((gateN & 31) * 2)));
+		isTouched[gateN] = 0;
+	}
+	touched.clear();
+}
+
+void TernarySim::setValue(int gateN, unsigned int value)
+{
+	uint64_t shift = (gateN & 31) * 2;
+	values[gateN >> 5] = (values[gateN >> 5] & ~((uint64_t) 3 << shift)) | ((uint64_t) value << shift);
+	if (!isTouched[gateN])
+	{
+		isTouched[gateN] = 1;
+		touched.push_back(gateN);
+	}
+}
+
+//level 0 successors are FFs, which take their D input's value when it is
+//assigned, but are not clocked again by the gates a simulation changes
+void TernarySim::schedule(int gateN, bool clockFFs)
+{
+	for (int i = 0; i < ckt->fanout[gateN]; i++)
+	{
+		int successor = ckt->fnlist[gateN][i];
+		int level = ckt->levelNum[successor];
+		if (sched[successor] == 0 && (level != 0 || clockFFs))
+		{
+			sched[successor] = 1;
+			wheel[level].push_back(successor);
+		}
+	}
+}
+
+void TernarySim::assign(int gateN, unsigned int value)
+{
+	setValue(gateN, value);
+	schedule(gateN, true);
+}
+
+unsigned int TernarySim::evaluate(int gateN) const
+{
+	unsigned int op = operation[gateN];
+	unsigned int seen = 0;
+	int i;
+
+	if (op <= OP_NOR)
+	{
+		for (i = 0; i < ckt->fanin[gateN]; i++)
+		{
+			seen |= 1 << value(ckt->inlist[gateN][i]);
+		}
+		return ternaryTable[op][seen];
+	}
+	if (op <= OP_XNOR)
+	{
+		unsigned int parity = op == OP_XNOR;
+		for (i = 0; i < ckt->fanin[gateN]; i++)
+		{
+			unsigned int input = value(ckt->inlist[gateN][i]);
+			if (input == TERNARY_X)
+			{
+				return TERNARY_X;
+			}
+			parity ^= input;
+		}
+		return parity;
+	}
+	if (op == OP_ILLEGAL)
+	{
+		cerr << "illegal gate type for ternary simulation " << gateN << " " << ckt->gtype[gateN] << "\n";
+		exit(-1);
+	}
+	return value(gateN);
+}
+
+//fanouts are always on a higher level, so each level is done once its turn comes
+void TernarySim::simulate()
+{
+	changes.clear();
+	for (int level = 0; level < ckt->maxlevels; level++)
+	{
+		vector<int> &events = wheel[level];
+		for (size_t k = 0; k < events.size(); k++)
+		{
+			int gateN = events[k];
+			sched[gateN] = 0;
+			numEvents++;
+			unsigned int newVal = evaluate(gateN);
+			if (newVal != value(gateN))
+			{
+				if (newVal != TERNARY_X)
+				{
+					changes.push_back(newVal == TERNARY_1 ? gateN | VALUE : gateN);
+				}
+				setValue(gateN, newVal);
+				schedule(gateN, false);
+			}
+		}
+		events.clear();
+	}
+}
@@ -0,0 +1,73 @@
+// Filename:	ternary_sim.h
+// Description:	Header file for plain three valued simulation with gate
+//				values packed two bits per gate, a faster and weaker
+//				alternative to SimContext for implication learning.
+
+#ifndef TERNARY_SIM
+#define TERNARY_SIM
+
+//STL includes
+#include <cstdint>
+#include <vector>
+
+//user defined includes
+#include "memory_accounting.h"
+#include "netlist.h"
+
+//two bit gate values
+#define TERNARY_0 0
+#define TERNARY_1 1
+#define TERNARY_X 2
+
+////////////////////////////////////////////////////////////////////////
+// TernarySim class
+//	Every unknown is the same X, so an X and its complement never cancel
+//	and XORs of reconverging unknowns stay X, which loses implications
+//	SimContext finds. In return no X ids are allocated and no fanins are
+//	searched for complements, and an unknown which is evaluated again
+//	stays the same X instead of taking a new id, so it does not ripple
+//	through the circuit and overwrite closure values. AND/OR type gates
+//	are evaluated by a table lookup on which of 0, 1 and X their fanins
+//	hold. Gates changed by a simulation are remembered, so a reset only
+//	touches those. As in learning with SimContext, an FF only follows a
+//	D input that was assigned, not one the simulation changed.
+////////////////////////////////////////////////////////////////////////
+class TernarySim
+{
+public:
+	TernarySim(const Netlist *netlist);	// constructor with shared netlist
+	~TernarySim();
+
+	//takes the values every simulation starts from, SimContext values
+	//where any X id becomes X
+	void setResetValues(const unsigned int *values);
+	//puts back the reset values of the gates changed since the last reset
+	void reset();
+	//sets gate to TERNARY_0 or TERNARY_1 and schedules its fanouts
+	void assign(int gateN, unsigned int value);
+	//simulates the scheduled gates in level order
+	void simulate();
+	unsigned int value(int gateN) const { return (values[gateN >> 5] >> ((gateN & 31) * 2)) & 3; }
+
+	//gates which changed to a 0 or 1 during the last simulation
+	std::vector<uint32_t> changes;
+	//gates evaluated over the life of the simulator
+	long numEvents;
+
+private:
+	unsigned int evaluate(int gateN) const;
+	void setValue(int gateN, unsigned int value);	// remembers the gate for reset
+	void schedule(int gateN, bool clockFFs);	// puts the fanouts of gateN on the wheel
+
+	const Netlist *ckt;	// shared topology (not owned)
+	std::vector<unsigned char> operation;	// per gate, how it is evaluated
+	std::vector<uint64_t> values;		// 32 gates per word
+	std::vector<uint64_t> initial;		// values after a reset
+	std::vector<int> touched;			// gates changed since the last reset
+	std::vector<char> isTouched;
+	std::vector<std::vector<int>> wheel;	// gates scheduled at each level
+	std::vector<char> sched;
+	size_t stateBytes;
+};
+
+#endif
@@ -0,0 +1,91 @@
+// Filename:	checkpoint_round_trip_test.cpp
+// Description:	Round trip test for learning checkpoints. A run resumed
+//				from the checkpoint of a finished run, and one resumed
+//				from the checkpoint of a run stopped by its memory budget
+//				before the first literal, must end with the lists and
+//				counters of an uninterrupted run.
+
+#include "logic_sim.h"
+
+//STL includes
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+//learns a fresh copy of the circuit, saving its checkpoints to path
+static LogicSim * learn(const char *circuit, const string &path, bool resume, size_t budget)
+{
+	LogicSim *sim = new LogicSim(circuit, false, false);
+	LearningOptions options;
+	options.checkpointPath = path;
+	options.resume = resume;
+	options.memoryBudgetBytes = budget;
+	sim->setLearningOptions(options);
+	sim->generateImplicationLists();
+	return sim;
+}
+
+//the differences between the lists and counters of two runs
+static int compareRuns(const LogicSim &expected, const LogicSim &resumed, const string &name)
+{
+	int mismatches = 0;
+	if (resumed.numIndirectImplications != expected.numIndirectImplications || resumed.numSimulations != expected.numSimulations
+		|| resumed.fixedNodeCounter != expected.fixedNodeCounter || resumed.coverage.covered != expected.coverage.covered)
+	{
+		cerr << name << ": " << resumed.numIndirectImplications << " implications, " << resumed.numSimulations << " simulations, "
+			<< resumed.fixedNodeCounter << " fixed gates, expected " << expected.numIndirectImplications << ", "
+			<< expected.numSimulations << " and " << expected.fixedNodeCounter << endl;
+		mismatches++;
+	}
+	for (uint32_t literal = 2; literal < 2 * (uint32_t) expected.numgates; literal++)
+	{
+		uint32_t imp = literalFromIndex(literal);
+		if (resumed.getDirectList(imp) != expected.getDirectList(imp))
+		{
+			cerr << name << ": gate " << (imp & GATE) << " at " << (imp >> 31) << " has " << resumed.getDirectList(imp).size()
+				<< " implications, expected " << expected.getDirectList(imp).size() << endl;
+			mismatches++;
+		}
+	}
+	return mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 3)
+	{
+		cerr << "Usage: checkpoint_round_trip_test <circuit path> <checkpoint path>" << endl;
+		return 2;
+	}
+	string path = argv[2];
+	int mismatches = 0;
+
+	remove(path.c_str());
+	LogicSim *uninterrupted = learn(argv[1], path, false, 0);
+	LogicSim *resumed = learn(argv[1], path, true, 0);
+	mismatches += compareRuns(*uninterrupted, *resumed, "resumed after finishing");
+	delete resumed;
+
+	remove(path.c_str());
+	LogicSim *stopped = learn(argv[1], path, false, 1);
+	if (string(stopped->coverage.stopReason) != "memory budget" || stopped->coverage.covered != 0)
+	{
+		cerr << "budgeted run: " << stopped->coverage.stopReason << " after " << stopped->coverage.covered << " literals" << endl;
+		mismatches++;
+	}
+	delete stopped;
+	resumed = learn(argv[1], path, true, 0);
+	mismatches += compareRuns(*uninterrupted, *resumed, "resumed after stopping");
+	delete resumed;
+	delete uninterrupted;
+	remove(path.c_str());
+
+	if (mismatches > 0)
+	{
+		return 1;
+	}
+	cout << "checkpoints of " << argv[1] << " resume to the uninterrupted lists" << endl;
+	return 0;
+}
@@ -0,0 +1,96 @@
+// Filename:	export_round_trip_test.cpp
+// Description:	Round trip test for the binary export. Every list read back
+//				with ImplicationReader, and every list of a circuit loaded
+//				from the export, must match the learned direct list.
+
+#include "logic_sim.h"
+#include "implication_export.h"
+
+//STL includes
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//the direct list of imp in the export's numbering, sorted
+static vector<uint32_t> directLiterals(const LogicSim &sim, uint32_t imp)
+{
+	const StoredImplicationList &list = sim.getDirectList(imp);
+	vector<uint32_t> literals;
+	for (auto it = list.begin(); it != list.end(); ++it)
+	{
+		literals.push_back(literalIndex(*it));
+	}
+	sort(literals.begin(), literals.end());
+	return literals;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 3)
+	{
+		cerr << "Usage: export_round_trip_test <circuit path> <export path>" << endl;
+		return 2;
+	}
+	string exportPath = argv[2];
+	int mismatches = 0;
+
+	LogicSim learned(argv[1], false);
+	ImplicationExporter exporter(&learned, 2);
+	if (!exporter.exportLists(exportPath, ExportBinary, false))
+	{
+		cerr << "could not write " << exportPath << endl;
+		return 2;
+	}
+	ImplicationReader reader;
+	if (!reader.open(exportPath))
+	{
+		cerr << "could not read " << exportPath << endl;
+		return 1;
+	}
+	if (reader.numgates != (uint32_t) learned.numgates || reader.flags != 0)
+	{
+		cerr << "header: " << reader.numgates << " gates, flags " << reader.flags << endl;
+		mismatches++;
+	}
+
+	LogicSim loaded(argv[1], false, false);
+	if (!loaded.loadImplicationLists(reader))
+	{
+		return 1;
+	}
+	vector<uint32_t> literals;
+	for (uint32_t literal = 2; literal < 2 * (uint32_t) learned.numgates; literal++)
+	{
+		uint32_t imp = literalFromIndex(literal);
+		vector<uint32_t> expected = directLiterals(learned, imp);
+		if (!reader.readList(literal, literals))
+		{
+			cerr << "could not read the list of literal " << literal << endl;
+			return 1;
+		}
+		if (literals != expected)
+		{
+			cerr << "gate " << (imp & GATE) << " at " << (imp >> 31) << ": " << literals.size() << " literals read, "
+				<< expected.size() << " learned" << endl;
+			mismatches++;
+		}
+		if (directLiterals(loaded, imp) != expected)
+		{
+			cerr << "gate " << (imp & GATE) << " at " << (imp >> 31) << ": loaded list differs from the learned one" << endl;
+			mismatches++;
+		}
+	}
+	reader.close();
+	remove(exportPath.c_str());
+
+	if (mismatches > 0)
+	{
+		return 1;
+	}
+	cout << "binary export of " << learned.numgates << " gates read back unchanged" << endl;
+	return 0;
+}
@@ -0,0 +1,71 @@
+// Filename:	memory_budget_test.cpp
+// Description:	Regression test for the learning memory budget. The budget
+//				is checked against the memory of the circuit being learned,
+//				so other circuits resident in the same process must not use
+//				it up, while a budget below the circuit's own needs must
+//				still stop learning.
+
+#include "logic_sim.h"
+
+//STL includes
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//learns a fresh copy of the circuit with the given memory budget, and
+//returns why learning ended
+static string learnWithBudget(const char *path, size_t budget)
+{
+	LogicSim sim(path, false, false);
+	LearningOptions options;
+	options.memoryBudgetBytes = budget;
+	sim.setLearningOptions(options);
+	sim.generateImplicationLists();
+	return sim.coverage.stopReason;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 2)
+	{
+		cerr << "Usage: memory_budget_test <circuit path>" << endl;
+		return 2;
+	}
+	int failures = 0;
+
+	LogicSim alone(argv[1], false);
+	size_t needed = alone.trackedMemory();
+
+	//resident circuits together hold several times what one needs
+	vector<LogicSim *> resident;
+	for (int i = 0; i < 4; i++)
+	{
+		resident.push_back(new LogicSim(argv[1], false));
+	}
+	string reason = learnWithBudget(argv[1], 2 * needed);
+	if (reason != "complete")
+	{
+		cerr << "budget of " << 2 * needed << " bytes with other circuits resident: " << reason << endl;
+		failures++;
+	}
+	for (size_t i = 0; i < resident.size(); i++)
+	{
+		delete resident[i];
+	}
+
+	reason = learnWithBudget(argv[1], needed / 2);
+	if (reason != "memory budget")
+	{
+		cerr << "budget of " << needed / 2 << " bytes: " << reason << endl;
+		failures++;
+	}
+
+	if (failures > 0)
+	{
+		return 1;
+	}
+	cout << "memory budget is counted per circuit (" << needed << " bytes learned)" << endl;
+	return 0;
+}
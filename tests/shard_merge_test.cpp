@@ -0,0 +1,109 @@
+// Filename:	shard_merge_test.cpp
+// Description:	Round trip test for sharded learning. Both shards of a
+//				two shard run are exported and merged with
+//				ImplicationShardMerge. The merged database must hold every
+//				edge either shard learned, unless the literal was found
+//				unreachable, and every literal a shard found unreachable.
+
+#include "logic_sim.h"
+#include "implication_export.h"
+
+//STL includes
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+	if (argc != 4)
+	{
+		cerr << "Usage: shard_merge_test <merge tool> <circuit path> <output directory>" << endl;
+		return 2;
+	}
+	string circuit = argv[2];
+	string directory = argv[3];
+	vector<string> shardPaths;
+	int mismatches = 0;
+
+	for (int index = 0; index < 2; index++)
+	{
+		LogicSim sim(circuit, false, false);
+		LearningOptions options;
+		options.shardIndex = index;
+		options.numShards = 2;
+		sim.setLearningOptions(options);
+		sim.generateImplicationLists();
+		shardPaths.push_back(directory + "/shard" + to_string(index) + ".gis");
+		ImplicationExporter exporter(&sim, 1);
+		exporter.setShard(index, 2);
+		if (!exporter.exportLists(shardPaths.back(), ExportBinary, false))
+		{
+			cerr << "could not write " << shardPaths.back() << endl;
+			return 2;
+		}
+	}
+	string mergedPath = directory + "/merged.gis";
+	string command = string(argv[1]) + " --threads 2 " + circuit + " " + mergedPath + " " + shardPaths[1] + " " + shardPaths[0];
+	if (system(command.c_str()) != 0)
+	{
+		cerr << "merge failed: " << command << endl;
+		return 1;
+	}
+
+	ImplicationReader merged;
+	ImplicationReader shards[2];
+	if (!merged.open(mergedPath) || !shards[0].open(shardPaths[0]) || !shards[1].open(shardPaths[1]))
+	{
+		cerr << "could not read the shard or merged lists" << endl;
+		return 1;
+	}
+	if (merged.flags != 0 || merged.numgates != shards[0].numgates)
+	{
+		cerr << "merged header: " << merged.numgates << " gates, flags " << merged.flags << endl;
+		mismatches++;
+	}
+	vector<uint32_t> mergedList, shardList;
+	for (uint32_t literal = 2; literal < 2 * merged.numgates; literal++)
+	{
+		if (!merged.readList(literal, mergedList))
+		{
+			cerr << "could not read the merged list of literal " << literal << endl;
+			return 1;
+		}
+		for (int s = 0; s < 2; s++)
+		{
+			if (!shards[s].readList(literal, shardList))
+			{
+				cerr << "could not read literal " << literal << " of shard " << s << endl;
+				return 1;
+			}
+			bool lost = shardList.empty() ? !mergedList.empty()
+				: !mergedList.empty() && !includes(mergedList.begin(), mergedList.end(), shardList.begin(), shardList.end());
+			if (lost)
+			{
+				cerr << "literal " << literal << ": " << mergedList.size() << " merged literals, shard " << s << " has "
+					<< shardList.size() << " not all among them" << endl;
+				mismatches++;
+			}
+		}
+	}
+	merged.close();
+	for (int s = 0; s < 2; s++)
+	{
+		shards[s].close();
+		remove(shardPaths[s].c_str());
+	}
+	remove(mergedPath.c_str());
+
+	if (mismatches > 0)
+	{
+		return 1;
+	}
+	cout << "merged shards keep every learned edge" << endl;
+	return 0;
+}
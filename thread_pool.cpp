@@ -0,0 +1,95 @@
+// Filename:	thread_pool.cpp
+// Description:	A fixed size pool of worker threads fed from a single queue
+
+#include "thread_pool.h"
+
+//constructor, starts the worker threads
+ThreadPool::ThreadPool(int numThreads)
+{
+	stopping = false;
+	if (numThreads < 1)
+	{
+		numThreads = 1;
+	}
+	for (int i = 0; i < numThreads; i++)
+	{
+		workers.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+//destructor, lets the workers drain the queue and then joins them
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(queueLock);
+		stopping = true;
+	}
+	queueReady.notify_all();
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+void ThreadPool::submit(std::function<void(int)> task)
+{
+	{
+		std::lock_guard<std::mutex> guard(queueLock);
+		tasks.push_back(std::move(task));
+	}
+	queueReady.notify_one();
+}
+
+void ThreadPool::parallelFor(int count, int grain, const std::function<void(int, int, int)> &body)
+{
+	int chunks = grain > 0 ? count / grain : count;
+	if (chunks > size())
+	{
+		chunks = size();
+	}
+	if (chunks <= 1)
+	{
+		body(0, count, 0);
+		return;
+	}
+
+	std::mutex doneLock;
+	std::condition_variable allDone;
+	int remaining = chunks;
+	for (int i = 0; i < chunks; i++)
+	{
+		int begin = (int) ((long) count * i / chunks);
+		int end = (int) ((long) count * (i + 1) / chunks);
+		submit([&, begin, end](int worker)
+		{
+			body(begin, end, worker);
+			std::lock_guard<std::mutex> guard(doneLock);
+			if (--remaining == 0)
+			{
+				allDone.notify_one();
+			}
+		});
+	}
+	std::unique_lock<std::mutex> guard(doneLock);
+	allDone.wait(guard, [&remaining] { return remaining == 0; });
+}
+
+void ThreadPool::workerLoop(int worker)
+{
+	std::function<void(int)> task;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> guard(queueLock);
+			queueReady.wait(guard, [this] { return stopping || !tasks.empty(); });
+			if (tasks.empty())
+			{
+				//only reached when stopping
+				return;
+			}
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task(worker);
+	}
+}
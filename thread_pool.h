@@ -0,0 +1,43 @@
+// Filename:	thread_pool.h
+// Description:	Header file for a fixed size pool of worker threads. Each task
+//				is passed the index of the worker running it, so callers can
+//				keep per-worker state such as a SimContext.
+
+#ifndef THREAD_POOL
+#define THREAD_POOL
+
+//STL includes
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+	ThreadPool(int numThreads);	// starts numThreads workers
+	~ThreadPool();				// finishes queued tasks and joins the workers
+
+	//queue a task, it is called with the index of the worker that runs it
+	void submit(std::function<void(int)> task);
+	//splits [0, count) into at most size() ranges of at least grain items and
+	//runs body(begin, end, worker) on them, returning once all are done. Must
+	//not be called from a task of this pool
+	void parallelFor(int count, int grain, const std::function<void(int, int, int)> &body);
+	//number of worker threads
+	int size() const { return (int) workers.size(); }
+
+private:
+	//main loop for each worker thread
+	void workerLoop(int worker);
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void(int)>> tasks;
+	std::mutex queueLock;
+	std::condition_variable queueReady;
+	bool stopping;
+};
+
+#endif